@@ -87,167 +87,107 @@ local function getfenv(f)
   return val
 end
 
--- Sprite metatable: Handles sprite property assignment/reading
-sprite_metatable =
-{
-  __newindex = function(sprite, key, value)
-
-    -- Properties specific to Dink
-    if sprite.sprite_number == 1 then
-      if key == "can_walk_off_screen" then
-        object.dink_object_can_walk_off_screen(value)
-        return
-      elseif key == "base_push" then
-        object.set_dink_base_push(value)
-        return
-      end
-    end
+-- Sprite objects: "sprite_metatable" is set up in the file
+-- "dinklua_bindings.c", which reads and writes the sprite properties
+-- itself. Methods are looked up first, then properties, then the
+-- special properties in "sprite_metatable.getters". Dink's own
+-- properties (set_speed, can_walk_off_screen...) are handled there too.
+local sprite_methods = sprite_metatable.methods
+
+function sprite_methods.kill_wait(self)
+  local ok, err = pcall(object.sprite_object_kill_wait, self.sprite_number)
+  if not ok then error(err, 2) end
+end
 
-    -- Properties that take sprite objects as a value
-    if key == "target" or key == "follow" then
-      value = decode_sprite(value, "target value must be a sprite number or a sprite object")
-    end
+function sprite_methods.freeze(self)
+  local ok, err = pcall(object.sprite_object_freeze, self.sprite_number)
+  if not ok then error(err, 2) end
+end
 
-    local ok, err = pcall(object.set_sprite_value, sprite.sprite_number, key, value)
-    if not ok then error(err, 2) end
-  end,
-  __index = function(sprite, key)
+function sprite_methods.unfreeze(self)
+  local ok, err = pcall(object.sprite_object_unfreeze, self.sprite_number)
+  if not ok then error(err, 2) end
+end
 
-    -- Return methods and properties specific to Dink
-    if sprite.sprite_number == 1 then
-      if key == "set_speed" then
-        return function(self, speed)
-          object.dink_object_set_speed(speed)
-        end
-      elseif key == "get_speed" then
-        local ok, value = pcall(object.dink_object_get_speed)
-        return value
-      end
-    end
+function sprite_methods.say(self, text)
+  local ok, err = pcall(object.sprite_object_say, text, self.sprite_number)
+  if not ok then error(err, 2) end
+end
 
-    -- Return methods specific to sprites
-    if key == "kill_wait" then
-      return function(self)
-        local ok, err = pcall(object.sprite_object_kill_wait, self.sprite_number)
-        if not ok then error(err, 2) end
-      end
-    elseif key == "freeze" then
-      return function(self)
-        local ok, err = pcall(object.sprite_object_freeze, self.sprite_number)
-        if not ok then error(err, 2) end
-      end
-    elseif key == "unfreeze" then
-      return function(self)
-        local ok, err = pcall(object.sprite_object_unfreeze, self.sprite_number)
-        if not ok then error(err, 2) end
-      end
-    elseif key == "say" then
-      return function(self, text)
-        local ok, err = pcall(object.sprite_object_say, text, self.sprite_number)
-        if not ok then error(err, 2) end
-      end
-    elseif key == "say_stop" then
-      return function(self, text)
-        local ok, err = pcall(object.yield_sprite_object_say_stop, text, self.sprite_number)
-        if not ok then error(err, 2) end
-        coroutine.yield()
-      end
-    elseif key == "say_stop_npc" then
-      return function(self, text)
-        local ok, err = pcall(object.yield_sprite_object_say_stop_npc, text, self.sprite_number)
-        if not ok then error(err, 2) end
-        coroutine.yield()
-      end
-    elseif key == "move" then
-      return function(self, direction, destination, ignore_hardness)
-        local ok, err = pcall(object.sprite_object_move, self.sprite_number, direction, destination, ignore_hardness)
-        if not ok then error(err, 2) end
-      end
-    elseif key == "move_stop" then
-      return function(self, direction, destination, ignore_hardness)
-        local ok, err = pcall(object.yield_sprite_object_move_stop, self.sprite_number, direction, destination, ignore_hardness)
-        if not ok then error(err, 2) end
-        coroutine.yield()
-      end
-    elseif key == "draw_hard" then
-      return function(self)
-        local ok, err = pcall(object.sprite_object_draw_hard_sprite, self.sprite_number)
-        if not ok then error(err, 2) end
-      end
-    elseif key == "kill_shadow" then
-      return function(self)
-        local ok, err = pcall(object.sprite_object_kill_shadow, self.sprite_number)
-        if not ok then error(err, 2) end
-      end
-    elseif key == "hurt" then
-      return function(self, damage)
-        local ok, err = pcall(object.sprite_object_hurt, self.sprite_number, damage)
-        if not ok then error(err, 2) end
-      end
-    elseif key == "compare_script" then
-      return function(self, script)
-        local ok, err = pcall(object.compare_sprite_script, self.sprite_number, script)
-        if not ok then error(err, 2) end
-      end
-    end
+function sprite_methods.say_stop(self, text)
+  local ok, err = pcall(object.yield_sprite_object_say_stop, text, self.sprite_number)
+  if not ok then error(err, 2) end
+  coroutine.yield()
+end
 
-    -- Special properties
-    if key == "editor_sprite" then
-      local editor_num = object.get_sprite_value(sprite.sprite_number, "editor_num")
-      if editor_num == 0 then
-        return nil
-      else
-        return dink.get_editor_sprite(editor_num)
-      end
-    elseif key == "busy" then
-      local text_sprite_num = object.sprite_object_busy(sprite.sprite_number)
-      if text_sprite_num == 0 then
-        return nil
-      else
-        return dink.get_sprite(text_sprite_num)
-      end
-    elseif key == "script_attached" then
-      return dink.is_script_attached(sprite.sprite_number)
-    end
+function sprite_methods.say_stop_npc(self, text)
+  local ok, err = pcall(object.yield_sprite_object_say_stop_npc, text, self.sprite_number)
+  if not ok then error(err, 2) end
+  coroutine.yield()
+end
 
-    local ok, value = pcall(object.get_sprite_value, sprite.sprite_number, key)
-    if not ok then error(value, 2) end
+function sprite_methods.move(self, direction, destination, ignore_hardness)
+  local ok, err = pcall(object.sprite_object_move, self.sprite_number, direction, destination, ignore_hardness)
+  if not ok then error(err, 2) end
+end
 
-    -- Properties that return sprite objects
-    if key == "target" then
-      if value > 0 then
-        value = dink.get_sprite(value)
-      else
-        value = nil
-      end
-    end
+function sprite_methods.move_stop(self, direction, destination, ignore_hardness)
+  local ok, err = pcall(object.yield_sprite_object_move_stop, self.sprite_number, direction, destination, ignore_hardness)
+  if not ok then error(err, 2) end
+  coroutine.yield()
+end
 
-    return value
-  end,
-  __metatable = false
-}
+function sprite_methods.draw_hard(self)
+  local ok, err = pcall(object.sprite_object_draw_hard_sprite, self.sprite_number)
+  if not ok then error(err, 2) end
+end
 
--- Sprite Custom Metatable: Makes it so you can use the sp_custom feature in a
--- more natural way in Lua: sprite.custom["whatnot"] = 5, or alternatively,
--- sprite.custom.whatnot = 5
-sprite_custom_metatable =
-{
-  -- Warning: Only "sprite_number" property available on this sprite object
-  __newindex = function(sprite, key, value)
-    object.sp_custom(sprite.sprite_number, key, value)
-  end,
-  -- Warning: Only "sprite_number" property available on this sprite object
-  __index = function(sprite, key)
-    return object.sp_custom(sprite.sprite_number, key, -1)
-  end,
-  __metatable = false
-}
+function sprite_methods.kill_shadow(self)
+  local ok, err = pcall(object.sprite_object_kill_shadow, self.sprite_number)
+  if not ok then error(err, 2) end
+end
+
+function sprite_methods.hurt(self, damage)
+  local ok, err = pcall(object.sprite_object_hurt, self.sprite_number, damage)
+  if not ok then error(err, 2) end
+end
+
+function sprite_methods.compare_script(self, script)
+  local ok, result = pcall(object.compare_sprite_object_script, self.sprite_number, script)
+  if not ok then error(result, 2) end
+  return result
+end
+
+-- Special properties
+local sprite_getters = sprite_metatable.getters
+
+function sprite_getters.editor_sprite(sprite)
+  local editor_num = sprite.editor_num
+  if editor_num == 0 then
+    return nil
+  else
+    return dink.get_editor_sprite(editor_num)
+  end
+end
+
+function sprite_getters.busy(sprite)
+  local text_sprite_num = object.sprite_object_busy(sprite.sprite_number)
+  if text_sprite_num == 0 then
+    return nil
+  else
+    return dink.get_sprite(text_sprite_num)
+  end
+end
+
+function sprite_getters.script_attached(sprite)
+  return dink.is_script_attached(sprite.sprite_number)
+end
 
 --[[
 
 Called with the desired sprite number, this function returns a
-lua table with special metatable values that effectively creates
-"properties" on the sprite objects, in such a way that you can do
+sprite object with special metatable values that effectively creates
+"properties" on it, in such a way that you can do
 things like:
 
 some_sprite = dink.get_sprite(15)
@@ -259,12 +199,7 @@ as is "player" (sprite #1), so any other need will probably want to
 use another mechanism than a hardcoded number to share sprites.
 
 ]]--
-function dink.get_sprite(sprite_number)
-  return setmetatable({
-    sprite_number = sprite_number,
-    custom = setmetatable({sprite_number = sprite_number}, sprite_custom_metatable)
-  }, sprite_metatable)
-end
+dink.get_sprite = object.get_sprite_object
 
 -- Editor sprite metatable: Handles editor sprite property assignment/reading
 editor_sprite_metatable =
@@ -0,0 +1,410 @@
+/**
+ * Headless benchmark: run the game for a fixed number of frames
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <algorithm>
+#include <vector>
+
+#include "AppBenchmark.h"
+#include "dinkc.h"
+#include "dinkini.h"
+#include "game_engine.h"
+#include "game_state.h"
+#include "gfx.h"
+#include "gfx_sprites.h"
+#include "input.h"
+#include "input_replay.h"
+#include "io_util.h"
+#include "live_sprites_grid.h"
+#include "live_sprites_manager.h"
+#include "log.h"
+#include "paths.h"
+#include "rect.h"
+#include "savegame.h"
+#include "screen_prefetch.h"
+#include "scripting.h"
+#include "status.h"
+#include "str_util.h"
+#include "update_frame.h"
+
+#include "SDL.h"
+
+AppBenchmark::AppBenchmark()
+	: frames(1000), tick_step(1000 / FPS), seed(1), savegame(0), replay(NULL),
+	output(NULL), status(EXIT_SUCCESS), depth_rank(),
+	missile_checks(), var_lookups(), load_serial_ms(0), load_threaded_ms(0) {
+	description = "Runs a D-Mod without display nor sound card and reports "
+		"engine timings as JSON.";
+	headless = true;
+}
+
+/**
+ * Run 'frames' game frames as fast as possible, with the game clock
+ * advancing by 'tick_step' each frame, then write the report. With an
+ * input log, run it to the end with the recorded input and timing
+ * instead. After each frame, the depth ranking, the missile checks
+ * and the variable lookups are redone with the implementations they
+ * replaced for comparison, outside of the frame timings. Last,
+ * dink.ini is loaded again without and with the loader threads.
+ */
+void AppBenchmark::loop() {
+	/* Nobody's holding a controller */
+	joystick = 0;
+
+	if (savegame > 0) {
+		/* Like DinkC's load_game() */
+		scripting_kill_all_scripts_for_real();
+		if (!load_game(savegame))
+			log_error("⏱️ Could not load game %d, running from the title screen",
+					savegame);
+		*pupdate_status = 1;
+		draw_status_all();
+	}
+
+	std::vector<double> frame_us;
+	std::vector<int> sprites;
+	std::vector<Uint64> instructions;
+	frame_us.reserve(frames);
+	sprites.reserve(frames);
+	instructions.reserve(frames);
+
+	Uint64 freq = SDL_GetPerformanceFrequency();
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (int i = 0; (replay != NULL || i < frames) && run; i++) {
+		/* Scripts quit the game with SDL_QUIT */
+		SDL_Event ev;
+		while (SDL_PollEvent(&ev))
+			if (ev.type == SDL_QUIT)
+				run = 0;
+		input_reset();
+		if (replay != NULL) {
+			if (!input_replay_frame_begin())
+				break;
+			while (input_replay_poll_event(&ev)) {
+				if (ev.type == SDL_QUIT)
+					run = 0;
+				else
+					input(&ev);
+			}
+		} else {
+			game_advance_fixed_ticks();
+		}
+
+		Uint64 instr = dinkc_instructions;
+		Uint64 t0 = SDL_GetPerformanceCounter();
+		updateFrame();
+		Uint64 t1 = SDL_GetPerformanceCounter();
+
+		frame_us.push_back((t1 - t0) * 1000000.0 / freq);
+		instructions.push_back(dinkc_instructions - instr);
+		int active = 0;
+		for (int h = 1; h <= last_sprite_created; h++)
+			if (spr[h].active)
+				active++;
+		sprites.push_back(active);
+
+		compare_depth_rank();
+		compare_missile_checks();
+		compare_var_lookups();
+	}
+	double wall_ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / freq;
+	run = 0;
+
+	if (replay == NULL && frame_us.size() < (size_t)frames)
+		log_info("⏱️ Game quit after %d frames", (int)frame_us.size());
+	compare_dinkini_load();
+
+	FILE* out = stdout;
+	if (output != NULL) {
+		out = fopen(output, "w");
+		if (out == NULL) {
+			log_error("⏱️ Cannot write %s: %s", output, strerror(errno));
+			status = EXIT_FAILURE;
+			return;
+		}
+	}
+	report(out, wall_ms, frame_us, sprites, instructions);
+	if (out != stdout)
+		fclose(out);
+}
+
+/**
+ * screen_rank_game_sprites() before the depth index: a selection sort
+ * over all the sprites
+ */
+static void selection_sort_rank(int* rank) {
+	memset(rank, 0, MAX_SPRITES_AT_ONCE * sizeof(int));
+	bool already_checked[MAX_SPRITES_AT_ONCE + 1] = {0};
+	for (int r1 = 0; r1 < last_sprite_created; r1++) {
+		int highest_sprite = 22000; //more than it could ever be
+		for (int h1 = 1; h1 <= last_sprite_created; h1++) {
+			if (!already_checked[h1] && spr[h1].active) {
+				int height = (spr[h1].que != 0) ? spr[h1].que : spr[h1].y;
+				if (height < highest_sprite) {
+					highest_sprite = height;
+					rank[r1] = h1;
+				}
+			}
+		}
+		if (rank[r1] != 0)
+			already_checked[rank[r1]] = true;
+	}
+}
+
+/**
+ * Rank the sprites as the frame left them, with the depth index and
+ * with the selection sort it replaced
+ */
+void AppBenchmark::compare_depth_rank() {
+	int rank[MAX_SPRITES_AT_ONCE], expected[MAX_SPRITES_AT_ONCE];
+	Uint64 freq = SDL_GetPerformanceFrequency();
+	Uint64 t0 = SDL_GetPerformanceCounter();
+	lsm_depth_rank(rank);
+	Uint64 t1 = SDL_GetPerformanceCounter();
+	selection_sort_rank(expected);
+	Uint64 t2 = SDL_GetPerformanceCounter();
+
+	depth_rank.new_us.push_back((t1 - t0) * 1000000.0 / freq);
+	depth_rank.old_us.push_back((t2 - t1) * 1000000.0 / freq);
+	depth_rank.calls++;
+	if (memcmp(rank, expected, sizeof(rank)) != 0)
+		depth_rank.mismatches++;
+}
+
+/* missile_brain()'s test: 'h' hits 'j' if it's inside j's hardbox
+   inflated by h's range */
+static bool missile_hits(int h, int j) {
+	rect box;
+	rect_copy(&box, &k[getpic(j)].hardbox);
+	rect_offset(&box, spr[j].x, spr[j].y);
+	if (spr[h].range != 0)
+		rect_inflate(&box, spr[h].range, spr[h].range);
+	return inside_box(spr[h].x, spr[h].y, box);
+}
+
+/**
+ * Fire every sprite as a missile, like in a projectile-heavy fight,
+ * and count what each one hits through the sprites grid and with the
+ * full scan it replaced
+ */
+void AppBenchmark::compare_missile_checks() {
+	static int candidates[MAX_SPRITES_AT_ONCE];
+	static int hits_grid[MAX_SPRITES_AT_ONCE], hits_scan[MAX_SPRITES_AT_ONCE];
+	int last = std::min(last_sprite_created, MAX_SPRITES_AT_ONCE - 1);
+	Uint64 freq = SDL_GetPerformanceFrequency();
+
+	Uint64 t0 = SDL_GetPerformanceCounter();
+	sprites_grid_invalidate();
+	for (int h = 1; h <= last; h++) {
+		hits_grid[h] = 0;
+		if (!spr[h].active)
+			continue;
+		long range = labs(spr[h].range);
+		if (range > 100000)
+			range = 100000;
+		int n = sprites_grid_query(spr[h].x, spr[h].y, range, 0, candidates);
+		for (int c = 0; c < n; c++) {
+			int j = candidates[c];
+			if (j != h && spr[j].active && missile_hits(h, j))
+				hits_grid[h]++;
+		}
+	}
+	Uint64 t1 = SDL_GetPerformanceCounter();
+	for (int h = 1; h <= last; h++) {
+		hits_scan[h] = 0;
+		if (!spr[h].active)
+			continue;
+		for (int j = 1; j <= last; j++)
+			if (j != h && spr[j].active && missile_hits(h, j))
+				hits_scan[h]++;
+	}
+	Uint64 t2 = SDL_GetPerformanceCounter();
+
+	missile_checks.new_us.push_back((t1 - t0) * 1000000.0 / freq);
+	missile_checks.old_us.push_back((t2 - t1) * 1000000.0 / freq);
+	for (int h = 1; h <= last; h++)
+		if (spr[h].active)
+			missile_checks.calls++;
+	if (memcmp(&hits_grid[1], &hits_scan[1], last * sizeof(int)) != 0)
+		missile_checks.mismatches++;
+}
+
+/**
+ * search_var_with_this_scope_108() before the variable index: a scan
+ * of every slot, local scope first
+ */
+static int linear_search_var_108(char* variable, int var_scope) {
+	int search_scope[2] = { var_scope, VAR_GLOBAL_SCOPE };
+	for (int i = 0; i < 2; i++)
+		for (int v = 1; v < MAX_VARS; v++)
+			if (play.var[v].active && play.var[v].scope == search_scope[i]
+				&& compare(play.var[v].name, variable))
+				return v;
+	return -1;
+}
+
+/**
+ * Look up every live variable from its own scope, through the index
+ * and with the linear scan it replaced
+ */
+void AppBenchmark::compare_var_lookups() {
+	static int found_index[MAX_VARS], found_scan[MAX_VARS];
+	Uint64 freq = SDL_GetPerformanceFrequency();
+
+	Uint64 t0 = SDL_GetPerformanceCounter();
+	for (int i = 1; i < MAX_VARS; i++)
+		if (play.var[i].active)
+			found_index[i] = search_var_with_this_scope_108(play.var[i].name,
+															play.var[i].scope);
+	Uint64 t1 = SDL_GetPerformanceCounter();
+	for (int i = 1; i < MAX_VARS; i++)
+		if (play.var[i].active)
+			found_scan[i] = linear_search_var_108(play.var[i].name, play.var[i].scope);
+	Uint64 t2 = SDL_GetPerformanceCounter();
+
+	var_lookups.new_us.push_back((t1 - t0) * 1000000.0 / freq);
+	var_lookups.old_us.push_back((t2 - t1) * 1000000.0 / freq);
+	int mismatch = 0;
+	for (int i = 1; i < MAX_VARS; i++) {
+		if (play.var[i].active) {
+			var_lookups.calls++;
+			if (found_index[i] != found_scan[i])
+				mismatch = 1;
+		}
+	}
+	var_lookups.mismatches += mismatch;
+}
+
+/**
+ * Load dink.ini again, once decoding the graphics on the main thread
+ * and once on the loader threads, as at startup. This replaces all
+ * the sprite graphics, so it runs after the last frame. Both loads
+ * see the same file system and asset_cache state.
+ */
+void AppBenchmark::compare_dinkini_load() {
+	/* It decodes graphics too */
+	screen_prefetch_quit();
+
+	int decode_threads = gfx_sprites_decode_threads;
+	int nb_threads[2] = { 0, decode_threads != 0 ? decode_threads : -1 };
+	double* load_ms[2] = { &load_serial_ms, &load_threaded_ms };
+	int nb = nb_idata;
+	for (int i = 0; i < 2; i++) {
+		sprites_unload();
+		memset(seq, 0, sizeof(seq));
+		dinkini_quit();
+		dinkini_init(nb);
+		gfx_sprites_decode_threads = nb_threads[i];
+		Uint64 start = SDL_GetPerformanceCounter();
+		load_batch(false);
+		*load_ms[i] = (SDL_GetPerformanceCounter() - start) * 1000.0
+			/ SDL_GetPerformanceFrequency();
+	}
+	gfx_sprites_decode_threads = decode_threads;
+}
+
+/* Nearest-rank percentile of sorted values */
+template <typename T> static T percentile(std::vector<T>& sorted, int p) {
+	if (sorted.empty())
+		return 0;
+	size_t rank = (sorted.size() * p + 99) / 100;
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+template <typename T> static double mean(std::vector<T>& values) {
+	if (values.empty())
+		return 0;
+	double sum = 0;
+	for (T v : values)
+		sum += v;
+	return sum / values.size();
+}
+
+template <typename T> static T maximum(std::vector<T>& values) {
+	if (values.empty())
+		return 0;
+	return *std::max_element(values.begin(), values.end());
+}
+
+static void report_comparison(FILE* out, const char* name, const char* new_name,
+							const char* old_name, struct benchmark_comparison& c) {
+	fprintf(out, "  \"%s\": {\"calls\": %llu, "
+			"\"%s_us\": {\"mean\": %.3f, \"max\": %.3f}, "
+			"\"%s_us\": {\"mean\": %.3f, \"max\": %.3f}, \"mismatches\": %d},\n",
+			name, (unsigned long long)c.calls,
+			new_name, mean(c.new_us), maximum(c.new_us),
+			old_name, mean(c.old_us), maximum(c.old_us), c.mismatches);
+}
+
+void AppBenchmark::report(FILE* out, double wall_ms,
+						std::vector<double>& frame_us, std::vector<int>& sprites,
+						std::vector<Uint64>& instructions) {
+	std::vector<double> sorted(frame_us);
+	std::sort(sorted.begin(), sorted.end());
+	Uint64 total_instructions = 0;
+	for (Uint64 n : instructions)
+		total_instructions += n;
+
+	fprintf(out, "{\n");
+	fprintf(out, "  \"dmod\": ");
+	write_json_string(paths_getdmodname(), out);
+	fprintf(out, ",\n");
+	fprintf(out, "  \"version\": \"%s\",\n", VERSION);
+	fprintf(out, "  \"truecolor\": %s,\n", truecolor ? "true" : "false");
+	fprintf(out, "  \"engine_version\": %d,\n", dversion);
+	fprintf(out, "  \"frames\": %d,\n", (int)frame_us.size());
+	fprintf(out, "  \"tick_step_ms\": %llu,\n", (unsigned long long)tick_step);
+	fprintf(out, "  \"seed\": %u,\n", seed);
+	fprintf(out, "  \"replay\": ");
+	if (replay != NULL)
+		write_json_string(replay, out);
+	else
+		fprintf(out, "null");
+	fprintf(out, ",\n");
+	fprintf(out, "  \"wall_ms\": %.3f,\n", wall_ms);
+	fprintf(out, "  \"frame_us\": {\"mean\": %.3f, \"min\": %.3f, \"p50\": %.3f, "
+			"\"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+			mean(frame_us), sorted.empty() ? 0 : sorted.front(),
+			percentile(sorted, 50), percentile(sorted, 90),
+			percentile(sorted, 99), sorted.empty() ? 0 : sorted.back());
+	fprintf(out, "  \"sprites\": {\"mean\": %.2f, \"max\": %d},\n", mean(sprites),
+			sprites.empty() ? 0 : *std::max_element(sprites.begin(), sprites.end()));
+	report_comparison(out, "depth_rank", "index", "selection_sort", depth_rank);
+	report_comparison(out, "missile_checks", "grid", "full_scan", missile_checks);
+	report_comparison(out, "var_lookups", "index", "linear_scan", var_lookups);
+	fprintf(out, "  \"dinkini_load_ms\": {\"serial\": %.3f, \"threaded\": %.3f},\n",
+			load_serial_ms, load_threaded_ms);
+	fprintf(out, "  \"script_instructions\": {\"total\": %llu, \"mean\": %.2f, "
+			"\"max\": %llu}\n",
+			(unsigned long long)total_instructions, mean(instructions),
+			(unsigned long long)(instructions.empty() ? 0
+					: *std::max_element(instructions.begin(), instructions.end())));
+	fprintf(out, "}\n");
+}
@@ -0,0 +1,60 @@
+/**
+ * Headless benchmark: run the game for a fixed number of frames
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+#include "AppFreeDink.h"
+
+/* A new implementation timed against the one it replaced, on the same
+   input */
+struct benchmark_comparison {
+	std::vector<double> new_us, old_us;
+	Uint64 calls;
+	int mismatches;
+};
+
+class AppBenchmark : public AppFreeDink {
+public:
+	int frames;
+	Uint64 tick_step; // ms of game time per frame
+	unsigned int seed;
+	int savegame; // slot to load first, 0 for the title screen
+	char* replay; // input log to play instead of idling, NULL for none
+	char* output; // JSON report, NULL for stdout
+	int status;
+	struct benchmark_comparison depth_rank;
+	struct benchmark_comparison missile_checks;
+	struct benchmark_comparison var_lookups;
+	double load_serial_ms, load_threaded_ms; // dink.ini
+
+	AppBenchmark();
+	void loop();
+	void compare_depth_rank();
+	void compare_missile_checks();
+	void compare_var_lookups();
+	void compare_dinkini_load();
+	void report(FILE* out, double wall_ms, std::vector<double>& frame_us,
+				std::vector<int>& sprites, std::vector<Uint64>& instructions);
+};
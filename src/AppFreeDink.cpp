@@ -29,6 +29,7 @@
 
 #include "AppFreeDink.h"
 #include "bgm.h"
+#include "input_replay.h"
 #include "dinkc_console.h"
 #include "scripting.h"
 #include "dinkc_console_renderer.h"
@@ -44,6 +45,7 @@
 #include "sfx.h"
 #include "game_choice.h"
 #include "update_frame.h"
+#include "profiler.h"
 
 #include "SDL.h"
 
@@ -271,8 +273,10 @@ void AppFreeDink::input(SDL_Event* ev) {
 		input_update(ev);
 	}
 	}
-	else {
+	else if (input_replay_get_mode() != INPUT_REPLAY_PLAY) {
 		//Send input to ImGui when text enabled
+		/* These events bypass input_replay_record_event(): debug
+		console input is not part of a recording */
 		SDL_Event event;
 		while (SDL_PollEvent(&event))
         {
@@ -289,9 +293,12 @@ void AppFreeDink::input(SDL_Event* ev) {
 void AppFreeDink::logic() {
 #ifndef __EMSCRIPTEN__
 	// TODO: fine-tune framerate from emscripten - should mostly be 60FPS as we want *for 1.08*
-	if (!dbg.framelimit && mode > 0)
+	if (!dbg.framelimit && mode > 0) {
+		prof_scope prof(PROF_WAIT);
 		SDL_framerateDelay(&framerate_manager);
+	}
 #endif
+	bgm_update();
 	//Yeolde: added this to pause the game
 	if (!game_paused()) {
 	if (high_speed == 2) {
@@ -309,6 +316,7 @@ void AppFreeDink::logic() {
 	}
 	/* Renderers */
 	if (!abort_this_flip) {
+		prof_scope prof(PROF_FLIP);
 		g_display->clear();
 		//dinkc_console_renderer_render();
 		g_display->flipStretch(IOGFX_backbuffer); // game area
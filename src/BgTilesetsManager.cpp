@@ -8,6 +8,7 @@
 #include "log.h"
 #include "gfx.h"
 #include "ImageLoader.h"
+#include "gfx_diskcache.h"
 #include "IOGfxDisplay.h"
 #include "SDL_image.h"
 #include "io_util.h"
@@ -68,16 +69,29 @@ void BgTilesetsManager::loadDefault() {
 }
 
 void BgTilesetsManager::loadSlot(int slot, char* relpath) {
-	FILE* in = paths_dmodfile_fopen(relpath, "rb");
-	if (in == NULL)
-		in = paths_fallbackfile_fopen(relpath, "rb");
+	char* fullpath = paths_dmodfile(relpath);
+	FILE* in = fopen(fullpath, "rb");
+	if (in == NULL) {
+		free(fullpath);
+		fullpath = paths_fallbackfile(relpath);
+		in = fopen(fullpath, "rb");
+	}
 
 	if (slots[slot] != NULL) {
 		delete slots[slot];
 		slots[slot] = NULL;
 	}
 
-	SDL_Surface* image = ImageLoader::loadToBlitFormat(in);
+	SDL_Surface* image = NULL;
+	if (in != NULL)
+		image = gfx_diskcache_load(fullpath, NULL, 0);
+	if (image != NULL) {
+		fclose(in);
+	} else {
+		image = ImageLoader::loadToBlitFormat(in);
+		gfx_diskcache_store(fullpath, NULL, 0, image);
+	}
+	free(fullpath);
 	slots[slot] = g_display->upload(image);
 
 	/* Note: attempting SDL_RLEACCEL showed no improvement for the
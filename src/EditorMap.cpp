@@ -26,6 +26,7 @@
 #endif
 
 #include <stdio.h>
+#include <string.h>
 
 #include "EditorMap.h"
 
@@ -51,18 +52,16 @@ bool EditorMap::load() {
 	if (!f)
 		return false;
 
-	/* Portably load EditorMap from disk */
-	int i = 0;
-	fseek(f, 20, SEEK_CUR); // unused 'name' field
-	for (i = 0; i < 769; i++)
-		loc[i] = read_lsb_int(f);
-	for (i = 0; i < 769; i++)
-		music[i] = read_lsb_int(f);
-	for (i = 0; i < 769; i++)
-		indoor[i] = read_lsb_int(f);
-	fseek(f, 2240, SEEK_CUR); // unused space
-
+	/* Portably load EditorMap from disk, in one read */
+	unsigned char buf[20 + 3 * 769 * 4];
+	memset(buf, 0, sizeof(buf));
+	fread(buf, sizeof(buf), 1, f);
 	fclose(f);
+	// skip unused 'name' field
+	decode_lsb_ints(buf + 20, loc, 769);
+	decode_lsb_ints(buf + 20 + 769 * 4, music, 769);
+	decode_lsb_ints(buf + 20 + 2 * 769 * 4, indoor, 769);
+	// followed by 2240 bytes of unused space
 
 	memset(&ts_loc_mem, 0, sizeof(ts_loc_mem));
 
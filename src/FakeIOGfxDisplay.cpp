@@ -1,8 +1,26 @@
 #include "FakeIOGfxDisplay.h"
+#include "IOGfxSurfaceSW.h"
+#include "ImageLoader.h" /* GFX_ref_pal */
+#include "log.h"
+#include "imgui.h"
 
 FakeIOGfxDisplay::FakeIOGfxDisplay(int w, int h, bool truecolor, Uint32 flags)
 	: IOGfxDisplay(w, h, truecolor, flags) {
 }
+bool FakeIOGfxDisplay::open() {
+	/* Input handling queries ImGui even without a window */
+	if (ImGui::GetCurrentContext() == NULL)
+		ImGui::CreateContext();
+	return true;
+}
+void FakeIOGfxDisplay::close() {
+	if (ImGui::GetCurrentContext() != NULL)
+		ImGui::DestroyContext();
+}
+void FakeIOGfxDisplay::logDisplayInfo() {
+	log_info("🖌️ Headless display, truecolor mode: %s, SW buffer format: %s",
+			truecolor ? "on" : "off", SDL_GetPixelFormatName(getFormat()));
+}
 void FakeIOGfxDisplay::clear() {
 }
 void FakeIOGfxDisplay::flip(IOGfxSurface* backbuffer, SDL_Rect* dstrect,
@@ -11,10 +29,20 @@ void FakeIOGfxDisplay::flip(IOGfxSurface* backbuffer, SDL_Rect* dstrect,
 void FakeIOGfxDisplay::onSizeChange(int w, int h) {
 }
 IOGfxSurface* FakeIOGfxDisplay::upload(SDL_Surface* s) {
-	return NULL;
+	return new IOGfxSurfaceSW(s);
 }
 IOGfxSurface* FakeIOGfxDisplay::allocBuffer(int surfW, int surfH) {
-	return NULL;
+	Uint32 Rmask = 0, Gmask = 0, Bmask = 0, Amask = 0;
+	int bpp = 0;
+	SDL_PixelFormatEnumToMasks(getFormat(), &bpp, &Rmask, &Gmask, &Bmask,
+							&Amask);
+	SDL_Surface* image = SDL_CreateRGBSurface(0, surfW, surfH, bpp, Rmask,
+											Gmask, Bmask, Amask);
+	if (image == NULL)
+		return NULL;
+	if (!truecolor)
+		SDL_SetPaletteColors(image->format->palette, GFX_ref_pal, 0, 256);
+	return new IOGfxSurfaceSW(image);
 }
 SDL_Surface* FakeIOGfxDisplay::screenshot(SDL_Rect* rect) {
 	return NULL;
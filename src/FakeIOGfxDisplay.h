@@ -3,9 +3,14 @@
 
 #include "IOGfxDisplay.h"
 
+/* Display without a window: software buffers are kept in memory and
+   flips are dropped (tests, headless benchmark) */
 class FakeIOGfxDisplay : public IOGfxDisplay {
 public:
 	FakeIOGfxDisplay(int w, int h, bool truecolor, Uint32 flags);
+	virtual bool open();
+	virtual void close();
+	virtual void logDisplayInfo();
 	virtual void clear();
 	virtual void flip(IOGfxSurface* backbuffer, SDL_Rect* dstrect,
 					bool interpolation, bool hwflip);
@@ -5,6 +5,7 @@
 #include "IOGfxDisplaySW.h"
 #include "IOGfxSurfaceSW.h"
 #include "gfx_palette.h"
+#include "gfx_pixels.h"
 #include "gfx.h"
 #include "ImageLoader.h" /* GFX_ref_pal */ // TODO: break dep
 
@@ -29,7 +30,8 @@
 IOGfxDisplaySW::IOGfxDisplaySW(int w, int h, bool truecolor, Uint32 flags)
 	: IOGfxDisplay(w, h, truecolor, flags), renderer(NULL),
 	render_texture_linear(NULL), render_texture_nearest(NULL),
-	rgb_screen(NULL) {
+	rgb_screen(NULL), uploaded_texture(NULL), uploaded_id(0) {
+	memset(uploaded_pal, 0, sizeof(uploaded_pal));
 }
 
 IOGfxDisplaySW::~IOGfxDisplaySW() {
@@ -42,6 +44,7 @@ bool IOGfxDisplaySW::open() {
 
 	if (!IOGfxDisplay::open())
 		return false;
+	gfx_pixels_init();
 	if (!createRenderer())
 		return false;
 	if (!createRenderTexture(req_w, req_h))
@@ -54,6 +57,7 @@ void IOGfxDisplaySW::close() {
 	if (render_texture_linear)
 		SDL_DestroyTexture(render_texture_linear);
 	render_texture_linear = NULL;
+	uploaded_texture = NULL;
 	if (rgb_screen)
 		SDL_FreeSurface(rgb_screen);
 	rgb_screen = NULL;
@@ -230,6 +234,7 @@ void IOGfxDisplaySW::logRenderTextureInfo() {
 
 void IOGfxDisplaySW::logDisplayInfo() {
 	log_info("👨‍🎨 YeOldeDink graphics mode: IOGfxDisplaySW");
+	log_info("👨‍🎨 Pixel kernels: %s", gfx_pixels_get_name());
 	IOGfxDisplay::logDisplayInfo();
 	logRenderersInfo();
 	logRenderTextureInfo();
@@ -242,38 +247,24 @@ void IOGfxDisplaySW::clear() {
 void gfx_fade_apply(SDL_Surface* screen, int brightness) {
 	/* Check SDL_blit.h in the SDL source code for guidance */
 	SDL_LockSurface(screen);
-	/* Progress per pixel rather than per byte */
-	int remainder =
-			(screen->pitch - (screen->w * screen->format->BytesPerPixel)) /
-			screen->format->BytesPerPixel;
-	/* Using aligned Uint32 is faster than working with Uint8 values */
-	Uint32* p = (Uint32*)screen->pixels;
-	int height = screen->h;
-	while (height--) {
-		int x;
-		for (x = 0; x < screen->w; x++) {
-			/* Assume that pixel order is RGBA */
 #if SDL_BYTEORDER == SDL_LIL_ENDIAN
-			if (*p != 0x00FFFFFF || debug_fullfade) { // skip white
+	int skip_white = !debug_fullfade;
 #else
-			if (*p != 0xFFFFFF00) { // TODO: I need a PPC tester for this
+	int skip_white = 1; // TODO: I need a PPC tester for this
 #endif
-				*((Uint8*)p) = *((Uint8*)p) * brightness >> 8;
-				*((Uint8*)p + 1) = *((Uint8*)p + 1) * brightness >> 8;
-				*((Uint8*)p + 2) = *((Uint8*)p + 2) * brightness >> 8;
-			}
-			p++;
-		}
-		p += remainder;
+	Uint8* row = (Uint8*)screen->pixels;
+	for (int y = 0; y < screen->h; y++) {
+		gfx_fade_row((Uint32*)row, screen->w, brightness, skip_white);
+		row += screen->pitch;
 	}
 	SDL_UnlockSurface(screen);
 }
 
 void IOGfxDisplaySW::flip(IOGfxSurface* backbuffer, SDL_Rect* dstrect,
 						bool interpolation, bool hwflip) {
-	/* For now we do all operations on the CPU side and perform a big
-	texture update at each frame; this is necessary to support
-	palette and fade_down/fade_up. */
+	/* For now we do all operations on the CPU side and update the
+	texture at each frame; this is necessary to support palette and
+	fade_down/fade_up. Only the areas that changed get uploaded. */
 	ImGui_ImplSDLRenderer2_NewFrame();
     ImGui_ImplSDL2_NewFrame();
     ImGui::NewFrame();
@@ -310,49 +301,79 @@ void IOGfxDisplaySW::flip(IOGfxSurface* backbuffer, SDL_Rect* dstrect,
 		io.MouseDrawCursor = false;
 	}
 	/* Convert to destination buffer format */
-	SDL_Surface* source = dynamic_cast<IOGfxSurfaceSW*>(backbuffer)->image;
+	IOGfxSurfaceSW* backbuffer_sw = dynamic_cast<IOGfxSurfaceSW*>(backbuffer);
+	SDL_Surface* source = backbuffer_sw->image;
 
-	if (truecolor && brightness < 256)
+	interpolation = dbg.debug_interp;
+	if (dbg.debug_assratio)
+	dstrect = NULL;
+	SDL_Texture* texture = interpolation ? render_texture_linear : render_texture_nearest;
+
+	/* Only convert and upload what changed since the last frame; fades
+	and palette changes alter every pixel so they refresh it all */
+	bool full = (texture != uploaded_texture || backbuffer_sw->id != uploaded_id);
+	SDL_Color pal_phys[256];
+	if (!truecolor) {
+		gfx_palette_get_phys(pal_phys);
+		if (memcmp(pal_phys, uploaded_pal, sizeof(pal_phys)) != 0) {
+			memcpy(uploaded_pal, pal_phys, sizeof(pal_phys));
+			full = true;
+		}
+	}
+
+	if (truecolor && brightness < 256) {
 		gfx_fade_apply(source, brightness);
+		backbuffer_sw->addDamage(NULL);
+	}
+
+	SDL_Rect whole = {0, 0, SDL_min(source->w, GFX_RES_W), SDL_min(source->h, GFX_RES_H)};
+	if (!truecolor) {
+		whole.w = SDL_min(whole.w, rgb_screen->w);
+		whole.h = SDL_min(whole.h, rgb_screen->h);
+	}
+	struct gfx_damage damage;
+	backbuffer_sw->takeDamage(&damage);
+	if (full || damage.area() > (unsigned int)(whole.w * whole.h) / 4 * 3) {
+		damage.clear();
+		damage.add(&whole);
+	}
+	uploaded_texture = texture;
+	uploaded_id = backbuffer_sw->id;
 
 	if (truecolor) {
 		if (source->format->format != getFormat())
 			log_error("Wrong backbuffer format");
 	} else {
-		/* Convert 8-bit buffer for truecolor texture upload */
-
-		/* Use "physical" screen palette - use SDL_SetPaletteColors to invalidate SDL cache */
-		SDL_Color pal_bak[256];
-		SDL_Color pal_phys[256];
-		memcpy(pal_bak, source->format->palette->colors, sizeof(pal_bak));
-		gfx_palette_get_phys(pal_phys);
-		SDL_SetPaletteColors(source->format->palette, pal_phys, 0, 256);
-
-		if (SDL_BlitSurface(source, NULL, rgb_screen, NULL) < 0) {
-			log_error("ERROR: 8-bit->truecolor conversion failed: %s",
-					SDL_GetError());
+		/* Convert 8-bit buffer for truecolor texture upload, using the
+		"physical" screen palette */
+		if (full)
+			gfx_palette_lut_build(&pal_lut, pal_phys, rgb_screen->format);
+		for (int i = 0; i < damage.nb_rects; i++) {
+			SDL_Rect r;
+			if (!SDL_IntersectRect(&damage.rects[i], &whole, &r))
+				continue;
+			for (int y = r.y; y < r.y + r.h; y++) {
+				Uint8* src = (Uint8*)source->pixels + y * source->pitch + r.x;
+				Uint32* dst = (Uint32*)((Uint8*)rgb_screen->pixels + y * rgb_screen->pitch) + r.x;
+				gfx_expand_row(src, dst, r.w, &pal_lut);
+			}
 		}
-		SDL_SetPaletteColors(source->format->palette, pal_bak, 0, 256);
 
 		source = rgb_screen;
 	}
-	interpolation = dbg.debug_interp;
-	if (dbg.debug_assratio)
-	dstrect = NULL;
-
-	if (interpolation) {
-		SDL_UpdateTexture(render_texture_linear, NULL, source->pixels, source->pitch);
-
-		if (debug_drawgame)
-			SDL_RenderCopy(renderer, render_texture_linear, NULL, dstrect);
 
-	} else {
-		SDL_UpdateTexture(render_texture_nearest, NULL, source->pixels, source->pitch);
-
-		if (debug_drawgame)
-			SDL_RenderCopy(renderer, render_texture_nearest, NULL, dstrect);
+	for (int i = 0; i < damage.nb_rects; i++) {
+		SDL_Rect r;
+		if (!SDL_IntersectRect(&damage.rects[i], &whole, &r))
+			continue;
+		Uint8* pixels = (Uint8*)source->pixels + r.y * source->pitch
+			+ r.x * source->format->BytesPerPixel;
+		SDL_UpdateTexture(texture, &r, pixels, source->pitch);
 	}
 
+	if (debug_drawgame)
+		SDL_RenderCopy(renderer, texture, NULL, dstrect);
+
 	if (hwflip)
 		ImGui::Render();
 		ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer);
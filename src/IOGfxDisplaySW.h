@@ -2,6 +2,7 @@
 #define IOGFXDISPLAYSW_H
 
 #include "IOGfxDisplay.h"
+#include "gfx_pixels.h"
 
 class IOGfxDisplaySW : public IOGfxDisplay {
 private:
@@ -12,6 +13,12 @@ private:
 	SDL_Texture* render_texture_nearest;
 	/* Intermediary texture to convert 8bit->24bit in non-truecolor */
 	SDL_Surface* rgb_screen;
+	/* What the render texture currently holds, to only upload changes */
+	SDL_Texture* uploaded_texture;
+	Uint32 uploaded_id;
+	SDL_Color uploaded_pal[256];
+	/* uploaded_pal mapped to rgb_screen's format */
+	struct gfx_palette_lut pal_lut;
 
 public:
 	IOGfxDisplaySW(int w, int h, bool truecolor, Uint32 flags);
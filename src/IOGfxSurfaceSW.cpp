@@ -4,22 +4,37 @@
 
 #include "IOGfxSurfaceSW.h"
 
+#include <limits.h>
+#include <list>
+#include <unordered_map>
+#include <iterator>
+
 #include "SDL.h"
 #include "SDL2_rotozoom.h"
 
 #include "log.h"
 
+static Uint32 surface_ids = 0;
+static Uint32 copy_serials = 0;
+
 IOGfxSurfaceSW::IOGfxSurfaceSW(SDL_Surface* image)
 	: IOGfxSurface(image->w, image->h) {
 	this->image = image;
+	id = ++surface_ids;
+	damage.clear();
+	drawn.clear();
+	changed.clear();
+	copy_serial = base_id = base_serial = 0;
 }
 
 IOGfxSurfaceSW::~IOGfxSurfaceSW() {
+	gfx_stretch_cache_evict(image);
 	SDL_FreeSurface(image);
 }
 
 /* Function specifically made for Dink'C fill_screen() */
 void IOGfxSurfaceSW::fill_screen(int num, SDL_Color* palette) {
+	addDamage(NULL);
 	/* Warning: palette indexes 0 and 255 are hard-coded
 	to black and white (cf. gfx_palette.c). */
 	if (image->format->format == SDL_PIXELFORMAT_INDEX8)
@@ -29,6 +44,7 @@ void IOGfxSurfaceSW::fill_screen(int num, SDL_Color* palette) {
 }
 
 int IOGfxSurfaceSW::fillRect(const SDL_Rect* rect, Uint8 r, Uint8 g, Uint8 b) {
+	addDamage(rect);
 	return SDL_FillRect(image, rect, SDL_MapRGB(image->format, r, g, b));
 }
 
@@ -36,10 +52,271 @@ int IOGfxSurfaceSW::blit(IOGfxSurface* src, const SDL_Rect* srcrect,
 						SDL_Rect* dstrect) {
 	if (src == NULL)
 		return SDL_SetError("IOGfxSurfaceSW::blit: passed a NULL surface");
-	SDL_Surface* src_sdl = dynamic_cast<IOGfxSurfaceSW*>(src)->image;
+	IOGfxSurfaceSW* src_sw = dynamic_cast<IOGfxSurfaceSW*>(src);
+	SDL_Surface* src_sdl = src_sw->image;
+	Uint32 colorkey;
+	SDL_BlendMode blendmode;
+	SDL_GetSurfaceBlendMode(src_sdl, &blendmode);
+	damageCopy(src_sw, srcrect, dstrect,
+			SDL_GetColorKey(src_sdl, &colorkey) == -1 && blendmode == SDL_BLENDMODE_NONE);
 	return SDL_BlitSurface(src_sdl, srcrect, image, dstrect);
 }
 
+void gfx_damage::add(const SDL_Rect* r) {
+	if (r->w <= 0 || r->h <= 0)
+		return;
+	SDL_Rect u = *r;
+	/* Absorb the rectangles it overlaps */
+	int i = 0;
+	while (i < nb_rects) {
+		if (SDL_HasIntersection(&rects[i], &u)) {
+			SDL_UnionRect(&rects[i], &u, &u);
+			rects[i] = rects[--nb_rects];
+			i = 0;
+		} else {
+			i++;
+		}
+	}
+	if (nb_rects == GFX_DAMAGE_RECTS) {
+		/* No room left: grow the rectangle that costs the least extra area */
+		int best = 0;
+		unsigned int best_cost = UINT_MAX;
+		for (i = 0; i < nb_rects; i++) {
+			SDL_Rect tmp;
+			SDL_UnionRect(&rects[i], &u, &tmp);
+			unsigned int cost = tmp.w * tmp.h - rects[i].w * rects[i].h;
+			if (cost < best_cost) {
+				best = i;
+				best_cost = cost;
+			}
+		}
+		SDL_UnionRect(&rects[best], &u, &u);
+		rects[best] = rects[--nb_rects];
+		add(&u); // may overlap others now
+		return;
+	}
+	rects[nb_rects++] = u;
+}
+
+void gfx_damage::merge(const struct gfx_damage* other) {
+	for (int i = 0; i < other->nb_rects; i++)
+		add(&other->rects[i]);
+}
+
+unsigned int gfx_damage::area() const {
+	unsigned int sum = 0;
+	for (int i = 0; i < nb_rects; i++)
+		sum += rects[i].w * rects[i].h;
+	return sum;
+}
+
+/**
+ * Record that 'rect' (NULL for the whole surface) was drawn to
+ */
+void IOGfxSurfaceSW::addDamage(const SDL_Rect* rect) {
+	SDL_Rect bounds = {0, 0, w, h};
+	SDL_Rect r;
+	if (rect == NULL)
+		r = bounds;
+	else if (!SDL_IntersectRect(rect, &bounds, &r))
+		return;
+	damage.add(&r);
+	drawn.add(&r);
+	changed.add(&r);
+}
+
+/**
+ * Get and reset the areas that changed since the last call
+ */
+void IOGfxSurfaceSW::takeDamage(struct gfx_damage* out) {
+	*out = damage;
+	damage.clear();
+}
+
+/**
+ * Record a blit from 'src'. The game restores the whole backbuffer
+ * from the background every frame; rather than marking the full
+ * surface dirty, remember where we differ from the copied surface
+ * (sprites drawn since) and where that surface changed, which is all
+ * that needs refreshing.
+ */
+void IOGfxSurfaceSW::damageCopy(IOGfxSurfaceSW* src, const SDL_Rect* srcrect,
+								const SDL_Rect* dstrect, /*bool*/ int opaque) {
+	SDL_Rect area;
+	area.x = (dstrect != NULL) ? dstrect->x : 0;
+	area.y = (dstrect != NULL) ? dstrect->y : 0;
+	area.w = (srcrect != NULL) ? srcrect->w : src->w;
+	area.h = (srcrect != NULL) ? srcrect->h : src->h;
+
+	if (!opaque || src == this || srcrect != NULL || area.x != 0 || area.y != 0
+		|| src->w != w || src->h != h) {
+		addDamage(&area);
+		return;
+	}
+
+	if (src->id == base_id && src->copy_serial == base_serial) {
+		damage.merge(&drawn);
+		damage.merge(&src->changed);
+		changed.merge(&drawn);
+		changed.merge(&src->changed);
+	} else {
+		/* First copy, or someone else copied 'src' meanwhile and
+		consumed its changes */
+		addDamage(NULL);
+	}
+	drawn.clear();
+	src->changed.clear();
+	src->copy_serial = ++copy_serials;
+	base_id = src->id;
+	base_serial = src->copy_serial;
+}
+
+/**
+ * Zoomed copies of the sprites drawn with blitStretch(), most recently
+ * used first. zoomSurface() output only depends on the source pixels,
+ * the target size and the flip direction, so that's what we key on,
+ * plus the colorkey and palette that get copied along.
+ */
+struct stretch_key {
+	SDL_Surface* src;
+	int w, h; /* negative when flipped */
+	Uint32 colorkey;
+	int colorkey_enabled;
+	Uint32 palette_version;
+	bool operator==(const struct stretch_key& o) const {
+		return src == o.src && w == o.w && h == o.h
+			&& colorkey == o.colorkey && colorkey_enabled == o.colorkey_enabled
+			&& palette_version == o.palette_version;
+	}
+};
+struct stretch_key_hash {
+	size_t operator()(const struct stretch_key& k) const {
+		size_t h = std::hash<void*>()(k.src);
+		h = h * 31 + (unsigned)k.w;
+		h = h * 31 + (unsigned)k.h;
+		h = h * 31 + k.colorkey;
+		h = h * 31 + k.palette_version;
+		return h;
+	}
+};
+struct stretch_entry {
+	struct stretch_key key;
+	SDL_Surface* scaled;
+	unsigned int bytes;
+};
+typedef std::list<struct stretch_entry>::iterator stretch_iterator;
+
+static std::list<struct stretch_entry> stretch_lru;
+static std::unordered_map<struct stretch_key, stretch_iterator, stretch_key_hash> stretch_index;
+static struct gfx_stretch_cache_stats stretch_stats = {0, 0, 0, 0, 0, 8 * 1024 * 1024};
+
+static void stretch_cache_drop(stretch_iterator it) {
+	stretch_index.erase(it->key);
+	stretch_stats.bytes -= it->bytes;
+	stretch_stats.entries--;
+	SDL_FreeSurface(it->scaled);
+	stretch_lru.erase(it);
+}
+
+static void stretch_cache_trim() {
+	while (stretch_stats.bytes > stretch_stats.budget && !stretch_lru.empty()) {
+		stretch_cache_drop(std::prev(stretch_lru.end()));
+		stretch_stats.evictions++;
+	}
+}
+
+/**
+ * Memory allowed for zoomed surfaces, in bytes; 0 disables caching
+ */
+void gfx_stretch_cache_set_budget(unsigned int bytes) {
+	stretch_stats.budget = bytes;
+	stretch_cache_trim();
+}
+
+void gfx_stretch_cache_get_stats(struct gfx_stretch_cache_stats* stats) {
+	*stats = stretch_stats;
+}
+
+/**
+ * Forget the zoomed copies of 'src', before it gets freed (and its
+ * address possibly reused)
+ */
+void gfx_stretch_cache_evict(SDL_Surface* src) {
+	if (stretch_lru.empty())
+		return;
+	stretch_iterator it = stretch_lru.begin();
+	while (it != stretch_lru.end()) {
+		stretch_iterator cur = it++;
+		if (cur->key.src == src)
+			stretch_cache_drop(cur);
+	}
+}
+
+void gfx_stretch_cache_clear() {
+	while (!stretch_lru.empty())
+		stretch_cache_drop(stretch_lru.begin());
+}
+
+/**
+ * Return 'src_surf' zoomed by sx/sy, from the cache when possible.
+ * 'owned' is set when the caller has to free the result.
+ */
+static SDL_Surface* stretch_cache_get(SDL_Surface* src_surf, double sx,
+									double sy, /*bool*/ int* owned) {
+	struct stretch_key key;
+	key.src = src_surf;
+	zoomSurfaceSize(src_surf->w, src_surf->h, sx, sy, &key.w, &key.h);
+	if (sx < 0)
+		key.w = -key.w;
+	if (sy < 0)
+		key.h = -key.h;
+	key.colorkey = 0;
+	key.colorkey_enabled = (SDL_GetColorKey(src_surf, &key.colorkey) != -1);
+	SDL_Palette* palette = src_surf->format->palette;
+	key.palette_version = (palette != NULL) ? palette->version : 0;
+
+	auto found = stretch_index.find(key);
+	if (found != stretch_index.end()) {
+		stretch_stats.hits++;
+		stretch_lru.splice(stretch_lru.begin(), stretch_lru, found->second);
+		*owned = 0;
+		return found->second->scaled;
+	}
+	stretch_stats.misses++;
+
+	SDL_Surface* scaled = zoomSurface(src_surf, sx, sy, SMOOTHING_OFF);
+	if (scaled == NULL)
+		return NULL;
+
+	/* Keep the same transparency / alpha parameters (SDL_gfx bug,
+	report submitted to the author: SDL_gfx adds transparency to
+	non-transparent surfaces) */
+	Uint8 r, g, b, a;
+	SDL_GetRGBA(key.colorkey, src_surf->format, &r, &g, &b, &a);
+
+	SDL_SetColorKey(scaled, key.colorkey_enabled,
+					SDL_MapRGBA(scaled->format, r, g, b, a));
+	/* Don't mess with alpha transparency, though: */
+	/* int alpha_flag = src->flags & SDL_SRCALPHA; */
+	/* int alpha = src->format->alpha; */
+	/* SDL_SetAlpha(scaled, alpha_flag, alpha); */
+
+	unsigned int bytes = scaled->h * scaled->pitch;
+	if (bytes > stretch_stats.budget) {
+		*owned = 1;
+		return scaled;
+	}
+	struct stretch_entry entry = {key, scaled, bytes};
+	stretch_lru.push_front(entry);
+	stretch_index[key] = stretch_lru.begin();
+	stretch_stats.bytes += bytes;
+	stretch_stats.entries++;
+	/* Evicts from the back, never the entry we just added */
+	stretch_cache_trim();
+	*owned = 0;
+	return scaled;
+}
+
 /**
  * Blit and resize so that 'src' fits in 'dst_rect'
  */
@@ -65,29 +342,18 @@ int gfx_blit_stretch(SDL_Surface* src_surf, const SDL_Rect* src_rect_opt,
 	/* In principle, double's are precise up to 15 decimal digits */
 	if (fabs(sx - 1) > 1e-10 && fabs(sy - 1) > 1e-10) {
 		//log_debug("sx is %.2f, and sy is %.2f", sx - 1, sy - 1);
-		SDL_Surface* scaled = zoomSurface(src_surf, sx, sy, SMOOTHING_OFF);
-
-		/* Keep the same transparency / alpha parameters (SDL_gfx bug,
-	report submitted to the author: SDL_gfx adds transparency to
-	non-transparent surfaces) */
-		Uint8 r, g, b, a;
-		Uint32 colorkey;
-		int colorkey_enabled = (SDL_GetColorKey(src_surf, &colorkey) != -1);
-		SDL_GetRGBA(colorkey, src_surf->format, &r, &g, &b, &a);
-
-		SDL_SetColorKey(scaled, colorkey_enabled,
-						SDL_MapRGBA(scaled->format, r, g, b, a));
-		/* Don't mess with alpha transparency, though: */
-		/* int alpha_flag = src->flags & SDL_SRCALPHA; */
-		/* int alpha = src->format->alpha; */
-		/* SDL_SetAlpha(scaled, alpha_flag, alpha); */
+		/*bool*/ int owned = 0;
+		SDL_Surface* scaled = stretch_cache_get(src_surf, sx, sy, &owned);
+		if (scaled == NULL)
+			return -1;
 
 		src_rect.x = (int)round(src_rect.x * sx);
 		src_rect.y = (int)round(src_rect.y * sy);
 		src_rect.w = (int)round(src_rect.w * sx);
 		src_rect.h = (int)round(src_rect.h * sy);
 		retval = SDL_BlitScaled(scaled, &src_rect, dst_surf, dst_rect);
-		SDL_FreeSurface(scaled);
+		if (owned)
+			SDL_FreeSurface(scaled);
 	} else {
 		/* No scaling */
 
@@ -102,6 +368,11 @@ int IOGfxSurfaceSW::blitStretch(IOGfxSurface* src, const SDL_Rect* srcrect,
 		return SDL_SetError(
 				"IOGfxSurfaceSW::blitStretch: passed a NULL surface");
 	SDL_Surface* src_sdl = dynamic_cast<IOGfxSurfaceSW*>(src)->image;
+	/* Unscaled blits keep the source size */
+	SDL_Rect area = *dstrect;
+	area.w = SDL_max(area.w, (srcrect != NULL) ? srcrect->w : src->w);
+	area.h = SDL_max(area.h, (srcrect != NULL) ? srcrect->h : src->h);
+	addDamage(&area);
 	return gfx_blit_stretch(src_sdl, srcrect, image, dstrect);
 }
 
@@ -141,7 +412,9 @@ int IOGfxSurfaceSW::blitNoColorKey(IOGfxSurface* src, const SDL_Rect* srcrect,
 	if (src == NULL)
 		return SDL_SetError(
 				"IOGfxSurfaceSW::blitNoColorKey: passed a NULL surface");
-	SDL_Surface* src_sdl = dynamic_cast<IOGfxSurfaceSW*>(src)->image;
+	IOGfxSurfaceSW* src_sw = dynamic_cast<IOGfxSurfaceSW*>(src);
+	SDL_Surface* src_sdl = src_sw->image;
+	damageCopy(src_sw, srcrect, dstrect, 1);
 	return gfx_blit_nocolorkey(src_sdl, srcrect, image, dstrect);
 }
 
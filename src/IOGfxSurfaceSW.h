@@ -4,9 +4,29 @@
 #include "IOGfxSurface.h"
 #include "SDL.h"
 
+/* Changed areas of a surface, as a handful of rectangles */
+#define GFX_DAMAGE_RECTS 8
+struct gfx_damage {
+	int nb_rects;
+	SDL_Rect rects[GFX_DAMAGE_RECTS];
+	void clear() { nb_rects = 0; }
+	void add(const SDL_Rect* r);
+	void merge(const struct gfx_damage* other);
+	unsigned int area() const;
+};
+
 class IOGfxSurfaceSW : public IOGfxSurface {
 public:
 	SDL_Surface* image;
+
+	/* Dirty-rectangle tracking for IOGfxDisplaySW::flip() */
+	Uint32 id; /* unique, unlike 'this' which gets reused */
+	struct gfx_damage damage; /* changed since the last takeDamage() */
+	struct gfx_damage drawn; /* drawn over since the last full copy from base */
+	struct gfx_damage changed; /* changed since last fully copied to another surface */
+	Uint32 copy_serial; /* bumped each time we're fully copied */
+	Uint32 base_id, base_serial; /* source and its copy_serial at our last full copy */
+
 	IOGfxSurfaceSW(SDL_Surface* image);
 	virtual ~IOGfxSurfaceSW();
 	virtual void fill_screen(int num, SDL_Color* palette);
@@ -19,6 +39,23 @@ public:
 							SDL_Rect* dstrect);
 	virtual SDL_Surface* screenshot();
 	virtual unsigned int getMemUsage();
+
+	void addDamage(const SDL_Rect* rect);
+	void takeDamage(struct gfx_damage* out);
+
+private:
+	void damageCopy(IOGfxSurfaceSW* src, const SDL_Rect* srcrect,
+					const SDL_Rect* dstrect, /*bool*/ int opaque);
+};
+
+/* Cache of zoomed surfaces used by blitStretch() */
+struct gfx_stretch_cache_stats {
+	unsigned int hits, misses, evictions;
+	unsigned int entries, bytes, budget;
 };
+extern void gfx_stretch_cache_set_budget(unsigned int bytes);
+extern void gfx_stretch_cache_get_stats(struct gfx_stretch_cache_stats* stats);
+extern void gfx_stretch_cache_evict(SDL_Surface* src);
+extern void gfx_stretch_cache_clear();
 
 #endif
@@ -46,11 +46,17 @@
 #include "live_screen.h"
 #include "gfx.h"
 #include "gfx_fonts.h"
+#include "IOGfxSurfaceSW.h"
+#include "gfx_diskcache.h"
 #include "sfx.h"
 #include "input.h"
 #include "paths.h"
 #include "log.h"
 #include "debug_imgui.h"
+#include "profiler.h"
+#ifndef DINKEDIT
+#include "input_replay.h"
+#endif
 
 #include "imgui.h"
 #include "imgui_impl_sdl2.h"
@@ -193,6 +199,10 @@ void App::print_help(int argc, char* argv[]) {
 	printf(_("  -7, --v1.07           Enable v1.07 compatibility mode\n"));
 	printf(_("  -S, --software-rendering  Do use OpenGL\n"));
 	printf(_("  -c, --config <yedink.ini>  Specify a config file\n"));
+	printf(_("  --profile <trace.json>  Profile frames and write a Chrome trace "
+			"on exit\n"));
+	printf(_("  --record <file>       Record input, for replaying the session\n"));
+	printf(_("  --replay <file>       Replay input recorded with --record\n"));
 	printf("\n");
 	// Tentative option names:
 	//printf(_("  --dinkgl              Full OpenGL acceleration\n"));
@@ -215,7 +225,7 @@ address).  */
  */
 App::App()
 	: splash_path(NULL), g_b_no_write_ini(0), opt_version(108),
-	dinkini_playmidi(false), dinkgl(true), windowed(false) {
+	dinkini_playmidi(false), dinkgl(true), windowed(false), headless(false) {
 	/* chdir to resource paths under woe&android */
 	app_chdir();
 
@@ -259,6 +269,8 @@ bool App::check_arg(int argc, char* argv[]) {
 	char* refdir_opt = NULL;
 	char* dmoddir_opt = NULL;
 	char* conf_opt = NULL;
+	char* record_opt = NULL;
+	char* replay_opt = NULL;
 	int debug_p = 0;
 	joystick = 1;
 
@@ -280,6 +292,9 @@ bool App::check_arg(int argc, char* argv[]) {
 			{"truecolor", no_argument, NULL, 't'},
 			{"nomovie", no_argument, NULL, ','},
 			{"software-rendering", no_argument, NULL, 'S'},
+			{"profile", required_argument, NULL, 'P'},
+			{"record", required_argument, NULL, 'R'},
+			{"replay", required_argument, NULL, 'Y'},
 			{0, 0, 0, 0}};
 
 	char short_options[] = "drc:g:hijsvw7tS";
@@ -332,6 +347,16 @@ bool App::check_arg(int argc, char* argv[]) {
 		case 'S':
 			dinkgl = false;
 			break;
+		case 'P':
+			prof_set_trace_path(optarg);
+			prof_enable(true);
+			break;
+		case 'R':
+			record_opt = optarg;
+			break;
+		case 'Y':
+			replay_opt = optarg;
+			break;
 		case ',':
 			printf(_("Note: -nomovie is accepted for compatibility, but has no "
 					"effect.\n"));
@@ -348,9 +373,21 @@ bool App::check_arg(int argc, char* argv[]) {
 		printf(" (did you forget '--game'?)\n");
 		return false;
 	}
+	if (record_opt != NULL && replay_opt != NULL) {
+		fprintf(stderr, "--record and --replay can't be used together\n");
+		return false;
+	}
 
 	log_init();
 
+#ifndef DINKEDIT
+	/* Before anything reads the clock or the random generators */
+	if (record_opt != NULL && !input_replay_record(record_opt))
+		return false;
+	if (replay_opt != NULL && !input_replay_play(replay_opt))
+		return false;
+#endif
+
 	#ifdef WELL_BEHAVED_DINK
 	//yeolde: message box
 	if (!truecolor && !windowed && dinkgl && sound_on && joystick && dmoddir_opt == NULL && !debug_p) {
@@ -433,6 +470,8 @@ bool App::check_arg(int argc, char* argv[]) {
 	window_w = atoi(yedink.GetValue("display", "window_w", "640"));
 	window_h = atoi(yedink.GetValue("display", "window_h", "480"));
 	strcpy(debug_editor, yedink.GetValue("display", "textedit", "code"));
+	gfx_stretch_cache_set_budget(atoi(yedink.GetValue("display", "stretch_cache_kb", "8192")) * 1024);
+	gfx_diskcache_init(yedink.GetValue("display", "asset_cache", ""));
 	debug_fontsize = atoi(yedink.GetValue("fonts", "debug_pt_size", "14"));
 	audio_samplerate = atoi(yedink.GetValue("audio", "samplerate", "44100"));
 	#ifndef DINKEDIT
@@ -493,7 +532,7 @@ avoid stucking the user in 640x480 when crashing) */
 	//atexit(app_quit);
 
 	/* GFX */
-	if (gfx_init(dinkgl, windowed, splash_path) < 0) {
+	if (gfx_init(dinkgl, windowed, splash_path, headless) < 0) {
 		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, PACKAGE_STRING,
 								log_getLastLog(), NULL);
 		return EXIT_FAILURE;
@@ -536,7 +575,8 @@ avoid stucking the user in 640x480 when crashing) */
 		spdlog::debug("Loaded in {:.3} seconds", sw);
 
 		//imgui.ini
-		ImGui::LoadIniSettingsFromDisk(paths_pkgdatafile("imgui.ini"));
+		if (!headless)
+			ImGui::LoadIniSettingsFromDisk(paths_pkgdatafile("imgui.ini"));
 	}
 	//TODO: make this work properly on Windows
 	#ifndef DINKEDIT
@@ -572,24 +612,36 @@ void App::one_iter() {
 	/* Controller: dispatch events */
 	SDL_Event event;
 	SDL_Event* ev = &event;
-	input_reset();
-	//Yeolde: Changed this to capture events for imgui
-	while (SDL_PollEvent(ev)) {
-		ImGui_ImplSDL2_ProcessEvent(ev);
-		switch (ev->type) {
-		case SDL_QUIT:
-			run = 0;
-			break;
-		default:
-
-			input(ev);
-			break;
+	prof_frame_begin();
+	{
+		prof_scope prof(PROF_INPUT);
+		input_reset();
+#ifndef DINKEDIT
+		input_replay_frame_begin();
+#endif
+		//Yeolde: Changed this to capture events for imgui
+		while (SDL_PollEvent(ev)) {
+#ifndef DINKEDIT
+			if (input_replay_get_mode() == INPUT_REPLAY_PLAY) {
+				/* The log drives the game, only let the player quit */
+				if (ev->type == SDL_QUIT)
+					run = 0;
+				continue;
+			}
+			input_replay_record_event(ev);
+#endif
+			dispatch_event(ev);
 		}
+#ifndef DINKEDIT
+		while (input_replay_poll_event(ev))
+			dispatch_event(ev);
+#endif
 	}
 
 	/* Main app logic */
 
 	logic();
+	prof_frame_end();
 
 	/* Clean-up finished sounds: normally this is done by
 		SDL_mixer but since we're using effects tricks to
@@ -603,6 +655,19 @@ void App::one_iter() {
 #endif
 }
 
+void App::dispatch_event(SDL_Event* ev) {
+	ImGui_ImplSDL2_ProcessEvent(ev);
+	switch (ev->type) {
+	case SDL_QUIT:
+		run = 0;
+		break;
+	default:
+
+		input(ev);
+		break;
+	}
+}
+
 /**
  * Release all objects we use
  */
@@ -625,6 +690,12 @@ App::~App() {
 
 	SDL_Quit();
 
+	prof_quit();
+#ifndef DINKEDIT
+	input_replay_stop();
+#endif
+
+	gfx_diskcache_quit();
 	paths_quit();
 
 	log_quit();
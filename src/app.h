@@ -37,6 +37,7 @@ public:
 	bool dinkini_playmidi;
 	bool dinkgl;
 	bool windowed;
+	bool headless; // no window, for benchmarks
 
 	App();
 	virtual ~App();
@@ -46,8 +47,9 @@ public:
 	virtual void logic() = 0;
 
 	int main(int argc, char* argv[]);
-	void loop();
+	virtual void loop();
 	void one_iter();
+	void dispatch_event(SDL_Event* ev);
 
 	void print_version();
 	void print_help(int argc, char* argv[]);
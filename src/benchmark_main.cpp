@@ -0,0 +1,118 @@
+/**
+ * Headless benchmark bootstrap
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AppBenchmark.h"
+#include "game_engine.h"
+#include "input_replay.h"
+#include "SDL.h"
+
+/**
+ * Take '--name <value>' or '--name=<value>' out of argv. Return the
+ * value, or NULL if the option isn't there.
+ */
+static char* take_option(int* argc, char* argv[], const char* name) {
+	size_t len = strlen(name);
+	for (int i = 1; i < *argc; i++) {
+		char* value = NULL;
+		int used = 0;
+		if (strcmp(argv[i], name) == 0 && i + 1 < *argc) {
+			value = argv[i + 1];
+			used = 2;
+		} else if (strncmp(argv[i], name, len) == 0 && argv[i][len] == '=') {
+			value = argv[i] + len + 1;
+			used = 1;
+		}
+		if (used > 0) {
+			memmove(&argv[i], &argv[i + used], (*argc - i - used + 1) * sizeof(char*));
+			*argc -= used;
+			return value;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Bootstrap. Benchmark options come on top of the game ones:
+ *   --benchmark <frames>  number of frames to run (1000)
+ *   --tick-step <ms>      game time per frame (1000/FPS)
+ *   --seed <n>            random seed (1)
+ *   --savegame <slot>     load this save game first
+ *   --replay <file>       play input recorded with --record, to its end
+ *   --output <file>       write the JSON report there instead of stdout
+ */
+int main(int argc, char* argv[]) {
+	/* No window nor sound card needed */
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+	SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+
+	AppBenchmark* benchmark = new AppBenchmark();
+	char* opt;
+	if ((opt = take_option(&argc, argv, "--benchmark")) != NULL)
+		benchmark->frames = atoi(opt);
+	if ((opt = take_option(&argc, argv, "--tick-step")) != NULL)
+		benchmark->tick_step = strtoull(opt, NULL, 10);
+	if ((opt = take_option(&argc, argv, "--seed")) != NULL)
+		benchmark->seed = strtoul(opt, NULL, 10);
+	if ((opt = take_option(&argc, argv, "--savegame")) != NULL)
+		benchmark->savegame = atoi(opt);
+	if ((opt = take_option(&argc, argv, "--output")) != NULL)
+		benchmark->output = opt;
+	if ((opt = take_option(&argc, argv, "--replay")) != NULL)
+		benchmark->replay = opt;
+	if (benchmark->frames <= 0 || benchmark->tick_step == 0) {
+		fprintf(stderr, "--benchmark and --tick-step must be positive\n");
+		delete benchmark;
+		return EXIT_FAILURE;
+	}
+	if (benchmark->replay != NULL && benchmark->savegame > 0) {
+		fprintf(stderr, "--replay starts from the title screen, drop --savegame\n");
+		delete benchmark;
+		return EXIT_FAILURE;
+	}
+
+	if (benchmark->replay != NULL) {
+		/* The log brings its own seed and timing */
+		if (!input_replay_play(benchmark->replay)) {
+			delete benchmark;
+			return EXIT_FAILURE;
+		}
+		benchmark->seed = input_replay_get_seed();
+	} else {
+		game_set_fixed_tick_step(benchmark->tick_step);
+		game_seed_random(benchmark->seed);
+	}
+
+	int ret = benchmark->main(argc, argv);
+	if (ret == EXIT_SUCCESS)
+		ret = benchmark->status;
+	delete benchmark;
+	return ret;
+}
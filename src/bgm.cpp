@@ -40,6 +40,13 @@
 #include <string.h>
 #include <strings.h> /* strcasecmp */
 #include <optional>
+#include <string>
+#include <vector>
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
 
 #include "bgm.h"
 #include "io_util.h"
@@ -64,14 +71,212 @@ const char *tag_artist = NULL;
 double mus_duration;
 Mix_MusicType mus_type;
 
+/**
+ * Tracks are opened by a loader thread, so that entering a screen
+ * with new music doesn't wait for Mix_LoadMUS() (parsing an OGG/MP3
+ * header, or rendering a MIDI through a soundfont). The previous
+ * track keeps playing until the new one is ready, then they
+ * crossfade. The last few tracks stay open for when the player walks
+ * back.
+ */
+
+#define MUSIC_CACHE_SIZE 4
+/* Length of the crossfade between two tracks, in ms */
+#define MUSIC_CROSSFADE 500
+
+struct music_cache_entry {
+	std::string path;
+	Mix_Music* music;
+	unsigned int last_used;
+};
+struct music_loaded {
+	std::string path;
+	Mix_Music* music; // NULL if it couldn't be opened
+	std::string error;
+	int request;
+};
+
+/* Main thread only */
+static std::vector<struct music_cache_entry> music_cache;
+static unsigned int music_cache_clock = 0;
+static int wanted_request = 0; // track to play once loaded, 0 if none
+static int wanted_fadein = 0;
+static int last_request = 0;
+static struct bgm_stats stats;
+
+/* Shared with the loader */
+static std::string queued_path;
+static int queued_request = 0;
+static std::vector<struct music_loaded> loaded;
+
+#ifndef __EMSCRIPTEN__
+static /*bool*/ int stopping = 0;
+static std::mutex mutex;
+static std::condition_variable cond;
+static std::thread worker;
+
+static void worker_main() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopping) {
+		if (queued_request == 0) {
+			cond.wait(lock);
+			continue;
+		}
+		std::string path = queued_path;
+		int request = queued_request;
+		queued_request = 0;
+		lock.unlock();
+		Mix_Music* music = Mix_LoadMUS(path.c_str());
+		std::string error = (music == NULL) ? Mix_GetError() : "";
+		lock.lock();
+		loaded.push_back({path, music, error, request});
+	}
+}
+#endif
+
+static Mix_Music* music_cache_get(const char* path) {
+	for (auto& entry : music_cache) {
+		if (entry.path == path) {
+			entry.last_used = ++music_cache_clock;
+			return entry.music;
+		}
+	}
+	return NULL;
+}
+
+/* Keep 'music', dropping the least recently used track that isn't
+playing */
+static void music_cache_add(const std::string& path, Mix_Music* music) {
+	if (music_cache.size() >= MUSIC_CACHE_SIZE) {
+		int oldest = -1;
+		for (size_t i = 0; i < music_cache.size(); i++) {
+			Mix_Music* m = music_cache[i].music;
+			if (m == music_data || m == music_data2)
+				continue;
+			if (oldest < 0 || music_cache[i].last_used < music_cache[oldest].last_used)
+				oldest = i;
+		}
+		if (oldest >= 0) {
+			Mix_FreeMusic(music_cache[oldest].music);
+			music_cache.erase(music_cache.begin() + oldest);
+		}
+	}
+	music_cache.push_back({path, music, ++music_cache_clock});
+}
+
+/* Switch to 'music', fading out what's playing */
+static void start_music(Mix_Music* music, int fadein) {
+	int loops = (loop_midi == true) ? -1 : 1;
+	#ifdef SDL_MIXER_X
+	/* A crossfade still running gets cut */
+	if (music_data2 != NULL && music_data2 != music)
+		Mix_HaltMusicStream(music_data2);
+	music_data2 = NULL;
+	if (music_data != NULL && music_data != music && Mix_PlayingMusicStream(music_data)) {
+		/* Both sides fade over the same time */
+		if (fadein < MUSIC_CROSSFADE)
+			fadein = MUSIC_CROSSFADE;
+		Mix_FadeOutMusicStream(music_data, fadein);
+		music_data2 = music_data;
+	} else if (music_data == music) {
+		Mix_HaltMusicStream(music);
+	}
+	music_data = music;
+
+	if (fadein > 0)
+		Mix_FadeInMusicStream(music_data, loops, fadein);
+		else
+		Mix_PlayMusicStream(music_data, loops);
+
+	/* Tracks from the cache keep the tempo they last played at */
+	Mix_SetMusicTempo(music_data, (high_speed == 1 && !dinklua_enabled) ? 3.0 : 1.0);
+	#else
+	/* Only one track at a time */
+	Mix_HaltMusic();
+	music_data = music;
+	Mix_PlayMusic(music_data, loops);
+	#endif
+
+	tag_album = Mix_GetMusicAlbumTag(music_data);
+	tag_artist = Mix_GetMusicArtistTag(music_data);
+	tag_title = Mix_GetMusicTitle(music_data);
+	mus_duration = Mix_MusicDuration(music_data);
+	mus_type = Mix_GetMusicType(music_data);
+}
+
+/* Have 'path' opened, and played by bgm_update() if it's still wanted */
+static void music_load_async(const char* path, int fadein) {
+	wanted_request = ++last_request;
+	wanted_fadein = fadein;
+	stats.loads++;
+	#ifndef __EMSCRIPTEN__
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!worker.joinable())
+			worker = std::thread(worker_main);
+		queued_path = path;
+		queued_request = wanted_request;
+		cond.notify_one();
+	}
+	#else
+	Mix_Music* music = Mix_LoadMUS(path);
+	loaded.push_back({path, music, (music == NULL) ? Mix_GetError() : "", wanted_request});
+	bgm_update();
+	#endif
+}
+
+/**
+ * Start the track that finished loading, if any: called once per
+ * frame
+ */
+void bgm_update() {
+	std::vector<struct music_loaded> done;
+	{
+		#ifndef __EMSCRIPTEN__
+		std::lock_guard<std::mutex> lock(mutex);
+		#endif
+		if (loaded.empty())
+			return;
+		done.swap(loaded);
+	}
+	for (auto& item : done) {
+		if (item.music == NULL) {
+			log_warn("🚫 Unable to play '%s': %s", item.path.c_str(), item.error.c_str());
+			if (item.request == wanted_request)
+				wanted_request = 0;
+			continue;
+		}
+		Mix_Music* cached = music_cache_get(item.path.c_str());
+		if (cached == NULL) {
+			music_cache_add(item.path, item.music);
+		} else {
+			/* Loaded twice meanwhile */
+			Mix_FreeMusic(item.music);
+			item.music = cached;
+		}
+		if (item.request == wanted_request) {
+			wanted_request = 0;
+			start_music(item.music, wanted_fadein);
+		}
+	}
+}
+
+void bgm_get_stats(struct bgm_stats* out) {
+	*out = stats;
+	out->tracks = music_cache.size();
+}
+
 /*
  * MIDI functions
  */
 
 /**
- * Returns whether the background music is currently playing
+ * Returns whether the background music is currently playing. A track
+ * still loading counts as playing.
  */
 bool something_playing() {
+	if (wanted_request != 0)
+		return true;
 	#ifdef SDL_MIXER_X
 	return (bool)Mix_PlayingMusicStream(music_data);
 	#else
@@ -79,14 +284,6 @@ bool something_playing() {
 	#endif
 }
 
-/**
- * Clean-up music when it's finished or manually halted
- */
-static void callback_HookMusicFinished() {
-	if (music_data != NULL)
-		Mix_FreeMusic(music_data);
-}
-
 /**
  * Thing to play the midi
  */
@@ -150,7 +347,7 @@ qsf/midi... Ok, midi is supposed to be just a number, but..*/
 		fullpath = paths_fallbackfile(relpath);
 		exists = exist(fullpath);
 	}
-	if (!exist(fullpath)) {
+	if (!exists) {
 		free(fullpath);
 		sprintf(relpath, "sound/%s", midi_filename);
 		fullpath = paths_fallbackfile(relpath);
@@ -159,7 +356,7 @@ qsf/midi... Ok, midi is supposed to be just a number, but..*/
 	free(oggv_filename);
 	free(mp3_filename);
 
-	if (!exist(fullpath)) {
+	if (!exists) {
 		free(fullpath);
 		log_warn("🚫 Error playing music %s, doesn't exist in any dir.",
 				midi_filename);
@@ -171,45 +368,16 @@ qsf/midi... Ok, midi is supposed to be just a number, but..*/
 		free(last_midi);
 	last_midi = strdup(midi_filename);
 
-	/* Stop whatever is playing before we play something else. */
-	#ifdef SDL_MIXER_X
-	Mix_HaltMusicStream(music_data);
-	#else
-	Mix_HaltMusic();
-	#endif
-
-	/* Load the file */
-	if ((music_data = Mix_LoadMUS(fullpath)) == NULL) {
-		log_warn("🚫 Unable to play '%s': %s", fullpath, Mix_GetError());
-		free(fullpath);
-		return 0;
+	/* Played recently: switch right away */
+	Mix_Music* music = music_cache_get(fullpath);
+	if (music != NULL) {
+		stats.hits++;
+		wanted_request = 0;
+		start_music(music, fadein);
+	} else {
+		music_load_async(fullpath, fadein);
 	}
 
-	/* Play it */
-	#ifdef SDL_MIXER_X
-	Mix_SetFreeOnStop(music_data, 1);
-	#else
-	Mix_HookMusicFinished(callback_HookMusicFinished);
-	#endif
-
-	#ifdef SDL_MIXER_X
-	if (fadein > 0)
-		Mix_FadeInMusicStream(music_data, (loop_midi == true) ? -1 : 1, fadein);
-		else
-		Mix_PlayMusicStream(music_data, (loop_midi == true) ? -1 : 1);
-
-	if (high_speed == 1 && !dinklua_enabled)
-		Mix_SetMusicTempo(music_data, 3.0);
-	#else
-	Mix_PlayMusic(music_data, (loop_midi == true) ? -1 : 1);
-	#endif
-
-	tag_album = Mix_GetMusicAlbumTag(music_data);
-	tag_artist = Mix_GetMusicArtistTag(music_data);
-	tag_title = Mix_GetMusicTitle(music_data);
-	mus_duration = Mix_MusicDuration(music_data);
-	mus_type = Mix_GetMusicType(music_data);
-
 	free(fullpath);
 	return 1;
 }
@@ -247,8 +415,11 @@ int ResumeMidi() {
  */
 // DinkC binding: stopmidi()
 int StopMidi() {
+	/* Don't start what's still loading */
+	wanted_request = 0;
 	#ifdef SDL_MIXER_X
 	Mix_HaltMusicStream(music_data);
+	Mix_HaltMusicStream(music_data2);
 	#else
 	Mix_HaltMusic(); // return always 0
 	#endif
@@ -270,6 +441,30 @@ void bgm_quit(void) {
 	Mix_HaltMusic();
 	#endif
 
+	#ifndef __EMSCRIPTEN__
+	if (worker.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = 1;
+			cond.notify_all();
+		}
+		worker.join();
+		stopping = 0;
+	}
+	#endif
+	queued_request = 0;
+	wanted_request = 0;
+	for (auto& item : loaded)
+		if (item.music != NULL)
+			Mix_FreeMusic(item.music);
+	loaded.clear();
+	for (auto& entry : music_cache)
+		Mix_FreeMusic(entry.music);
+	music_cache.clear();
+	music_data = NULL;
+	music_data2 = NULL;
+	tag_title = tag_album = tag_artist = NULL;
+
 	if (last_midi != NULL)
 		free(last_midi);
 	last_midi = NULL;
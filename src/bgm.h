@@ -34,6 +34,11 @@
 
 extern /*bool*/ int midi_active;
 
+struct bgm_stats {
+	unsigned int hits, loads;
+	unsigned int tracks;
+};
+
 extern bool something_playing(void);
 extern int PlayMidi(char* sFileName, int fadein);
 extern int PauseMidi();
@@ -42,6 +47,8 @@ extern int StopMidi();
 extern void check_midi();
 extern void bgm_init(void);
 extern void bgm_quit(void);
+extern void bgm_update(void);
+extern void bgm_get_stats(struct bgm_stats* stats);
 extern void loopmidi(int loop_midi);
 extern int play_modorder(int order);
 extern void set_music_tempo(double tempo);
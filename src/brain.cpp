@@ -133,7 +133,7 @@ int get_distance_and_dir_smart(int h, int h1, int* dir) {
 	int x1, y1;
 	for (y1 = 0; y1 < 400; y1++)
 		for (x1 = 0; x1 < 600; x1++) {
-			if (screen_hitmap[x1][y1] == 0) {
+			if (hitmap_get(x1, y1) == 0) {
 				//free
 				myhardmap.push_back(255);
 			}
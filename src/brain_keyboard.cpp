@@ -54,7 +54,7 @@ unsigned char get_hard_play(int x1, int y1) {
 	if ((x1 < 0) || (y1 < 0) || (x1 > 599) || (y1 > 399))
 		return 0;
 
-	int value = screen_hitmap[x1][y1];
+	int value = hitmap_get(x1, y1);
 	if (value > 100 && cur_ed_screen.sprite[value - 100].is_warp != 0) {
 		warp_editor_sprite = value;
 		value = 0;
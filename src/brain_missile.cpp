@@ -3,9 +3,11 @@
 #include <config.h>
 #endif
 #include <math.h>
+#include <stdlib.h>
 
 #include "brain.h"
 #include "live_sprites_manager.h"
+#include "live_sprites_grid.h"
 #include "freedink.h"
 #include "game_engine.h"
 #include "gfx.h"
@@ -29,6 +31,17 @@ void make_missile(int x1, int y1, int dir, int speed, int seq, int frame,
 	changedir(dir, crap, 430);
 }
 
+/* Sprites whose hardbox, inflated by the missile range, may contain
+   the missile */
+static int missile_candidates(int h, int after, int* out) {
+	if (debug_mode && (debug_missilesquares || debug_pausemissile))
+		return sprites_grid_all(after, out);
+	long range = labs(spr[h].range);
+	if (range > 100000)
+		range = 100000;
+	return sprites_grid_query(spr[h].x, spr[h].y, range, after, out);
+}
+
 void missile_brain(int h, /*bool*/ int repeat) {
 	rect box;
 	int j;
@@ -114,7 +127,23 @@ void missile_brain(int h, /*bool*/ int repeat) {
 
 	//did we hit anything that can die?
 
-	for (j = 1; j <= last_sprite_created; j++) {
+	int candidates[MAX_SPRITES_AT_ONCE];
+	int nb_candidates = 0, c = 0;
+	unsigned int generation = sprites_grid_generation() - 1;
+	j = 0;
+	for (;;) {
+		/* scripts run on hit may move or create sprites, fetch again */
+		if (generation != sprites_grid_generation()) {
+			generation = sprites_grid_generation();
+			nb_candidates = missile_candidates(h, j, candidates);
+			c = 0;
+		}
+		if (c >= nb_candidates)
+			break;
+		j = candidates[c++];
+		if (j > last_sprite_created)
+			break;
+
 		if (spr[j].active && h != j && spr[j].nohit != 1 &&
 			spr[j].notouch == /*false*/ 0)
 			if (spr[h].brain_parm != j && spr[h].brain_parm2 != j)
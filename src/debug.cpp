@@ -7,6 +7,7 @@
 #include "debug.h"
 #include "gfx.h"
 #include "gfx_sprites.h"
+#include "input_replay.h"
 #include "live_sprite.h"
 #include "live_sprites_manager.h"
 #include "log.h"
@@ -88,6 +89,13 @@ void pause_everything() {
 }
 
 bool game_paused() {
+#ifndef DINKEDIT
+    /* Window focus isn't part of a recording: ignore it, or the replay
+       would drift from the recorded frames */
+    enum input_replay_mode replay = input_replay_get_mode();
+    if (replay == INPUT_REPLAY_RECORD || replay == INPUT_REPLAY_PLAY)
+        return debug_paused;
+#endif
     return debug_paused || (dbg.focuspause && !(SDL_GetWindowFlags(g_display->window) & SDL_WINDOW_INPUT_FOCUS));
 }
 
@@ -78,6 +78,12 @@
 #include "live_screen.h"
 #include "inventory.h"
 #include "ImageLoader.h"
+#include "IOGfxSurfaceSW.h"
+#include "gfx_diskcache.h"
+#include "profiler.h"
+#include "screen_prefetch.h"
+#include "fastfile.h"
+#include "io_util.h"
 #include "status.h"
 #include "sfx.h"
 #include "bgm.h"
@@ -117,7 +123,10 @@ bool smurmeladeribuloso, debug_hardenedmode = false;
 const std::map<std::string, int> textcolmap { {"#", 13}, {"@", 12}, {"!", 14}, {"%", 15}, {"$", 14}, {"0", 10}, {"1", 1}, {"2", 2}, {"3", 3}, {"4", 4}, {"5", 5}, {"6", 6}, {"7", 7}, {"8", 8}, {"9", 9} };
 //For the log window
 Uint32 debug_engine_cycles = 0;
-ImGuiTextBuffer Buf, errBuf, dbgBuf, infBuf, traceBuf;
+//Lines kept per log tab, older ones are dropped
+#define LOG_RING_LINES 4096
+LogRing Buf(LOG_RING_LINES), errBuf(LOG_RING_LINES), dbgBuf(LOG_RING_LINES),
+	infBuf(LOG_RING_LINES), traceBuf(LOG_RING_LINES);
 ImGuiTextFilter Filter;
 ImVector <int> LineOffsets;
 bool debug_autoscroll[5];
@@ -384,6 +393,15 @@ static void live_sprites_bar() {
 	ImGui::ProgressBar(progress, ImVec2(0.0f, 0.0f), buf);
 }
 
+static void sprite_slots_bar() {
+	struct gfx_sprites_slot_stats st;
+	gfx_sprites_get_slot_stats(&st);
+	float progress = (float)st.used / (float)st.capacity;
+	char buf[64];
+	sprintf(buf, "%d/%d sprite slots", st.used, st.capacity);
+	ImGui::ProgressBar(progress, ImVec2(0.0f, 0.0f), buf);
+}
+
 static void var_used_bar() {
 	int m = 0;
 	int i;
@@ -807,7 +825,7 @@ if (dbg.corner != -1)
     ImGui::End();
 }
 
-void logwindowtab(int level, ImGuiTextBuffer myBuf) {
+void logwindowtab(int level, LogRing& myBuf) {
 	char myname[32];
 	sprintf(myname, "scrolling%d", level);
 	if (ImGui::Button("Clear")) {
@@ -820,13 +838,24 @@ void logwindowtab(int level, ImGuiTextBuffer myBuf) {
 	ImGui::SameLine();
 	if (ImGui::Button("Copy all to clipboard")) {
 		ImGui::LogToClipboard();
-		ImGui::LogText(myBuf.c_str());
+		ImGui::LogText("%s", myBuf.text().c_str());
 		ImGui::LogFinish();
 	}
+	std::lock_guard<std::mutex> guard(myBuf.lock());
+	if (myBuf.dropped() > 0) {
+		ImGui::SameLine();
+		ImGui::TextDisabled("%llu older lines dropped", (unsigned long long)myBuf.dropped());
+	}
 	ImGui::BeginChild(myname);
-	const char *buf = myBuf.begin();
-	const char *buf_end = myBuf.end();
-	ImGui::TextUnformatted(buf, buf_end);
+	//Only lay out the lines that are visible
+	ImGuiListClipper clipper;
+	clipper.Begin(myBuf.size());
+	while (clipper.Step())
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+			const std::string& line = myBuf.line(i);
+			ImGui::TextUnformatted(line.data(), line.data() + line.size());
+		}
+	clipper.End();
 	if (dbg.logautoscroll && debug_autoscroll[level]) {
 		ImGui::SetScrollHereY(1.0f);
 		debug_autoscroll[level] = false;
@@ -2113,12 +2142,13 @@ if (sprinfo) {
 		}
 
 		if (ImGui::TreeNode("Custom data")) {
-			if (spr[spriedit].custom != NULL) {
-				if (spr[spriedit].custom->empty())
-					ImGui::Text("Sprite has no custom data");
-				for (const auto &i: *spr[spriedit].custom) {
-					ImGui::BulletText("%s is %d", i.first.c_str(), i.second);
-				}
+			struct sp_custom* custom = &spr[spriedit].custom;
+			if (custom->count == 0)
+				ImGui::Text("Sprite has no custom data");
+			for (int i = 0; i < custom->cap; i++) {
+				if (custom->slots[i].key != 0)
+					ImGui::BulletText("%s is %d", sp_custom_key_name(custom->slots[i].key),
+						custom->slots[i].value);
 			}
 			ImGui::TreePop();
 		}
@@ -2503,38 +2533,38 @@ if (spreditors) {
 		}
 		ImGui::Separator();
 		if (ImGui::TreeNode("Custom data")) {
-			if (spr[spriedit].custom != NULL) {
+			struct sp_custom* custom = &spr[spriedit].custom;
 			ImGui::InputText("Key", customkey, 200);
 			ImGui::InputInt("Value", &customval);
 			ImGui::SameLine();
 			if (ImGui::Button("Add")) {
-				auto success = spr[spriedit].custom->insert(std::make_pair(customkey, customval));
-				if (!success.second)
-					success.first->second = customval;
+				*sp_custom_get(custom, sp_custom_intern(customkey)) = customval;
 				customkey[200] = {0};
 				customval = 0;
 			}
 			ImGui::Spacing();
-			if (!spr[spriedit].custom->empty()) {
+			if (custom->count > 0) {
 			ImGui::BeginTable("tablecustom", 2, ImGuiTableFlags_Borders);
 			ImGui::TableSetupColumn("Key");
             ImGui::TableSetupColumn("Value");
             ImGui::TableHeadersRow();
-			for (const auto &x: *spr[spriedit].custom) {
+			for (int i = 0; i < custom->cap; i++) {
+				if (custom->slots[i].key == 0)
+					continue;
+				const char* name = sp_custom_key_name(custom->slots[i].key);
 				ImGui::TableNextColumn();
-				//ImGui::Text("%s", x.first.c_str());
-				if (ImGui::Button(x.first.c_str())) {
-					customval = x.second;
-					sprintf(customkey, "%s", x.first.c_str());
+				//ImGui::Text("%s", name);
+				if (ImGui::Button(name)) {
+					customval = custom->slots[i].value;
+					sprintf(customkey, "%s", name);
 				}
 				ImGui::TableNextColumn();
-				ImGui::Text("%d", x.second);
+				ImGui::Text("%d", custom->slots[i].value);
 			}
 
 			ImGui::EndTable();
 			if (ImGui::Button("Clear all entries"))
-				spr[spriedit].custom->clear();
-			}
+				sp_custom_clear(custom);
 			}
 			ImGui::TreePop();
 		}
@@ -3417,11 +3447,158 @@ if (metrics) {
 			tooltippy("Scripts");
 			live_sprites_bar();
 			tooltippy("Living sprites");
+			sprite_slots_bar();
+			tooltippy("Loaded frames (GFX_k)");
+			struct gfx_sprites_slot_stats st;
+			gfx_sprites_get_slot_stats(&st);
+			ImGui::BulletText("Highest slot: %d, next free: %d, holes: %d",
+				st.highest_used, st.lowest_free, st.highest_used - st.used);
 			sfx_used_bar();
 			tooltippy("SFX");
 
 			ImGui::EndTabItem();
 		}
+		if (ImGui::BeginTabItem("Caches"))
+		{
+			struct gfx_stretch_cache_stats st;
+			gfx_stretch_cache_get_stats(&st);
+			ImGui::SeparatorText("Resized sprites");
+			ImGui::BulletText("Hits: %u, misses: %u, evictions: %u", st.hits, st.misses, st.evictions);
+			unsigned int lookups = st.hits + st.misses;
+			if (lookups > 0)
+				ImGui::BulletText("Hit rate: %.1f%%", 100.0 * st.hits / lookups);
+			float used = (st.budget > 0) ? (float)st.bytes / (float)st.budget : 0.0f;
+			char buf[64];
+			sprintf(buf, "%u entries, %ukB/%ukB", st.entries, st.bytes / 1024, st.budget / 1024);
+			ImGui::ProgressBar(used, ImVec2(0.0f, 0.0f), buf);
+			int budget_kb = st.budget / 1024;
+			if (ImGui::SliderInt("Budget (kB)", &budget_kb, 0, 65536))
+				gfx_stretch_cache_set_budget(budget_kb * 1024);
+			tooltippy("Set stretch_cache_kb in yedink.ini to keep this");
+			if (ImGui::SmallButton("Flush"))
+				gfx_stretch_cache_clear();
+
+			ImGui::SeparatorText("Decoded images on disk");
+			const char* cache_dir = gfx_diskcache_get_dir();
+			if (cache_dir == NULL) {
+				ImGui::TextDisabled("Disabled");
+				tooltippy("Set asset_cache in yedink.ini to enable");
+			} else {
+				struct gfx_diskcache_stats dst;
+				gfx_diskcache_get_stats(&dst);
+				ImGui::BulletText("Directory: %s", cache_dir);
+				ImGui::BulletText("Hits: %u, misses: %u, stored: %u, failed: %u",
+					dst.hits, dst.misses, dst.stores, dst.failures);
+				lookups = dst.hits + dst.misses;
+				if (lookups > 0)
+					ImGui::BulletText("Hit rate: %.1f%%", 100.0 * dst.hits / lookups);
+			}
+
+			ImGui::SeparatorText("Sprite archives");
+			struct fastfile_stats fst;
+			FastFileGetStats(&fst);
+			ImGui::BulletText("dir.ff mapped: %u (%llukB)", fst.archives, fst.bytes / 1024);
+			ImGui::BulletText("Opened: %u, read from disk: %u", fst.opens, fst.parses);
+			tooltippy("Each archive is indexed once and kept mapped until sprites are unloaded");
+
+			ImGui::SeparatorText("Case-insensitive paths");
+			struct ciconvert_stats cst;
+			ciconvert_get_stats(&cst);
+			ImGui::BulletText("Lookups: %llu, directories cached: %llu, read: %llu",
+				(unsigned long long)cst.calls, (unsigned long long)cst.dirs,
+				(unsigned long long)cst.scans);
+			ImGui::BulletText("Syscalls: %llu, saved: %lld", (unsigned long long)cst.syscalls,
+				(long long)cst.syscalls_uncached - (long long)cst.syscalls);
+			tooltippy("Compared to probing the filesystem on every lookup");
+			if (ImGui::SmallButton("Forget listings"))
+				ciconvert_cache_invalidate(NULL);
+
+			ImGui::SeparatorText("Glyph atlas");
+			struct gfx_fonts_glyph_stats gst;
+			gfx_fonts_get_glyph_stats(&gst);
+			ImGui::BulletText("Glyphs: %u, texts composed: %u", gst.glyphs, gst.texts);
+			ImGui::BulletText("Hits: %u, misses: %u", gst.hits, gst.misses);
+
+			ImGui::SeparatorText("Neighbouring screens");
+			struct screen_prefetch_stats pst;
+			screen_prefetch_get_stats(&pst);
+			ImGui::BulletText("Screens read ahead: %u, sequences decoded ahead: %u",
+				pst.screens_read, pst.seqs_queued);
+			ImGui::BulletText("Screen changes from memory: %u, from map.dat: %u", pst.hits, pst.misses);
+
+			ImGui::SeparatorText("Music");
+			struct bgm_stats bst;
+			bgm_get_stats(&bst);
+			ImGui::BulletText("Tracks open: %u", bst.tracks);
+			ImGui::BulletText("Switches to an open track: %u, loaded in the background: %u",
+				bst.hits, bst.loads);
+
+			ImGui::EndTabItem();
+		}
+		if (ImGui::BeginTabItem("Profiler"))
+		{
+			bool profiling = prof_enabled;
+			if (ImGui::Checkbox("Profile frames", &profiling))
+				prof_enable(profiling);
+			tooltippy("Or start with --profile <trace.json>");
+
+			static struct prof_frame pframes[PROF_MAX_FRAMES];
+			static float pxs[PROF_MAX_FRAMES], pstack[PROF_NB_ZONES + 1][PROF_MAX_FRAMES];
+			int n = prof_get_frames(pframes, PROF_MAX_FRAMES);
+			double mean[PROF_NB_ZONES] = {};
+			for (int i = 0; i < n; i++) {
+				pxs[i] = i;
+				pstack[0][i] = 0;
+				for (int z = 0; z < PROF_NB_ZONES; z++) {
+					pstack[z + 1][i] = pstack[z][i] + pframes[i].zone_ms[z];
+					mean[z] += pframes[i].zone_ms[z] / n;
+				}
+			}
+			//Stacked by phase, frame limiter on top so it can be hidden
+			if (ImPlot::BeginPlot("##Frame phases", ImVec2(500, 250))) {
+				ImPlot::SetupAxes("Frame", "ms", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+				ImPlot::SetupLegend(ImPlotLocation_East, ImPlotLegendFlags_Outside);
+				for (int z = 0; z < PROF_NB_ZONES; z++)
+					ImPlot::PlotShaded(prof_zone_name(z), pxs, pstack[z], pstack[z + 1], n);
+				ImPlot::EndPlot();
+			}
+			if (n > 0) {
+				ImGui::SeparatorText("Mean over the last frames");
+				for (int z = 0; z < PROF_NB_ZONES; z++)
+					if (mean[z] >= 0.001)
+						ImGui::BulletText("%s: %.3fms", prof_zone_name(z), mean[z]);
+			}
+
+			ImGui::SeparatorText("Scripts");
+			static struct prof_script_stats pscripts[20];
+			int nscripts = prof_get_scripts(pscripts, 20);
+			if (nscripts > 0 && ImGui::BeginTable("profscripts", 3, ImGuiTableFlags_Borders)) {
+				ImGui::TableSetupColumn("Name");
+				ImGui::TableSetupColumn("Runs");
+				ImGui::TableSetupColumn("Total ms");
+				ImGui::TableHeadersRow();
+				for (int i = 0; i < nscripts; i++) {
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(pscripts[i].name);
+					ImGui::TableNextColumn();
+					ImGui::Text("%llu", (unsigned long long)pscripts[i].calls);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.3f", pscripts[i].ms);
+				}
+				ImGui::EndTable();
+			}
+			if (ImGui::SmallButton("Reset scripts"))
+				prof_reset_scripts();
+
+			ImGui::SeparatorText("Chrome trace");
+			static char tracefile[256] = "trace.json";
+			ImGui::InputText("File", tracefile, sizeof(tracefile));
+			if (ImGui::SmallButton("Save trace"))
+				prof_write_trace(tracefile);
+			tooltippy("Open in chrome://tracing or ui.perfetto.dev");
+
+			ImGui::EndTabItem();
+		}
 
 		ImGui::EndTabBar();
 	}
@@ -3590,14 +3767,14 @@ if (htiles)
                 int x = 0;
                 for (x = 0; x < 50; x++)
                 {
-                    if (hmap.htile[htile].hm[x][y] == 1)
+                    if (hmap.htile[htile].rows[y][x] == 1)
                         col = standard;
-                    else if (hmap.htile[htile].hm[x][y] == 2)
+                    else if (hmap.htile[htile].rows[y][x] == 2)
                         col = low;
-                    else if (hmap.htile[htile].hm[x][y] == 3)
+                    else if (hmap.htile[htile].rows[y][x] == 3)
                         col = fire;
-                    if (hmap.htile[htile].hm[x][y] > 0)
-                        ImGui::TextColored(col, "%d", hmap.htile[htile].hm[x][y]);
+                    if (hmap.htile[htile].rows[y][x] > 0)
+                        ImGui::TextColored(col, "%d", hmap.htile[htile].rows[y][x]);
                     else
                         ImGui::Text("0");
                     ImGui::TableNextColumn();
@@ -3607,7 +3784,7 @@ if (htiles)
             ImGui::EndTable();
 
 			if (ImGui::Button("Remove tile data")) {
-				memset(hmap.htile[htile].hm, 0, sizeof(hmap.htile[htile].hm));
+				memset(hmap.htile[htile].rows, 0, sizeof(hmap.htile[htile].rows));
 				save_hard();
 			}
 			tooltippy("Blanks the tile, making it walkable");
@@ -4636,7 +4813,7 @@ if (ImGui::Button("Pathfind")) {
 	int x1, y1;
 	for (y1 = 0; y1 < 400; y1++)
 		for (x1 = 0; x1 < 600; x1++) {
-			if (screen_hitmap[x1][y1] == 0) {
+			if (hitmap_get(x1, y1) == 0) {
 				//free
 				myhardmap.push_back(255);
 			}
@@ -4790,7 +4967,7 @@ if (drawhard && !show_inventory) {
     int x1, y1;
 	for (x1 = 0; x1 < 600; x1++)
 		for (y1 = 0; y1 < 400; y1++) {
-			if (screen_hitmap[x1][y1] == 1) {
+			if (hitmap_get(x1, y1) == 1) {
 				{
 					SDL_Rect GFX_box_crap;
 					GFX_box_crap.x = x1 + playl;
@@ -4803,7 +4980,7 @@ if (drawhard && !show_inventory) {
 				}
 			}
 
-			if (screen_hitmap[x1][y1] == 2) {
+			if (hitmap_get(x1, y1) == 2) {
 				{
 					SDL_Rect GFX_box_crap;
 					GFX_box_crap.x = x1 + playl;
@@ -4816,7 +4993,7 @@ if (drawhard && !show_inventory) {
 				}
 			}
 
-			if (screen_hitmap[x1][y1] == 3) {
+			if (hitmap_get(x1, y1) == 3) {
 				{
 					SDL_Rect GFX_box_crap;
 					GFX_box_crap.x = x1 + playl;
@@ -4829,9 +5006,9 @@ if (drawhard && !show_inventory) {
 				}
 			}
 
-			if (screen_hitmap[x1][y1] > 100) {
+			if (hitmap_get(x1, y1) > 100) {
 
-				if (cur_ed_screen.sprite[(screen_hitmap[x1][y1]) - 100]
+				if (cur_ed_screen.sprite[(hitmap_get(x1, y1)) - 100]
 							.is_warp == 1) {
 					{
 						SDL_Rect GFX_box_crap;
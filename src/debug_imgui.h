@@ -1,6 +1,7 @@
 #pragma once
 
 #include "imgui.h"
+#include "log.h"
 //Called from IOGfxDisplaySW/GL2
 extern void dbg_imgui();
 //Ran at start to update jukebox list
@@ -13,7 +14,7 @@ extern void infowindow();
 extern void alttext();
 extern void dinktheme();
 //For the debug log
-extern ImGuiTextBuffer Buf, errBuf, dbgBuf, infBuf, traceBuf;
+extern LogRing Buf, errBuf, dbgBuf, infBuf, traceBuf;
 extern Uint32 debug_engine_cycles;
 extern bool debug_autoscroll[5];
 //For the tile toggle and info window
@@ -76,6 +76,8 @@ char returnstring[200];
 in a choice menu; also abuse to tell which key is selected in
 joystick remapping */
 unsigned short decipher_savegame = 0;
+/* Statements run so far, for benchmarks */
+Uint64 dinkc_instructions = 0;
 
 /* Number of reserved ASCII indexes in .d BPE compression format */
 #define NB_PAIRS_MAX 128
@@ -90,6 +92,52 @@ int magic_script = 0;
 static enum dinkc_parser_state process_line(int script, char* s,
 											/*bool*/ int doelse);
 
+/* Script lines pre-parsed at load time (cf. dinkc_compile_script), so
+   dinkc_run_script doesn't have to copy and re-split the text of the
+   most common lines each time they run. */
+enum dinkc_op_type {
+	DCOP_TEXT, /* not lowered, use read_next_line/process_line */
+	DCOP_BLANK, /* only spaces */
+	DCOP_COMMENT, /* starts with '//' */
+	DCOP_CALL, /* call to a DinkC binding */
+};
+struct dinkc_op {
+	long start; /* offset of the line in rinfo_code */
+	long next; /* offset of the next line */
+	char eol; /* '\n' or '\r' */
+	/* counters when the line is reached reading from offset 0 */
+	int line; /* line number */
+	int col; /* column after reading the line */
+	/*bool*/ char col_reset; /* whether a '\n' reset the column */
+	enum dinkc_op_type type;
+	/* DCOP_CALL */
+	struct binding* pbd;
+	int signature; /* cf. binding_signature */
+	int ints[10]; /* 'int' arguments */
+	char* strs[10]; /* 'string' arguments, and '&variable' int arguments */
+};
+struct dinkc_program {
+	int nb_ops;
+	struct dinkc_op* ops; /* ordered by offset */
+	int hint; /* likely next op, to skip the lookup */
+	/* first "void proc(" and "label:" lines, by lowercase name */
+	std::unordered_map<std::string, int> procs;
+	std::unordered_map<std::string, int> labels;
+};
+static struct dinkc_program* rinfo_program[MAX_SCRIPTS];
+
+static std::string lowercase(const char* str) {
+	std::string ret(str);
+	for (auto& c : ret)
+		c = tolower((unsigned char)c);
+	return ret;
+}
+
+static void dinkc_compile_script(int script);
+static void dinkc_free_program(int script);
+static struct dinkc_op* read_next_op(int script);
+static enum dinkc_parser_state run_op(int script, struct dinkc_op* op);
+
 /**
  * Decompress a .d DinkC script; also clean newlines. Check
  * contrib/d2c.c for more explanation about the decompression process.
@@ -267,6 +315,9 @@ static int script_init(const char* name, char* code, int sprite) {
 int ts_script_init(const char* name, char* code) {
 	return script_init(name, code, 1);
 }
+void ts_script_compile(int script) {
+	dinkc_compile_script(script);
+}
 
 /**
  * Start a simple script, usually from the script console
@@ -412,6 +463,7 @@ int dinkc_load_script(char* script_name, int sprite) {
 	}
 	//defined in scripting.cpp
 	//sinfo[script]->sprite = sprite;
+	dinkc_compile_script(script);
 
 	log_exit("load_script: %d", script);
 	return script;
@@ -439,6 +491,33 @@ void strip_beginning_spaces(char* str) {
 	*(pc - diff) = '\0';
 }
 
+/**
+ * Clean up vars so the located procedure is ready to run
+ */
+static void locate_reset(int script) {
+	if (sinfo[script]->sprite != 1000) {
+		// TODO: move out so we don't depend on 'spr'
+		// reset move/move_stop moves
+		spr[sinfo[script]->sprite].move_active = 0;
+		if (dversion >= 108)
+			// also reinit move_nohard as in brain.cpp:done_move
+			spr[sinfo[script]->sprite].move_nohard = 0;
+	}
+	rinfo(script)->skipnext = /*false*/ 0;
+	rinfo(script)->onlevel = 0;
+	rinfo(script)->level = 0;
+}
+
+/**
+ * Move to the end of a compiled line, with the counters that reading
+ * the script from offset 0 up to this line would give.
+ */
+static void locate_op(int script, struct dinkc_op* op) {
+	rinfo(script)->current = op->next;
+	rinfo(script)->cur_line = op->line + (op->eol == '\n' ? 1 : 0);
+	rinfo(script)->debug_line = op->line;
+}
+
 /**
  * Locate a procedure (such as "void hit()")
  */
@@ -449,6 +528,22 @@ void strip_beginning_spaces(char* str) {
 		return 0;
 	}
 
+	/* Compiled scripts already know where their procedures are */
+	struct dinkc_program* program = rinfo_program[script];
+	if (program != NULL) {
+		auto found = program->procs.find(lowercase(lookup_proc));
+		if (found == program->procs.end()) {
+			log_exit("locate: %d", 0);
+			return 0;
+		}
+		struct dinkc_op* op = &program->ops[found->second];
+		locate_op(script, op);
+		rinfo(script)->cur_col = op->col;
+		locate_reset(script);
+		log_exit("locate: %d", 1);
+		return 1;
+	}
+
 	int save_current = rinfo(script)->current;
 	int save_cur_line = rinfo(script)->cur_line;
 	int save_cur_col = rinfo(script)->cur_col;
@@ -481,18 +576,7 @@ void strip_beginning_spaces(char* str) {
 			free(cur_proc);
 
 			if (is_right_proc) {
-				//clean up vars so it is ready to run
-				if (sinfo[script]->sprite != 1000) {
-					// TODO: move out so we don't depend on 'spr'
-					// reset move/move_stop moves
-					spr[sinfo[script]->sprite].move_active = 0;
-					if (dversion >= 108)
-						// also reinit move_nohard as in brain.cpp:done_move
-						spr[sinfo[script]->sprite].move_nohard = 0;
-				}
-				rinfo(script)->skipnext = /*false*/ 0;
-				rinfo(script)->onlevel = 0;
-				rinfo(script)->level = 0;
+				locate_reset(script);
 
 				free(line);
 				log_exit("locate: %d", 1);
@@ -523,6 +607,32 @@ void strip_beginning_spaces(char* str) {
 	char* label = (char*)calloc(1, strlen(expr) + 1 + 1);
 	sprintf(label, "%s:", expr);
 
+	/* Compiled scripts already know where their labels are; a missing
+	   label still goes through the scan below, which leaves the
+	   script at its end */
+	struct dinkc_program* program = rinfo_program[script];
+	if (program != NULL) {
+		auto found = program->labels.find(lowercase(label));
+		if (found != program->labels.end()) {
+			struct dinkc_op* op = &program->ops[found->second];
+			log_debug("↩️ Found goto : Line is %d, word is %s.", op->line, label);
+			locate_op(script, op);
+			/* the scan doesn't reset the column */
+			if (op->col_reset)
+				rinfo(script)->cur_col = op->col;
+			else
+				rinfo(script)->cur_col += op->col;
+
+			rinfo(script)->skipnext = /*false*/ 0;
+			rinfo(script)->onlevel = 0;
+			rinfo(script)->level = 0;
+
+			free(label);
+			log_exit("locate_goto: %d", 1);
+			return 1;
+		}
+	}
+
 	char* line = NULL;
 	rinfo(script)->current = 0;
 	rinfo(script)->cur_line = 1;
@@ -563,79 +673,17 @@ void strip_beginning_spaces(char* str) {
  */
 int lookup_var(char* variable, int scope) {
 	log_enter("lookup_var: variable: %s, scope: %d", variable, scope);
-	int i;
-	for (i = 1; i < MAX_VARS; i++)
-		if (play.var[i].active && compare(play.var[i].name, variable) &&
-				scope == play.var[i].scope) {
-			log_exit("lookup_var: %d", i);
-			return i;
-		}
-	log_exit("lookup_var: %d", 0);
-	return 0;
+	int i = var_exists(variable, scope);
+	log_exit("lookup_var: %d", i);
+	return i;
 }
 
 /**
- * v1.07-style scope. This function is buggy: the first memory slot
- * has precedence (independently of local/global scope).
- *
- * Return -1 if not found, slot index >1 if found. Slot 0 isn't
- * currently used by the engine.
- */
-static int lookup_var_local_global_107(char* variable, int var_scope) {
-	log_enter("lookup_var_local_global_107: variable: %s, var_scope: %d", variable, var_scope);
-	int i;
-	for (i = 1; i < MAX_VARS; i++)
-		if (play.var[i].active == 1 &&
-				((play.var[i].scope == DINKC_GLOBAL_SCOPE) ||
-				(play.var[i].scope == var_scope)) &&
-				(compare(play.var[i].name, variable))) {
-			log_exit("lookup_var_local_global_107: %d", i);
-			return i;
-		}
-	log_exit("lookup_var_local_global_107: %d", -1);
-	return -1; /* not found */
-}
-
-/**
- * v1.08-style scope: local variables are searched before global
- * variables.
- *
- * Return -1 if not found, slot index >1 if found. Slot 0 isn't
- * currently used by the engine.
- */
-static int lookup_var_local_global_108(char* variable, int var_scope) {
-	log_enter("lookup_var_local_global_108: variable: %s, var_scope: %d", variable, var_scope);
-	int search_scope[2];
-	search_scope[0] = var_scope; /* first local scope */
-	search_scope[1] = DINKC_GLOBAL_SCOPE; /* then global scope */
-
-	int i;
-	for (i = 0; i < 2; i++) {
-		//We'll start going through every var, starting at one
-		int v;
-		for (v = 1; v < MAX_VARS; v++) {
-			//Okay... make sure the var is active,
-			//The scope should match the script,
-			//Then make sure the name is the same.
-			if (play.var[v].active && play.var[v].scope == search_scope[i] &&
-					compare(play.var[v].name, variable)) {
-				log_exit("lookup_var_local_global_108: %d", v);
-				return v;
-			}
-		}
-	}
-	log_exit("lookup_var_local_global_108: %d", -1);
-	return -1;
-}
-
-/**
- * Lookup variable with local->global nested scope
+ * Lookup variable with local->global nested scope (cf.
+ * search_var_with_this_scope_107/108 for the v1.07 quirks)
  */
 static int lookup_var_local_global(char* variable, int scope) {
-	if (dversion >= 108)
-		return lookup_var_local_global_108(variable, scope);
-	else
-		return lookup_var_local_global_107(variable, scope);
+	return search_var_with_this_scope(variable, scope);
 }
 
 /* Test suite proxy */
@@ -900,6 +948,7 @@ void dinkc_kill_script(int k) {
 		if (rinfo_code[k] != NULL)
 			free(rinfo_code[k]);
 		rinfo_code[k] = NULL;
+		dinkc_free_program(k);
 
 	log_exit("kill_script: void");
 }
@@ -958,6 +1007,7 @@ void kill_all_scripts_for_real(void) {
 void kill_all_vars() {
 	log_enter("kill_all_vars");
 	memset(&play.var, 0, sizeof(play.var));
+	var_index_rebuild();
 	log_exit("kill_all_vars: void");
 }
 
@@ -1139,7 +1189,29 @@ void dinkc_run_script(int script) {
 	}
 
 	int doelse_once = 0;
-	while ((line = read_next_line(script)) != NULL) {
+	for (;;) {
+		/* Lines lowered by dinkc_compile_script */
+		struct dinkc_op* op = read_next_op(script);
+		if (op != NULL && op->type != DCOP_TEXT) {
+			if (op->type == DCOP_BLANK)
+				continue;
+
+			doelse_once = 0;
+			dinkc_instructions++;
+			int result = run_op(script, op);
+			if (result == DCPS_DOELSE_ONCE)
+				doelse_once = 1;
+			if (result == DCPS_YIELD) {
+				if (dbg.debug_scripboot)
+					log_debug("👢 giving script the boot");
+				log_exit("run_script: void");
+				return;
+			}
+			continue;
+		}
+
+		if ((line = read_next_line(script)) == NULL)
+			break;
 		while (1) {
 			strip_beginning_spaces(line);
 			if (strcmp(line, "\n") == 0)
@@ -1150,6 +1222,7 @@ void dinkc_run_script(int script) {
 				doelse = 1;
 				doelse_once = 0;
 			}
+			dinkc_instructions++;
 			int result = process_line(script, line, doelse);
 
 			if (result == DCPS_DOELSE_ONCE) {
@@ -1400,6 +1473,33 @@ next2:
 	log_exit("var_equals: void");
 }
 
+/**
+ * Locate the first 3 words of 'line' in place, with the same rules as
+ * get_word(line, 1..3).
+ */
+static void locate_words(char* line, char* start[3], int len[3]) {
+	int cur_word = 1;
+	char* pc = line;
+	int word = 1;
+	for (; word <= 3; word++) {
+		while (*pc != '\0' && cur_word != word) {
+			if (*pc == ' ') {
+				cur_word++;
+				while (*pc == ' ')
+					pc++;
+			} else {
+				while (*pc != ' ' && *pc != '\0')
+					pc++;
+			}
+		}
+		char* end = pc;
+		while (*end != '\0' && *end != ' ')
+			end++;
+		start[word - 1] = pc;
+		len[word - 1] = end - pc;
+	}
+}
+
 /**
  * Evaluate a value (variable, int, or maths), in the context of
  * 'script'.
@@ -1411,12 +1511,10 @@ int var_figure(char* h, int script) {
 	int ret = 0;
 	int n1 = 0, n2 = 0;
 
-	int is_one_word_equation = 0;
-	word = get_word(h, 2);
-	if (compare(word, ""))
-		is_one_word_equation = 1;
-	free(word);
-	if (is_one_word_equation) {
+	char* words[3];
+	int lens[3];
+	locate_words(h, words, lens);
+	if (lens[1] == 0) {
 		// variable -> integer
 		if (h[0] == '&')
 			decipher_string(&h, script);
@@ -1427,18 +1525,28 @@ int var_figure(char* h, int script) {
 		return ret;
 	}
 
-	word = get_word(h, 1);
+	word = (char*)xmalloc(lens[0] + 1);
+	memcpy(word, words[0], lens[0]);
+	word[lens[0]] = '\0';
 	decipher_string(&word, script);
 	n1 = atol(word);
 	free(word);
 
-	word = get_word(h, 3);
+	word = (char*)xmalloc(lens[2] + 1);
+	memcpy(word, words[2], lens[2]);
+	word[lens[2]] = '\0';
 	replace_norealloc(")", "", word);
 	decipher_string(&word, script);
 	n2 = atol(word);
 	free(word);
 
-	word = get_word(h, 2);
+	/* Operators are at most 2 characters long */
+	char op[3] = "";
+	if (lens[1] <= 2) {
+		memcpy(op, words[1], lens[1]);
+		op[lens[1]] = '\0';
+	}
+	word = op;
 	log_debug("🧮 Compared %d to %d", n1, n2);
 
 	if (compare(word, "==")) {
@@ -1446,7 +1554,6 @@ int var_figure(char* h, int script) {
 			ret = 1;
 		else
 			ret = 0;
-		free(word);
 		log_exit("var_figure: %d", ret);
 		return ret;
 	}
@@ -1456,7 +1563,6 @@ int var_figure(char* h, int script) {
 			ret = 1;
 		else
 			ret = 0;
-		free(word);
 		log_exit("var_figure: %d", ret);
 		return ret;
 	}
@@ -1466,7 +1572,6 @@ int var_figure(char* h, int script) {
 			ret = 1;
 		else
 			ret = 0;
-		free(word);
 		log_exit("var_figure: %d", ret);
 		return ret;
 	}
@@ -1476,7 +1581,6 @@ int var_figure(char* h, int script) {
 			ret = 1;
 		else
 			ret = 0;
-		free(word);
 		log_exit("var_figure: %d", ret);
 		return ret;
 	}
@@ -1486,7 +1590,6 @@ int var_figure(char* h, int script) {
 			ret = 1;
 		else
 			ret = 0;
-		free(word);
 		log_exit("var_figure: %d", ret);
 		return ret;
 	}
@@ -1496,12 +1599,10 @@ int var_figure(char* h, int script) {
 			ret = 1;
 		else
 			ret = 0;
-		free(word);
 		log_exit("var_figure: %d", ret);
 		return ret;
 	}
 
-	free(word);
 	log_exit("var_figure: %d", ret);
 	return ret;
 }
@@ -1733,18 +1834,23 @@ void int_prepare(char* line, int script) {
  *    2=string
  *    0=no more args (10 args max)
  *
+ * op: if not NULL, store the arguments in this compiled line instead
+ *     (see dinkc_compile_script); '&variables' are then kept as text,
+ *     to be deciphered when the line is run
+ *
  * Known compatibility issue: passing no argument to a function
  * expecting 1 int argument is considered valid..
  *
  * Return: 0 if parse error, 1 if success
  */
-int get_parms(char proc_name[20], int script, char* str_params, int* spec) {
+static int parse_parms(char* proc_name, int script, char* str_params, int* spec,
+					struct dinkc_op* op) {
 	log_enter("get_parms: proc_name: %s, script: %d, scriptname: %s, "
 			"str_params: %s, spec: %d", proc_name, script, RINFO_NAME(script),
 			str_params, *spec);
 	/* Clean-up parameters */
-	memset(nlist, 0, 10 * sizeof(int));
-	{
+	if (op == NULL) {
+		memset(nlist, 0, 10 * sizeof(int));
 		int i = 0;
 		for (; i < 10; i++)
 			slist[i][0] = '\0';
@@ -1758,8 +1864,9 @@ int get_parms(char proc_name[20], int script, char* str_params, int* spec) {
 		//Msg("Found first (.");
 		str_params++;
 	} else {
-		log_error("❗ [DinkC] Missing '(' in %s, offset %ld.", sinfo[script]->name,
-				rinfo(script)->current);
+		if (op == NULL)
+			log_error("❗ [DinkC] Missing '(' in %s, offset %ld.",
+					sinfo[script]->name, rinfo(script)->current);
 		log_exit("get_parms: %d", 0);
 		return 0;
 	}
@@ -1785,12 +1892,20 @@ int get_parms(char proc_name[20], int script, char* str_params, int* spec) {
 			int intval = -1;
 			if (parm[0] == '&') {
 				replace_norealloc(" ", "", parm);
-				intval = decipher(parm, script);
+				if (op != NULL) {
+					op->strs[i] = parm;
+					parm = NULL;
+				} else {
+					intval = decipher(parm, script);
+				}
 			} else {
 				intval = atol(parm);
 			}
 			// store parameter of type 'int'
-			nlist[i] = intval;
+			if (op != NULL)
+				op->ints[i] = intval;
+			else
+				nlist[i] = intval;
 			free(parm);
 		} else if (spec[i] == 2) // type=string
 		{
@@ -1798,12 +1913,18 @@ int get_parms(char proc_name[20], int script, char* str_params, int* spec) {
 			char* parm = NULL;
 			parm = separate_string(str_params, 2, '"');
 
+			// move to next param
+			int len = strlen(parm);
+
 			// replace DinkC string parameter
-			free(slist[i]);
-			slist[i] = parm;
+			if (op != NULL) {
+				op->strs[i] = parm;
+			} else {
+				free(slist[i]);
+				slist[i] = parm;
+			}
 
-			// move to next param
-			str_params += strlen(parm) + 2; // 2x"
+			str_params += len + 2; // 2x"
 			if (str_params > limit)
 				str_params = limit;
 		}
@@ -1838,6 +1959,10 @@ int get_parms(char proc_name[20], int script, char* str_params, int* spec) {
 	return 1;
 }
 
+int get_parms(char proc_name[20], int script, char* str_params, int* spec) {
+	return parse_parms(proc_name, script, str_params, spec, NULL);
+}
+
 /**
  * Are these 2 function signatures identical?
  */
@@ -1853,6 +1978,159 @@ static int signatures_eq_p(int* params1, int* params2) {
 	return 1;
 }
 
+/* Function signatures known to call_binding, cf. binding_signature */
+static int binding_signatures[][10] = {
+	{-1, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+	{1, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+	{2, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+	{1, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+	{1, 2, 0, 0, 0, 0, 0, 0, 0, 0},
+	{2, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+	{2, 2, 0, 0, 0, 0, 0, 0, 0, 0},
+	{1, 1, 1, 0, 0, 0, 0, 0, 0, 0},
+	{2, 1, 1, 0, 0, 0, 0, 0, 0, 0},
+	{1, 1, 1, 1, 0, 0, 0, 0, 0, 0},
+	{1, 1, 1, 1, 1, 0, 0, 0, 0, 0},
+	{1, 1, 1, 1, 1, 1, 0, 0, 0, 0},
+};
+#define NB_BINDING_SIGNATURES \
+	((int)(sizeof(binding_signatures) / sizeof(binding_signatures[0])))
+
+/**
+ * Index of the binding's parameters specification in
+ * binding_signatures, or -1 if it isn't supported.
+ */
+static int binding_signature(struct binding* pbd) {
+	int i = 0;
+	for (; i < NB_BINDING_SIGNATURES; i++)
+		if (signatures_eq_p(pbd->params, binding_signatures[i]))
+			return i;
+	return -1;
+}
+
+/**
+ * Call the C function behind a DinkC binding, with the arguments
+ * previously stored in nlist/slist. 'signature' comes from
+ * binding_signature(pbd).
+ */
+static enum dinkc_parser_state call_binding(int script, struct binding* pbd,
+											int signature) {
+	int yield = 0; /* don't yield by default */
+
+	cur_funcname = pbd->funcname; /* for error messages */
+	log_trace("process_line: Determine function signature for: %s",
+			cur_funcname);
+	switch (signature) {
+	case 0: {
+		log_trace("process_line: signature: %s", "{-1,0,0,0,0,0,0,0,0,0}");
+		void (*pf)(int, int*, int*) = (void (*)(int, int*, int*))pbd->func;
+		(*pf)(script, &yield, &returnint);
+		break;
+	}
+	case 1: {
+		log_trace("process_line: signature: %s", "{1,0,0,0,0,0,0,0,0,0}");
+		void (*pf)(int, int*, int*, int) =
+				(void (*)(int, int*, int*, int))pbd->func;
+		(*pf)(script, &yield, &returnint, nlist[0]);
+		break;
+	}
+	case 2: {
+		log_trace("process_line: signature: %s", "{2,0,0,0,0,0,0,0,0,0}");
+		void (*pf)(int, int*, int*, char*) =
+				(void (*)(int, int*, int*, char*))pbd->func;
+		(*pf)(script, &yield, &returnint, slist[0]);
+		break;
+	}
+	case 3: {
+		log_trace("process_line: signature: %s", "{1,1,0,0,0,0,0,0,0,0}");
+		void (*pf)(int, int*, int*, int, int) =
+				(void (*)(int, int*, int*, int, int))pbd->func;
+		(*pf)(script, &yield, &returnint, nlist[0], nlist[1]);
+		break;
+	}
+	case 4: {
+		log_trace("process_line: signature: %s", "{1,2,0,0,0,0,0,0,0,0}");
+		void (*pf)(int, int*, int*, int, char*) =
+				(void (*)(int, int*, int*, int, char*))pbd->func;
+		(*pf)(script, &yield, &returnint, nlist[0], slist[1]);
+		break;
+	}
+	case 5: {
+		log_trace("process_line: signature: %s", "{2,1,0,0,0,0,0,0,0,0}");
+		void (*pf)(int, int*, int*, char*, int) =
+				(void (*)(int, int*, int*, char*, int))pbd->func;
+		(*pf)(script, &yield, &returnint, slist[0], nlist[1]);
+		break;
+	}
+	case 6: {
+		log_trace("process_line: signature: %s", "{2,2,0,0,0,0,0,0,0,0}");
+		void (*pf)(int, int*, int*, char*, char*) =
+				(void (*)(int, int*, int*, char*, char*))pbd->func;
+		(*pf)(script, &yield, &returnint, slist[0], slist[1]);
+		break;
+	}
+	case 7: {
+		log_trace("process_line: signature: %s", "{1,1,1,0,0,0,0,0,0,0}");
+		void (*pf)(int, int*, int*, int, int, int) =
+				(void (*)(int, int*, int*, int, int, int))pbd->func;
+		(*pf)(script, &yield, &returnint, nlist[0], nlist[1], nlist[2]);
+		break;
+	}
+	case 8: {
+		log_trace("process_line: signature: %s", "{2,1,1,0,0,0,0,0,0,0}");
+		void (*pf)(int, int*, int*, char*, int, int) =
+				(void (*)(int, int*, int*, char*, int, int))pbd->func;
+		(*pf)(script, &yield, &returnint, slist[0], nlist[1], nlist[2]);
+		break;
+	}
+	case 9: {
+		log_trace("process_line: signature: %s", "{1,1,1,1,0,0,0,0,0,0}");
+		void (*pf)(int, int*, int*, int, int, int, int) =
+				(void (*)(int, int*, int*, int, int, int, int))pbd->func;
+		(*pf)(script, &yield, &returnint, nlist[0], nlist[1], nlist[2],
+			nlist[3]);
+		break;
+	}
+	case 10: {
+		log_trace("process_line: signature: %s", "{1,1,1,1,1,0,0,0,0,0}");
+		void (*pf)(int, int*, int*, int, int, int, int, int) =
+				(void (*)(int, int*, int*, int, int, int, int, int))pbd->func;
+		(*pf)(script, &yield, &returnint, nlist[0], nlist[1], nlist[2],
+			nlist[3], nlist[4]);
+		break;
+	}
+	case 11: {
+		log_trace("process_line: signature: %s", "{1,1,1,1,1,1,0,0,0,0}");
+		void (*pf)(int, int*, int*, int, int, int, int, int, int) =
+				(void (*)(int, int*, int*, int, int, int, int, int,
+						int))pbd->func;
+		(*pf)(script, &yield, &returnint, nlist[0], nlist[1], nlist[2],
+			nlist[3], nlist[4], nlist[5]);
+		break;
+	}
+	default:
+		log_fatal("Internal error: DinkC function %s has unknown "
+				"signature",
+				pbd->funcname);
+		exit(EXIT_FAILURE);
+	}
+	if (dbg.debug_returnint)
+		log_debug("🔢 Value of returnint after '%s': %d", cur_funcname, returnint);
+	cur_funcname = "";
+	/* the function can manipulation returnint through argument #3 */
+
+	if (yield == 0) {
+		return DCPS_GOTO_NEXTLINE;
+	} else if (yield == 1) {
+		return DCPS_YIELD;
+	} else {
+		log_fatal("Internal error: DinkC function %s requested invalid "
+				"state %d",
+				pbd->funcname, yield);
+		exit(EXIT_FAILURE);
+	}
+}
+
 /**
  * Process one line of DinkC and returns directive to the DinkC
  * interpreter.
@@ -2251,10 +2529,6 @@ match. */
 		pbd = dinkc_bindings_lookup(funcname);
 
 		if (pbd != NULL) {
-			/* Common arguments */
-			int* yield = (int*)alloca(sizeof(int) * 1);
-			yield[0] = 0; /* don't yield by default) */
-
 			/* Specific arguments */
 			int* params = pbd->params;
 			if (params[0] != -1) /* no args == no checks*/
@@ -2278,146 +2552,9 @@ match. */
 				}
 			}
 
-			/* Call C function */
-			cur_funcname = pbd->funcname; /* for error messages */
-			int sig_void[10] = {-1, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-			int sig_int[10] = {1, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-			int sig_str[10] = {2, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-			int sig_int_int[10] = {1, 1, 0, 0, 0, 0, 0, 0, 0, 0};
-			int sig_int_str[10] = {1, 2, 0, 0, 0, 0, 0, 0, 0, 0};
-			int sig_str_int[10] = {2, 1, 0, 0, 0, 0, 0, 0, 0, 0};
-			int sig_str_str[10] = {2, 2, 0, 0, 0, 0, 0, 0, 0, 0};
-			int sig_int_int_int[10] = {1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
-			int sig_str_int_int[10] = {2, 1, 1, 0, 0, 0, 0, 0, 0, 0};
-			int sig_int_int_int_int[10] = {1, 1, 1, 1, 0, 0, 0, 0, 0, 0};
-			int sig_int_int_int_int_int[10] = {1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
-			int sig_int_int_int_int_int_int[10] = {1, 1, 1, 1, 1,
-												1, 0, 0, 0, 0};
-
-			log_trace("process_line: Determine function signature for: %s",
-					cur_funcname);
-			/* {-1,0,0,0,0,0,0,0,0,0} */
-			if (signatures_eq_p(pbd->params, sig_void)) {
-				log_trace("process_line: signature: %s",
-						"{-1,0,0,0,0,0,0,0,0,0}");
-				void (*pf)(int, int*, int*) =
-						(void (*)(int, int*, int*))pbd->func;
-				(*pf)(script, yield, &returnint);
-			}
-			/* {1,0,0,0,0,0,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params, sig_int)) {
-				log_trace("process_line: signature: %s",
-						"{1,0,0,0,0,0,0,0,0,0}");
-				void (*pf)(int, int*, int*, int) =
-						(void (*)(int, int*, int*, int))pbd->func;
-				(*pf)(script, yield, &returnint, nlist[0]);
-			}
-			/* {2,0,0,0,0,0,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params, sig_str)) {
-				log_trace("process_line: signature: %s",
-						"{2,0,0,0,0,0,0,0,0,0}");
-				void (*pf)(int, int*, int*, char*) =
-						(void (*)(int, int*, int*, char*))pbd->func;
-				(*pf)(script, yield, &returnint, slist[0]);
-			}
-			/* {1,1,0,0,0,0,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params, sig_int_int)) {
-				log_trace("process_line: signature: %s",
-						"{1,1,0,0,0,0,0,0,0,0}");
-				void (*pf)(int, int*, int*, int, int) =
-						(void (*)(int, int*, int*, int, int))pbd->func;
-				(*pf)(script, yield, &returnint, nlist[0], nlist[1]);
-			}
-			/* {1,2,0,0,0,0,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params, sig_int_str)) {
-				log_trace("process_line: signature: %s",
-						"{1,2,0,0,0,0,0,0,0,0}");
-				void (*pf)(int, int*, int*, int, char*) =
-						(void (*)(int, int*, int*, int, char*))pbd->func;
-				(*pf)(script, yield, &returnint, nlist[0], slist[1]);
-			}
-			/* {2,1,0,0,0,0,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params, sig_str_int)) {
-				log_trace("process_line: signature: %s",
-						"{2,1,0,0,0,0,0,0,0,0}");
-				void (*pf)(int, int*, int*, char*, int) =
-						(void (*)(int, int*, int*, char*, int))pbd->func;
-				(*pf)(script, yield, &returnint, slist[0], nlist[1]);
-			}
-			/* {2,2,0,0,0,0,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params, sig_str_str)) {
-				log_trace("process_line: signature: %s",
-						"{2,2,0,0,0,0,0,0,0,0}");
-				void (*pf)(int, int*, int*, char*, char*) =
-						(void (*)(int, int*, int*, char*, char*))pbd->func;
-				(*pf)(script, yield, &returnint, slist[0], slist[1]);
-			}
-			/* {1,1,1,0,0,0,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params, sig_int_int_int)) {
-				log_trace("process_line: signature: %s",
-						"{1,1,1,0,0,0,0,0,0,0}");
-				void (*pf)(int, int*, int*, int, int, int) =
-						(void (*)(int, int*, int*, int, int, int))pbd->func;
-				(*pf)(script, yield, &returnint, nlist[0], nlist[1], nlist[2]);
-			}
-			/* {2,1,1,0,0,0,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params, sig_str_int_int)) {
-				log_trace("process_line: signature: %s",
-						"{2,1,1,0,0,0,0,0,0,0}");
-				void (*pf)(int, int*, int*, char*, int, int) =
-						(void (*)(int, int*, int*, char*, int, int))pbd->func;
-				(*pf)(script, yield, &returnint, slist[0], nlist[1], nlist[2]);
-			}
-			/* {1,1,1,1,0,0,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params, sig_int_int_int_int)) {
-				log_trace("process_line: signature: %s",
-						"{1,1,1,1,0,0,0,0,0,0}");
-				void (*pf)(int, int*, int*, int, int, int, int) = (void (*)(
-						int, int*, int*, int, int, int, int))pbd->func;
-				(*pf)(script, yield, &returnint, nlist[0], nlist[1], nlist[2],
-					nlist[3]);
-			}
-			/* {1,1,1,1,1,0,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params, sig_int_int_int_int_int)) {
-				log_trace("process_line: signature: %s",
-						"{1,1,1,1,1,0,0,0,0,0}");
-				void (*pf)(int, int*, int*, int, int, int, int, int) =
-						(void (*)(int, int*, int*, int, int, int, int,
-								int))pbd->func;
-				(*pf)(script, yield, &returnint, nlist[0], nlist[1], nlist[2],
-					nlist[3], nlist[4]);
-			}
-			/* {1,1,1,1,1,1,0,0,0,0} */
-			else if (signatures_eq_p(pbd->params,
-									sig_int_int_int_int_int_int)) {
-				log_trace("process_line: signature: %s",
-						"{1,1,1,1,1,1,0,0,0,0}");
-				void (*pf)(int, int*, int*, int, int, int, int, int, int) =
-						(void (*)(int, int*, int*, int, int, int, int, int,
-								int))pbd->func;
-				(*pf)(script, yield, &returnint, nlist[0], nlist[1], nlist[2],
-					nlist[3], nlist[4], nlist[5]);
-			} else {
-				log_fatal("Internal error: DinkC function %s has unknown "
-						"signature",
-						pbd->funcname);
-				exit(EXIT_FAILURE);
-			}
-			if (dbg.debug_returnint)
-				log_debug("🔢 Value of returnint after '%s': %d", cur_funcname, returnint);
-			cur_funcname = "";
-			/* the function can manipulation returnint through argument #3 */
-
-			if (*yield == 0) {
-				PL_RETURN(DCPS_GOTO_NEXTLINE);
-			} else if (*yield == 1) {
-				PL_RETURN(DCPS_YIELD);
-			} else {
-				log_fatal("Internal error: DinkC function %s requested invalid "
-						"state %d",
-						pbd->funcname, *yield);
-				exit(EXIT_FAILURE);
-			}
+			enum dinkc_parser_state state =
+					call_binding(script, pbd, binding_signature(pbd));
+			PL_RETURN(state);
 		}
 	}
 
@@ -2764,6 +2901,280 @@ good:
 	PL_RETURN(DCPS_CONTINUE);
 }
 
+/**
+ * Try to lower a line of DinkC (already stripped from its leading
+ * spaces, as process_line would get it). Only lines that process_line
+ * would handle the same way whatever the state of the script are
+ * lowered; other lines are left as DCOP_TEXT.
+ */
+static void lower_line(int script, char* line, struct dinkc_op* op) {
+	op->type = DCOP_TEXT;
+
+	if (strcmp(line, "\n") == 0) {
+		op->type = DCOP_BLANK;
+		return;
+	}
+	if (line[0] == '/' && line[1] == '/') {
+		op->type = DCOP_COMMENT;
+		return;
+	}
+
+	/* Same split as process_line; keywords, labels and expressions
+	   are left to it */
+	char* ev0 = separate_string(line, 1, ' ');
+	if (ev0[0] == '\0' || ev0[0] == '(' || ev0[strlen(ev0) - 1] == ':' ||
+		compare(ev0, "VOID")) {
+		free(ev0);
+		return;
+	}
+	char* funcname = NULL;
+	if (strchr(ev0, '(') != NULL)
+		funcname = separate_string(line, 1, '(');
+	else
+		funcname = strdup(ev0);
+	free(ev0);
+
+	const char* keywords[] = {"void", "if", "else", "choice_start", "goto",
+							"int", "return;", "return", NULL};
+	struct binding* pbd = NULL;
+	if (funcname[0] != '{' && funcname[0] != '}') {
+		int i = 0;
+		for (; keywords[i] != NULL; i++)
+			if (compare(funcname, (char*)keywords[i]))
+				break;
+		if (keywords[i] == NULL)
+			pbd = dinkc_bindings_lookup(funcname);
+	}
+	if (pbd == NULL || binding_signature(pbd) < 0) {
+		free(funcname);
+		return;
+	}
+
+	/* Invalid parameters are reported by process_line when run */
+	int parsed = 1;
+	if (pbd->params[0] != -1) {
+		char* str_args = strdup(line + strlen(funcname));
+		parsed = parse_parms(funcname, script, str_args, pbd->params, op);
+		free(str_args);
+	}
+	free(funcname);
+	if (!parsed) {
+		int i = 0;
+		for (; i < 10; i++) {
+			free(op->strs[i]);
+			op->strs[i] = NULL;
+		}
+		return;
+	}
+
+	op->type = DCOP_CALL;
+	op->pbd = pbd;
+	op->signature = binding_signature(pbd);
+}
+
+/**
+ * Record the line if locate() or locate_goto() could stop there. The
+ * words are cut the same way they do.
+ */
+static void index_line(struct dinkc_program* program, char* line, int index) {
+	char* word = get_word(line, 1);
+	if (compare(word, "VOID")) {
+		char* word2 = get_word(line, 2);
+		char* proc = separate_string(word2, 1, '(');
+		program->procs.emplace(lowercase(proc), index);
+		free(proc);
+		free(word2);
+	}
+
+	/* goto labels always end with ':' */
+	replace_norealloc("\n", "", word);
+	int len = strlen(word);
+	if (len > 0 && word[len - 1] == ':')
+		program->labels.emplace(lowercase(word), index);
+	free(word);
+}
+
+/**
+ * Split rinfo_code[script] in lines the same way read_next_line
+ * does, and lower them. Called once when the script is loaded.
+ */
+static void dinkc_compile_script(int script) {
+	log_enter("dinkc_compile_script: script: %d", script);
+	dinkc_free_program(script);
+
+	char* code = rinfo_code[script];
+	long end = rinfo(script)->end;
+	struct dinkc_program* program = new dinkc_program();
+	int nb_alloc = 0;
+
+	long start = 0;
+	int cur_line = 1;
+	long last_newline = -1;
+	while (start < end) {
+		long k = start;
+		while (k < end && code[k] != '\n' && code[k] != '\r')
+			k++;
+		if (k >= end)
+			break; /* unterminated last line, never returned by read_next_line */
+
+		int len = k + 1 - start;
+		char* line = (char*)xmalloc(len + 1);
+		int i = 0;
+		for (; i < len; i++) {
+			line[i] = code[start + i];
+			if (line[i] == '\t')
+				line[i] = ' ';
+			if (line[i] == '\r')
+				line[i] = '\n';
+		}
+		line[len] = '\0';
+		strip_beginning_spaces(line);
+
+		if (program->nb_ops == nb_alloc) {
+			nb_alloc = nb_alloc == 0 ? 64 : nb_alloc * 2;
+			program->ops = (struct dinkc_op*)xrealloc(
+					program->ops, nb_alloc * sizeof(struct dinkc_op));
+		}
+		struct dinkc_op* op = &program->ops[program->nb_ops];
+		memset(op, 0, sizeof(*op));
+		op->start = start;
+		op->next = k + 1;
+		op->eol = code[k];
+		op->line = cur_line;
+		if (op->eol == '\n') {
+			cur_line++;
+			last_newline = k;
+			op->col = 0;
+		} else {
+			op->col = op->next - (last_newline + 1);
+		}
+		op->col_reset = (last_newline >= 0);
+		index_line(program, line, program->nb_ops);
+		lower_line(script, line, op);
+		program->nb_ops++;
+
+		free(line);
+		start = k + 1;
+	}
+
+	rinfo_program[script] = program;
+	log_exit("dinkc_compile_script: %d ops", program->nb_ops);
+}
+
+static void dinkc_free_program(int script) {
+	struct dinkc_program* program = rinfo_program[script];
+	if (program == NULL)
+		return;
+	int i = 0;
+	for (; i < program->nb_ops; i++) {
+		int j = 0;
+		for (; j < 10; j++)
+			free(program->ops[i].strs[j]);
+	}
+	free(program->ops);
+	delete program;
+	rinfo_program[script] = NULL;
+}
+
+/**
+ * Return the compiled line at rinfo(script)->current, or NULL if
+ * there's none. Unless it's a DCOP_TEXT line (to be read with
+ * read_next_line), update the line/column counters the same way
+ * read_next_line does.
+ */
+static struct dinkc_op* read_next_op(int script) {
+	if (sinfo[script] == NULL || rinfo_program[script] == NULL)
+		return NULL;
+	struct dinkc_program* program = rinfo_program[script];
+	long current = rinfo(script)->current;
+
+	int found = -1;
+	if (program->hint < program->nb_ops &&
+		program->ops[program->hint].start == current) {
+		found = program->hint;
+	} else {
+		int lo = 0, hi = program->nb_ops - 1;
+		while (lo <= hi) {
+			int mid = (lo + hi) / 2;
+			if (program->ops[mid].start < current) {
+				lo = mid + 1;
+			} else if (program->ops[mid].start > current) {
+				hi = mid - 1;
+			} else {
+				found = mid;
+				break;
+			}
+		}
+	}
+	if (found < 0)
+		return NULL;
+
+	program->hint = found + 1;
+	struct dinkc_op* op = &program->ops[found];
+	if (op->type == DCOP_TEXT)
+		return op;
+
+	rinfo(script)->debug_line = rinfo(script)->cur_line;
+	rinfo(script)->current = op->next;
+	if (op->eol == '\n') {
+		rinfo(script)->cur_line++;
+		rinfo(script)->cur_col = 0;
+	} else {
+		rinfo(script)->cur_col += op->next - op->start;
+	}
+	return op;
+}
+
+/**
+ * Run a DCOP_COMMENT or DCOP_CALL line, with the same effects as
+ * process_line on its text.
+ */
+static enum dinkc_parser_state run_op(int script, struct dinkc_op* op) {
+	if (rinfo(script)->level < 1)
+		rinfo(script)->level = 1;
+
+	if (op->type == DCOP_COMMENT)
+		return DCPS_GOTO_NEXTLINE;
+
+	/* Stop processing if we're skipping the current { section } */
+	if (rinfo(script)->onlevel > 0 &&
+		rinfo(script)->level > rinfo(script)->onlevel)
+		return DCPS_GOTO_NEXTLINE;
+
+	rinfo(script)->onlevel = 0;
+
+	/* Skip the current line if the previous 'if' or 'else' said so */
+	if (rinfo(script)->skipnext) {
+		rinfo(script)->skipnext = /*false*/ 0;
+		return DCPS_DOELSE_ONCE;
+	}
+
+	struct binding* pbd = op->pbd;
+	int* spec = pbd->params;
+	if (spec[0] != -1) {
+		memset(nlist, 0, 10 * sizeof(int));
+		int i = 0;
+		for (; i < 10; i++)
+			slist[i][0] = '\0';
+		for (i = 0; i < 10; i++) {
+			if (spec[i] == 1) {
+				if (op->strs[i] != NULL)
+					nlist[i] = decipher(op->strs[i], script);
+				else
+					nlist[i] = op->ints[i];
+			} else if (spec[i] == 2) {
+				free(slist[i]);
+				slist[i] = strdup(op->strs[i]);
+			}
+			if ((i + 1) == 10 || spec[i + 1] == 0)
+				break;
+		}
+	}
+
+	/* 'op' may be freed from here if the script gets killed */
+	return call_binding(script, pbd, op->signature);
+}
+
 /****************/
 /*  Hash table  */
 /*              */
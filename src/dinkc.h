@@ -55,6 +55,7 @@ struct refinfo {
 };
 
 extern int dinkc_enabled;
+extern Uint64 dinkc_instructions;
 
 //extern struct refinfo* rinfo[];
 //For getting script contents in imgui
@@ -129,4 +130,5 @@ extern unsigned short decipher_savegame;
 /* Test suite */
 extern int ts_lookup_var_local_global(char* variable, int scope);
 extern int ts_script_init(const char* name, char* code);
+extern void ts_script_compile(int script);
 #endif
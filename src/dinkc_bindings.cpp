@@ -394,6 +394,8 @@ void dc_sp_pseq(int script, int* yield, int* preturnint, int sprite,
 void dc_sp_que(int script, int* yield, int* preturnint, int sprite, int sparg) {
 	RETURN_NEG_IF_BAD_SPRITE(sprite);
 	*preturnint = change_sprite(sprite, sparg, &spr[sprite].que);
+	if (sparg != -1)
+		lsm_depth_index_update(sprite);
 }
 
 void dc_sp_range(int script, int* yield, int* preturnint, int sprite,
@@ -481,6 +483,8 @@ void dc_sp_x(int script, int* yield, int* preturnint, int sprite, int sparg) {
 void dc_sp_y(int script, int* yield, int* preturnint, int sprite, int sparg) {
 	RETURN_NEG_IF_BAD_SPRITE(sprite);
 	*preturnint = change_sprite(sprite, sparg, &spr[sprite].y);
+	if (sparg != -1)
+		lsm_depth_index_update(sprite);
 }
 
 void dc_sp_kill(int script, int* yield, int* preturnint, int sprite,
@@ -1543,16 +1547,13 @@ void dc_sp_custom(int script, int* yield, int* preturnint, char* key,
 		*preturnint = -1;
 	} else {
 		// If key doesn't exist, create it.
-		if (spr[sprite].custom->find(key) == spr[sprite].custom->end())
-			spr[sprite].custom->insert(std::make_pair(key, 0));
+		int* value = sp_custom_get(&spr[sprite].custom, sp_custom_intern(key));
 
 		// Set the value
-		if (val != -1) {
-			spr[sprite].custom->erase(key);
-			spr[sprite].custom->insert(std::make_pair(key, val));
-		}
+		if (val != -1)
+			*value = val;
 
-		*preturnint = spr[sprite].custom->find(key)->second;
+		*preturnint = *value;
 	}
 }
 
@@ -26,6 +26,9 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
 #include "paths.h"
 #include "dinkini.h"
 #include "str_util.h"
@@ -35,6 +38,7 @@
 #include "bgm.h"
 
 #include "gfx_sprites.h"
+#include "live_sprites_grid.h"
 //To toggle scripting engine availability from dink.ini
 #ifndef DINKEDIT
 #include "dinklua.h"
@@ -345,25 +349,95 @@ void pre_figure_out(char* line, bool playmidi) {
 		free(ev[i]);
 }
 
+/* Load flags for the 4th field of a LOAD_SEQUENCE[_NOW] line */
+static int sequence_flags(char* option) {
+	if (compare(option, "BLACK"))
+		return DINKINI_NOTANIM | DINKINI_BLACK;
+	else if (compare(option, "LEFTALIGN"))
+		return DINKINI_LEFTALIGN;
+	else if (compare(option, "NOTANIM"))
+		return 0;
+	else
+		return DINKINI_NOTANIM;
+}
+
+/**
+ * Queue the graphics of a LOAD_SEQUENCE_NOW line for background
+ * decoding, with the same flags pre_figure_out() will use
+ */
+static void prefetch_sequence(char* line) {
+	char* command = separate_string(line, 1, ' ');
+	char* path = separate_string(line, 2, ' ');
+	char* option = separate_string(line, 4, ' ');
+	if (command != NULL && path != NULL && option != NULL
+		&& compare(command, "LOAD_SEQUENCE_NOW"))
+		gfx_sprites_prefetch(path, sequence_flags(option));
+	free(command);
+	free(path);
+	free(option);
+}
+
+/**
+ * Where check_seq_status() would load this sequence from, for
+ * decoding it ahead of time. Returns NULL if it is loaded already or
+ * has nothing to load, otherwise a path to free().
+ */
+char* seq_unloaded_source(int seq_no, int* flags) {
+	if (seq_no <= 0 || seq_no >= MAX_SEQUENCES || !seq[seq_no].is_active
+		|| seq[seq_no].ini == NULL)
+		return NULL;
+	if (seq[seq_no].frame[1] != 0 && GFX_k[seq[seq_no].frame[1]].k != NULL)
+		return NULL;
+
+	char* command = separate_string(seq[seq_no].ini, 1, ' ');
+	char* path = separate_string(seq[seq_no].ini, 2, ' ');
+	char* option = separate_string(seq[seq_no].ini, 4, ' ');
+	if (command == NULL || path == NULL
+		|| !(compare(command, "LOAD_SEQUENCE_NOW") || compare(command, "LOAD_SEQUENCE"))) {
+		free(path);
+		path = NULL;
+	} else {
+		*flags = sequence_flags(option != NULL ? option : (char*)"");
+	}
+	free(command);
+	free(option);
+	return path;
+}
+
 /* Parse dink.ini */
 void load_batch(bool playmidi) {
 	FILE* in = NULL;
 	char line[255];
 	int i = 0;
+	Uint32 start = SDL_GetTicks();
 	/* Open the text file in binary mode, so it's read the same way
 under different OSes (Unix has no text mode) */
 	if ((in = paths_dmodfile_fopen("dink.ini", "rb")) == NULL) {
 		log_error("📚 Error opening dink.ini for reading.");
 	}
 	else {
-		while (fgets(line, 255, in) != NULL) {
+		std::vector<std::string> lines;
+		while (fgets(line, 255, in) != NULL)
+			lines.push_back(line);
+		fclose(in);
+
+		/* Decode the graphics in the background while the lines are
+		processed; slots are still assigned in dink.ini order */
+		gfx_sprites_prefetch_start();
+		for (auto& l : lines) {
+			strcpy(line, l.c_str());
+			prefetch_sequence(line);
+		}
+		for (auto& l : lines) {
+			strcpy(line, l.c_str());
 			pre_figure_out(line, playmidi);
 			/* printf("[pre_figure_out] %s", line); */
 			i++;
 		}
-		fclose(in);
+		gfx_sprites_prefetch_stop();
 	}
 	program_idata();
+	log_info("📚 dink.ini loaded in %ums", SDL_GetTicks() - start);
 }
 
 /**
@@ -485,8 +559,11 @@ void check_seq_status(int seq_no) {
 		if (!seq[seq_no].is_active)
 			return;
 
-		if (seq[seq_no].frame[1] == 0 || GFX_k[seq[seq_no].frame[1]].k == NULL)
+		if (seq[seq_no].frame[1] == 0 || GFX_k[seq[seq_no].frame[1]].k == NULL) {
 			figure_out(seq[seq_no].ini);
+			/* sprites using this sequence get their real hardbox */
+			sprites_grid_invalidate();
+		}
 	} else if (seq_no > 0) {
 		log_error("🌈 Warning: check_seq_status: invalid sequence %d", seq_no);
 	}
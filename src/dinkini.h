@@ -40,6 +40,7 @@ enum idata_type {
 #define DINKINI_NOTANIM 0x00000004
 #define DINKINI_COMPAT_DIRFF 0x00000008
 
+extern int nb_idata;
 extern void dinkini_init(int nb_idata);
 extern void dinkini_quit(void);
 extern void load_batch(bool playmidi);
@@ -49,5 +50,6 @@ extern void figure_out(char* line);
 extern void check_base(int base);
 extern void check_seq_status(int h);
 extern void check_frame_status(int h, int frame);
+extern char* seq_unloaded_source(int seq_no, int* flags);
 
 #endif
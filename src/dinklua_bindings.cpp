@@ -33,6 +33,7 @@
 #endif
 
 #include <string.h>
+#include <stdarg.h>
 #include <math.h>
 #include <libintl.h>
 #define _(String) gettext (String)
@@ -86,7 +87,7 @@ using Random = effolkronium::random_static;
 #define LUA_REPORT_PROPERTY_NUMBER_ERROR(name)                                     \
 if (!lua_isnumber(l, -1))                                                           \
 {                                                                                    \
-  return luaL_error(l, "The " #name " property must be set to a number");             \
+  return dinklua_property_error(l, "The " #name " property must be set to a number"); \
 }
 /*if (!lua_tointeger(l, -1) == -1)                                                        \
 {                                                                                        \
@@ -96,20 +97,20 @@ if (!lua_isnumber(l, -1))
 #define LUA_REPORT_PROPERTY_BOOLEAN_ERROR(name)                             \
 if (!lua_isboolean(l, -1))                                                  \
 {                                                                           \
-  return luaL_error(l, "The " #name " property must be set to a boolean");  \
+  return dinklua_property_error(l, "The " #name " property must be set to a boolean"); \
 }
 
 #define LUA_REPORT_PROPERTY_STRING_ERROR(name)                               \
 if (!lua_isstring(l, -1))                                                    \
 {                                                                            \
-  return luaL_error(l, "The " #name " property must be set to a string");    \
+  return dinklua_property_error(l, "The " #name " property must be set to a string"); \
 }
 
 #define LUA_REPORT_READ_ONLY(name)                                           \
-return luaL_error(l, "The " #name " property is a read-only property");
+return dinklua_property_error(l, "The " #name " property is a read-only property");
 
 #define LUA_REPORT_WRITE_ONLY(name)                                          \
-return luaL_error(l, "The " #name " property is a write-only property");
+return dinklua_property_error(l, "The " #name " property is a write-only property");
 
 /*#define LUA_CHECK_PARAMETER_NUMBER_ERROR(name, index)                        \
 if (!lua_isnumber(l, index))                                                 \
@@ -145,755 +146,1019 @@ if (!lua_isstring(l, index))                                                 \
 }                                                                            \
 const char* name = lua_tostring(l, index);*/
 
-static int dinklua_set_sprite_value(lua_State *l)
+/* Like luaL_error(), but reported at the script line. From a
+   metamethod that's the caller of the C function; from a pcall()'d
+   binding it's pcall itself, which has no line, as before. */
+static int dinklua_property_error(lua_State *l, const char *fmt, ...)
+{
+  va_list argp;
+  va_start(argp, fmt);
+  luaL_where(l, 2);
+  lua_pushvfstring(l, fmt, argp);
+  va_end(argp);
+  lua_concat(l, 2);
+  return lua_error(l);
+}
+
+/* Everything a sprite object answers to besides its methods. Lua
+   interns the key strings, so __index/__newindex find the property
+   with a single table lookup and then jump to it. */
+#define SPRITE_PROPERTIES(X) \
+  X(active) X(attack_hit_sound) X(attack_hit_sound_speed) X(attack_wait) \
+  X(base_attack) X(base_die) X(base_hit) X(base_idle) X(base_walk) \
+  X(brain) X(brain_parm) X(brain_parm2) X(defense) X(dir) X(disabled) \
+  X(distance) X(exp) X(flying) X(follow) X(frame) X(frame_delay) X(gold) \
+  X(hard) X(hitpoints) X(move_nohard) X(mx) X(my) X(clip) X(noclip) \
+  X(control) X(nocontrol) X(draw) X(nodraw) X(hit) X(nohit) X(touch) \
+  X(notouch) X(pframe) X(picfreeze) X(pseq) X(que) X(range) X(reverse) \
+  X(seq) X(size) X(sound) X(speed) X(strength) X(target) X(timing) \
+  X(touch_damage) X(x) X(y) X(kill) X(editor_num) X(script) X(blood_num) \
+  X(blood_seq) X(clip_bottom) X(clip_left) X(clip_right) X(clip_top) \
+  X(freeze) X(action) \
+  X(sprite_number) X(custom) \
+  /* Dink only */ \
+  X(get_speed) X(set_speed) X(can_walk_off_screen) X(base_push)
+
+enum sprite_property
+{
+  SPRITE_PROPERTY_NONE = 0,
+#define X(name) SPRITE_PROPERTY_ ## name,
+  SPRITE_PROPERTIES(X)
+#undef X
+};
+
+static const struct
+{
+  const char* name;
+  enum sprite_property property;
+} sprite_property_names[] =
+{
+#define X(name) {#name, SPRITE_PROPERTY_ ## name},
+  SPRITE_PROPERTIES(X)
+#undef X
+  // Alternative spellings
+  {"base_death", SPRITE_PROPERTY_base_die},
+  {"move_x", SPRITE_PROPERTY_mx},
+  {"move_y", SPRITE_PROPERTY_my},
+  {"cue", SPRITE_PROPERTY_que},
+};
+
+static void dinklua_push_sprite_object(lua_State *l, int sprite_number);
+static void dinklua_push_sprite_custom_object(lua_State *l, int sprite_number);
+static int dinklua_to_sprite_object(lua_State *l, int idx);
+static int dinklua_dink_object_set_speed(lua_State *l);
+static int dinklua_dink_object_can_walk_off_screen(lua_State *l);
+static int dinklua_set_dink_base_push(lua_State *l);
+
+static int dinklua_set_sprite_property(lua_State *l, int sprite_number,
+                                       int property, const char* sprite_command)
 {
-  int sprite_number = lua_tointeger(l, -3);
-  const char* sprite_command = lua_tostring(l, -2);
-
   log_debug("🌝[Lua] set sprite property %s on sprite %d",
             sprite_command, sprite_number);
 
-  if (strcmp(sprite_command, "active") == 0)
+  switch (property)
   {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(active);
+    case SPRITE_PROPERTY_active:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(active);
 
-    int active = lua_toboolean(l, -1);
-    int val = (int)spr[sprite_number].active;
-    change_sprite_noreturn(sprite_number, active, &val);
+      int active = lua_toboolean(l, -1);
+      int val = (int)spr[sprite_number].active;
+      change_sprite_noreturn(sprite_number, active, &val);
 
-    if (!val)
-      lsm_remove_sprite(sprite_number);
-  }
-  else if (strcmp(sprite_command, "attack_hit_sound") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(attack_hit_sound);
+      if (!val)
+        lsm_remove_sprite(sprite_number);
+      break;
+    }
+    case SPRITE_PROPERTY_attack_hit_sound:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(attack_hit_sound);
 
-    int attack_hit_sound = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, attack_hit_sound, &spr[sprite_number].attack_hit_sound);
-  }
-  else if (strcmp(sprite_command, "attack_hit_sound_speed") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(attack_hit_sound_speed);
+      int attack_hit_sound = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, attack_hit_sound, &spr[sprite_number].attack_hit_sound);
+      break;
+    }
+    case SPRITE_PROPERTY_attack_hit_sound_speed:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(attack_hit_sound_speed);
 
-    int attack_hit_sound_speed = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, attack_hit_sound_speed, &spr[sprite_number].attack_hit_sound_speed);
-  }
-  else if (strcmp(sprite_command, "attack_wait") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(attack_wait);
+      int attack_hit_sound_speed = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, attack_hit_sound_speed, &spr[sprite_number].attack_hit_sound_speed);
+      break;
+    }
+    case SPRITE_PROPERTY_attack_wait:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(attack_wait);
 
-    int attack_wait = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, attack_wait+thisTickCount, &spr[sprite_number].attack_wait);
-  }
-  else if (strcmp(sprite_command, "base_attack") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(base_attack);
+      int attack_wait = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, attack_wait+thisTickCount, &spr[sprite_number].attack_wait);
+      break;
+    }
+    case SPRITE_PROPERTY_base_attack:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(base_attack);
 
-    int base_attack = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, base_attack, &spr[sprite_number].base_attack);
-  }
-  else if (strcmp(sprite_command, "base_die") == 0 || strcmp(sprite_command, "base_death") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(base_die);
+      int base_attack = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, base_attack, &spr[sprite_number].base_attack);
+      break;
+    }
+    case SPRITE_PROPERTY_base_die:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(base_die);
 
-    int base_die = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, base_die, &spr[sprite_number].base_die);
-  }
-  else if (strcmp(sprite_command, "base_hit") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(base_hit);
+      int base_die = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, base_die, &spr[sprite_number].base_die);
+      break;
+    }
+    case SPRITE_PROPERTY_base_hit:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(base_hit);
 
-    int base_hit = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, base_hit, &spr[sprite_number].base_hit);
-  }
-  else if (strcmp(sprite_command, "base_idle") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(base_idle);
+      int base_hit = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, base_hit, &spr[sprite_number].base_hit);
+      break;
+    }
+    case SPRITE_PROPERTY_base_idle:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(base_idle);
 
-    int base_idle = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, base_idle, &spr[sprite_number].base_idle);
-  }
-  else if (strcmp(sprite_command, "base_walk") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(base_walk);
+      int base_idle = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, base_idle, &spr[sprite_number].base_idle);
+      break;
+    }
+    case SPRITE_PROPERTY_base_walk:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(base_walk);
 
-    int base_walk = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, base_walk, &spr[sprite_number].base_walk);
-  }
-  else if (strcmp(sprite_command, "brain") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(brain);
+      int base_walk = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, base_walk, &spr[sprite_number].base_walk);
+      break;
+    }
+    case SPRITE_PROPERTY_brain:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(brain);
 
-    int brain = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, brain, &spr[sprite_number].brain);
-  }
-  else if (strcmp(sprite_command, "brain_parm") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(brain_parm);
+      int brain = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, brain, &spr[sprite_number].brain);
+      break;
+    }
+    case SPRITE_PROPERTY_brain_parm:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(brain_parm);
 
-    int brain_parm = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, brain_parm, &spr[sprite_number].brain_parm);
-  }
-  else if (strcmp(sprite_command, "brain_parm2") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(brain_parm2);
+      int brain_parm = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, brain_parm, &spr[sprite_number].brain_parm);
+      break;
+    }
+    case SPRITE_PROPERTY_brain_parm2:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(brain_parm2);
 
-    int brain_parm2 = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, brain_parm2, &spr[sprite_number].brain_parm2);
-  }
-  else if (strcmp(sprite_command, "defense") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(defense);
+      int brain_parm2 = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, brain_parm2, &spr[sprite_number].brain_parm2);
+      break;
+    }
+    case SPRITE_PROPERTY_defense:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(defense);
 
-    int defense = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, defense, &spr[sprite_number].defense);
-  }
-  else if (strcmp(sprite_command, "dir") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(dir);
+      int defense = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, defense, &spr[sprite_number].defense);
+      break;
+    }
+    case SPRITE_PROPERTY_dir:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(dir);
 
-    int dir = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, dir, &spr[sprite_number].dir);
-    changedir(spr[sprite_number].dir, sprite_number, spr[sprite_number].base_walk);
-  }
-  else if (strcmp(sprite_command, "disabled") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(disabled);
+      int dir = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, dir, &spr[sprite_number].dir);
+      changedir(spr[sprite_number].dir, sprite_number, spr[sprite_number].base_walk);
+      break;
+    }
+    case SPRITE_PROPERTY_disabled:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(disabled);
 
-    int disabled = lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, disabled, &spr[sprite_number].disabled);
-  }
-  else if (strcmp(sprite_command, "distance") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(distance);
+      int disabled = lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, disabled, &spr[sprite_number].disabled);
+      break;
+    }
+    case SPRITE_PROPERTY_distance:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(distance);
 
-    int distance = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, distance, &spr[sprite_number].distance);
-  }
-  else if (strcmp(sprite_command, "exp") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(exp);
+      int distance = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, distance, &spr[sprite_number].distance);
+      break;
+    }
+    case SPRITE_PROPERTY_exp:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(exp);
 
-    int exp = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, exp, &spr[sprite_number].exp);
-  }
-  else if (strcmp(sprite_command, "flying") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(flying);
+      int exp = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, exp, &spr[sprite_number].exp);
+      break;
+    }
+    case SPRITE_PROPERTY_flying:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(flying);
 
-    int flying = lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, flying, &spr[sprite_number].flying);
-  }
-  else if (strcmp(sprite_command, "follow") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(follow);
+      int flying = lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, flying, &spr[sprite_number].flying);
+      break;
+    }
+    case SPRITE_PROPERTY_follow:
+    {
+      // Also takes a sprite object, or nil for none
+      if (lua_isnil(l, -1))
+      {
+        lua_pop(l, 1);
+        lua_pushinteger(l, 0);
+      }
+      else if (!lua_isnumber(l, -1))
+      {
+        int target_sprite = dinklua_to_sprite_object(l, -1);
+        if (target_sprite < 0)
+          return dinklua_property_error(l, "target value must be a sprite number or a sprite object");
+        lua_pop(l, 1);
+        lua_pushinteger(l, target_sprite);
+      }
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(follow);
 
-    int follow = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, follow, &spr[sprite_number].follow);
-  }
-  else if (strcmp(sprite_command, "frame") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(frame);
+      int follow = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, follow, &spr[sprite_number].follow);
+      break;
+    }
+    case SPRITE_PROPERTY_frame:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(frame);
 
-    int frame = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, frame, &spr[sprite_number].frame);
-  }
-  else if (strcmp(sprite_command, "frame_delay") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(frame_delay);
+      int frame = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, frame, &spr[sprite_number].frame);
+      break;
+    }
+    case SPRITE_PROPERTY_frame_delay:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(frame_delay);
 
-    int frame_delay = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, frame_delay, &spr[sprite_number].frame_delay);
-  }
-  else if (strcmp(sprite_command, "gold") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(gold);
+      int frame_delay = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, frame_delay, &spr[sprite_number].frame_delay);
+      break;
+    }
+    case SPRITE_PROPERTY_gold:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(gold);
 
-    int gold = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, gold, &spr[sprite_number].gold);
-  }
-  else if (strcmp(sprite_command, "hard") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(hard);
-    //ye: gotta invert this because of historical reasons
-    int hard = !lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, hard, &spr[sprite_number].hard);
-    if (spr[sprite_number].sp_index != 0)
-      cur_ed_screen.sprite[spr[sprite_number].sp_index].hard = hard;
-  }
-  else if (strcmp(sprite_command, "hitpoints") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(hitpoints);
+      int gold = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, gold, &spr[sprite_number].gold);
+      break;
+    }
+    case SPRITE_PROPERTY_hard:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(hard);
+      //ye: gotta invert this because of historical reasons
+      int hard = !lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, hard, &spr[sprite_number].hard);
+      if (spr[sprite_number].sp_index != 0)
+        cur_ed_screen.sprite[spr[sprite_number].sp_index].hard = hard;
+      break;
+    }
+    case SPRITE_PROPERTY_hitpoints:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(hitpoints);
 
-    int hitpoints = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, hitpoints, &spr[sprite_number].hitpoints);
-  }
-  else if (strcmp(sprite_command, "move_nohard") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(move_nohard);
+      int hitpoints = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, hitpoints, &spr[sprite_number].hitpoints);
+      break;
+    }
+    case SPRITE_PROPERTY_move_nohard:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(move_nohard);
 
-    int move_nohard = lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, move_nohard, &spr[sprite_number].move_nohard);
-  }
-  else if (strcmp(sprite_command, "mx") == 0 || strcmp(sprite_command, "move_x") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(mx);
+      int move_nohard = lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, move_nohard, &spr[sprite_number].move_nohard);
+      break;
+    }
+    case SPRITE_PROPERTY_mx:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(mx);
 
-    int mx = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, mx, &spr[sprite_number].mx);
-  }
-  else if (strcmp(sprite_command, "my") == 0 || strcmp(sprite_command, "move_y") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(my);
+      int mx = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, mx, &spr[sprite_number].mx);
+      break;
+    }
+    case SPRITE_PROPERTY_my:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(my);
 
-    int my = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, my, &spr[sprite_number].my);
-  }
-  //ye: aliases
-  else if (strcmp(sprite_command, "clip") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(clip);
+      int my = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, my, &spr[sprite_number].my);
+      break;
+    }
+    //ye: aliases
+    case SPRITE_PROPERTY_clip:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(clip);
 
-    int noclip = !lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, noclip, &spr[sprite_number].noclip);
-  }
-  else if (strcmp(sprite_command, "noclip") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(noclip);
+      int noclip = !lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, noclip, &spr[sprite_number].noclip);
+      break;
+    }
+    case SPRITE_PROPERTY_noclip:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(noclip);
 
-    int noclip = lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, noclip, &spr[sprite_number].noclip);
-  }
-  else if (strcmp(sprite_command, "control") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(control);
+      int noclip = lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, noclip, &spr[sprite_number].noclip);
+      break;
+    }
+    case SPRITE_PROPERTY_control:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(control);
 
-    int nocontrol = !lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, nocontrol, &spr[sprite_number].nocontrol);
-  }
-  else if (strcmp(sprite_command, "nocontrol") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(nocontrol);
+      int nocontrol = !lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, nocontrol, &spr[sprite_number].nocontrol);
+      break;
+    }
+    case SPRITE_PROPERTY_nocontrol:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(nocontrol);
 
-    int nocontrol = lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, nocontrol, &spr[sprite_number].nocontrol);
-  }
-  else if (strcmp(sprite_command, "draw") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(draw);
+      int nocontrol = lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, nocontrol, &spr[sprite_number].nocontrol);
+      break;
+    }
+    case SPRITE_PROPERTY_draw:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(draw);
 
-    int nodraw = !lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, nodraw, &spr[sprite_number].nodraw);
-  }
-  else if (strcmp(sprite_command, "nodraw") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(nodraw);
+      int nodraw = !lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, nodraw, &spr[sprite_number].nodraw);
+      break;
+    }
+    case SPRITE_PROPERTY_nodraw:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(nodraw);
 
-    int nodraw = lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, nodraw, &spr[sprite_number].nodraw);
-  }
-  else if (strcmp(sprite_command, "hit") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(hit);
+      int nodraw = lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, nodraw, &spr[sprite_number].nodraw);
+      break;
+    }
+    case SPRITE_PROPERTY_hit:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(hit);
 
-    int nohit = !lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, nohit, &spr[sprite_number].nodraw);
-  }
-  else if (strcmp(sprite_command, "nohit") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(nohit);
+      int nohit = !lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, nohit, &spr[sprite_number].nodraw);
+      break;
+    }
+    case SPRITE_PROPERTY_nohit:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(nohit);
 
-    int nohit = lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, nohit, &spr[sprite_number].nohit);
-  }
-  else if (strcmp(sprite_command, "touch") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(touch);
+      int nohit = lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, nohit, &spr[sprite_number].nohit);
+      break;
+    }
+    case SPRITE_PROPERTY_touch:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(touch);
 
-    int notouch = !lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, notouch, &spr[sprite_number].notouch);
-  }
-  else if (strcmp(sprite_command, "notouch") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(notouch);
+      int notouch = !lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, notouch, &spr[sprite_number].notouch);
+      break;
+    }
+    case SPRITE_PROPERTY_notouch:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(notouch);
 
-    int notouch = lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, notouch, &spr[sprite_number].notouch);
-  }
-  else if (strcmp(sprite_command, "pframe") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(pframe);
+      int notouch = lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, notouch, &spr[sprite_number].notouch);
+      break;
+    }
+    case SPRITE_PROPERTY_pframe:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(pframe);
 
-    int pframe = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, pframe, &spr[sprite_number].pframe);
-  }
-  else if (strcmp(sprite_command, "picfreeze") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(picfreeze);
+      int pframe = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, pframe, &spr[sprite_number].pframe);
+      break;
+    }
+    case SPRITE_PROPERTY_picfreeze:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(picfreeze);
 
-    int picfreeze = lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, picfreeze, &spr[sprite_number].picfreeze);
-  }
-  else if (strcmp(sprite_command, "pseq") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(pseq);
+      int picfreeze = lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, picfreeze, &spr[sprite_number].picfreeze);
+      break;
+    }
+    case SPRITE_PROPERTY_pseq:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(pseq);
 
-    int pseq = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, pseq, &spr[sprite_number].pseq);
-  }
-  else if ((strcmp(sprite_command, "que") == 0) || (strcmp(sprite_command, "cue") == 0))
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(que);
+      int pseq = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, pseq, &spr[sprite_number].pseq);
+      break;
+    }
+    case SPRITE_PROPERTY_que:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(que);
 
-    int que = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, que, &spr[sprite_number].que);
-  }
-  else if (strcmp(sprite_command, "range") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(range);
+      int que = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, que, &spr[sprite_number].que);
+      lsm_depth_index_update(sprite_number);
+      break;
+    }
+    case SPRITE_PROPERTY_range:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(range);
 
-    int range = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, range, &spr[sprite_number].range);
-  }
-  else if (strcmp(sprite_command, "reverse") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(reverse);
+      int range = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, range, &spr[sprite_number].range);
+      break;
+    }
+    case SPRITE_PROPERTY_reverse:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(reverse);
+
+      int reverse = lua_toboolean(l, -1);
+      change_sprite_noreturn(sprite_number, reverse, &spr[sprite_number].reverse);
+      break;
+    }
+    case SPRITE_PROPERTY_seq:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(seq);
+
+      int seq = lua_tointeger(l, -1);
+
+      if ((seq < 0 || seq >= MAX_SEQUENCES))
+      {
+        // TODO: Test that this outputs the right information
+        int line = dinklua_get_current_line(l);
+        log_error("🌝[Lua] %s.lua:%d: invalid sequence %d, ignoring",
+                  sinfo[current_lua_script]->name, line, seq);
+      }
+      else
+      {
+        change_sprite_noreturn(sprite_number, seq, &spr[sprite_number].seq);
+      }
+      break;
+    }
+    case SPRITE_PROPERTY_size:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(size);
+
+      int size = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, size, &spr[sprite_number].size);
+      break;
+    }
+    case SPRITE_PROPERTY_sound:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(sound);
+
+      int sound = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, sound, &spr[sprite_number].sound);
+
+      if (sound > 0)
+      {
+        sfx_stop_sprite_sound(sprite_number);
+        sfx_play_sprite_sound(spr[sprite_number].sound, sprite_number, 1);
+      }
+      else
+  		  sfx_stop_sprite_sound(sprite_number);
+      break;
+    }
+    case SPRITE_PROPERTY_speed:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(speed);
+
+      int speed = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, speed, &spr[sprite_number].speed);
+      changedir(spr[sprite_number].dir, sprite_number, spr[sprite_number].base_walk);
+      break;
+    }
+    case SPRITE_PROPERTY_strength:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(strength);
+
+      int strength = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, strength, &spr[sprite_number].strength);
+      break;
+    }
+    case SPRITE_PROPERTY_target:
+    {
+      // Also takes a sprite object, or nil for none
+      if (lua_isnil(l, -1))
+      {
+        lua_pop(l, 1);
+        lua_pushinteger(l, 0);
+      }
+      else if (!lua_isnumber(l, -1))
+      {
+        int target_sprite = dinklua_to_sprite_object(l, -1);
+        if (target_sprite < 0)
+          return dinklua_property_error(l, "target value must be a sprite number or a sprite object");
+        lua_pop(l, 1);
+        lua_pushinteger(l, target_sprite);
+      }
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(target);
+
+      int target = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, target, &spr[sprite_number].target);
+      break;
+    }
+    case SPRITE_PROPERTY_timing:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(timing);
+
+      int timing = lua_tointeger(l, -1);
+      change_sprite(sprite_number, timing, &spr[sprite_number].timing);
+      break;
+    }
+    case SPRITE_PROPERTY_touch_damage:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(touch_damage);
+
+      int touch_damage = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, touch_damage, &spr[sprite_number].touch_damage);
+      break;
+    }
+    case SPRITE_PROPERTY_x:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(x);
+
+      int x = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, x, &spr[sprite_number].x);
+      break;
+    }
+    case SPRITE_PROPERTY_y:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(y);
+
+      int y = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, y, &spr[sprite_number].y);
+      lsm_depth_index_update(sprite_number);
+      break;
+    }
+    case SPRITE_PROPERTY_kill:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(kill);
+
+      int kill = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, kill, &spr[sprite_number].kill_ttl);
+      break;
+    }
+    case SPRITE_PROPERTY_editor_num:
+    {
+      LUA_REPORT_READ_ONLY(editor_num);
+    }
+    case SPRITE_PROPERTY_script:
+    {
+      LUA_REPORT_PROPERTY_STRING_ERROR(script);
+
+      const char *script = lua_tostring(l, -1);
+      scripting_sp_script(sprite_number, script);
+      break;
+    }
+    case SPRITE_PROPERTY_blood_num:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(blood_num);
+
+      int blood_num = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, blood_num, &spr[sprite_number].bloodnum);
+      break;
+    }
+    case SPRITE_PROPERTY_blood_seq:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(blood_seq);
+
+      int blood_seq = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, blood_seq, &spr[sprite_number].bloodseq);
+      break;
+    }
+    case SPRITE_PROPERTY_clip_bottom:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(clip_bottom);
+
+      int clip_bottom = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, clip_bottom, &spr[sprite_number].alt.bottom);
+      break;
+    }
+    case SPRITE_PROPERTY_clip_left:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(clip_left);
+
+      int clip_left = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, clip_left, &spr[sprite_number].alt.left);
+      break;
+    }
+    case SPRITE_PROPERTY_clip_right:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(clip_right);
+
+      int clip_right = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, clip_right, &spr[sprite_number].alt.right);
+      break;
+    }
+    case SPRITE_PROPERTY_clip_top:
+    {
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(clip_top);
+
+      int clip_top = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, clip_top, &spr[sprite_number].alt.top);
+      break;
+    }
+    case SPRITE_PROPERTY_freeze:
+    {
+      LUA_REPORT_PROPERTY_BOOLEAN_ERROR(freeze);
 
-    int reverse = lua_toboolean(l, -1);
-    change_sprite_noreturn(sprite_number, reverse, &spr[sprite_number].reverse);
+      int freeze = lua_toboolean(l, -1);
+
+      // Set the value
+      if (freeze == 0)
+        spr[sprite_number].freeze = 0;
+      else if (freeze == 1)
+        spr[sprite_number].freeze = current_lua_script;
+      break;
+    }
+    case SPRITE_PROPERTY_action:
+    {
+      //ye: used by sprite brains
+      LUA_REPORT_PROPERTY_NUMBER_ERROR(action);
+
+      int action = lua_tointeger(l, -1);
+      change_sprite_noreturn(sprite_number, action, &spr[sprite_number].action);
+      break;
+    }
+    case SPRITE_PROPERTY_sprite_number:
+    {
+      LUA_REPORT_READ_ONLY(sprite_number);
+    }
+    case SPRITE_PROPERTY_custom:
+    {
+      LUA_REPORT_READ_ONLY(custom);
+    }
+    case SPRITE_PROPERTY_can_walk_off_screen:
+    {
+      if (sprite_number != 1)
+        return dinklua_property_error(l, "Sprites do not have a '%s' property", sprite_command);
+      dinklua_dink_object_can_walk_off_screen(l);
+      break;
+    }
+    case SPRITE_PROPERTY_base_push:
+    {
+      if (sprite_number != 1)
+        return dinklua_property_error(l, "Sprites do not have a '%s' property", sprite_command);
+      dinklua_set_dink_base_push(l);
+      break;
+    }
+    default:
+      return dinklua_property_error(l, "Sprites do not have a '%s' property", sprite_command);
   }
-  else if (strcmp(sprite_command, "seq") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(seq);
 
-    int seq = lua_tointeger(l, -1);
+  return 0;
+}
+
+static int dinklua_get_sprite_property(lua_State *l, int sprite_number,
+                                       int property, const char* sprite_command)
+{
+  log_debug("🌝[Lua] get sprite value %s from sprite %d",
+            sprite_command, sprite_number);
 
-    if ((seq < 0 || seq >= MAX_SEQUENCES))
+  switch (property)
+  {
+    case SPRITE_PROPERTY_active:
+    {
+      lua_pushboolean(l, spr[sprite_number].active);
+      break;
+    }
+    case SPRITE_PROPERTY_attack_hit_sound:
+    {
+      lua_pushinteger(l, spr[sprite_number].attack_hit_sound);
+      break;
+    }
+    case SPRITE_PROPERTY_attack_hit_sound_speed:
+    {
+      lua_pushinteger(l, spr[sprite_number].attack_hit_sound_speed);
+      break;
+    }
+    case SPRITE_PROPERTY_attack_wait:
+    {
+      lua_pushinteger(l, spr[sprite_number].attack_wait);
+      break;
+    }
+    case SPRITE_PROPERTY_base_attack:
+    {
+      lua_pushinteger(l, spr[sprite_number].base_attack);
+      break;
+    }
+    case SPRITE_PROPERTY_base_die:
+    {
+      lua_pushinteger(l, spr[sprite_number].base_die);
+      break;
+    }
+    case SPRITE_PROPERTY_base_hit:
+    {
+      lua_pushinteger(l, spr[sprite_number].base_hit);
+      break;
+    }
+    case SPRITE_PROPERTY_base_idle:
+    {
+      lua_pushinteger(l, spr[sprite_number].base_idle);
+      break;
+    }
+    case SPRITE_PROPERTY_base_walk:
+    {
+      lua_pushinteger(l, spr[sprite_number].base_walk);
+      break;
+    }
+    case SPRITE_PROPERTY_brain:
+    {
+      lua_pushinteger(l, spr[sprite_number].brain);
+      break;
+    }
+    case SPRITE_PROPERTY_brain_parm:
+    {
+      lua_pushinteger(l, spr[sprite_number].brain_parm);
+      break;
+    }
+    case SPRITE_PROPERTY_brain_parm2:
+    {
+      lua_pushinteger(l, spr[sprite_number].brain_parm2);
+      break;
+    }
+    case SPRITE_PROPERTY_defense:
+    {
+      lua_pushinteger(l, spr[sprite_number].defense);
+      break;
+    }
+    case SPRITE_PROPERTY_dir:
+    {
+      lua_pushinteger(l, spr[sprite_number].dir);
+      break;
+    }
+    case SPRITE_PROPERTY_disabled:
+    {
+      lua_pushboolean(l, spr[sprite_number].disabled);
+      break;
+    }
+    case SPRITE_PROPERTY_distance:
+    {
+      lua_pushinteger(l, spr[sprite_number].distance);
+      break;
+    }
+    case SPRITE_PROPERTY_exp:
+    {
+      lua_pushinteger(l, spr[sprite_number].exp);
+      break;
+    }
+    case SPRITE_PROPERTY_flying:
+    {
+      lua_pushboolean(l, spr[sprite_number].flying);
+      break;
+    }
+    case SPRITE_PROPERTY_follow:
+    {
+      lua_pushinteger(l, spr[sprite_number].follow);
+      break;
+    }
+    case SPRITE_PROPERTY_frame:
+    {
+      lua_pushinteger(l, spr[sprite_number].frame);
+      break;
+    }
+    case SPRITE_PROPERTY_frame_delay:
+    {
+      lua_pushinteger(l, spr[sprite_number].frame_delay);
+      break;
+    }
+    case SPRITE_PROPERTY_gold:
+    {
+      lua_pushinteger(l, spr[sprite_number].gold);
+      break;
+    }
+    case SPRITE_PROPERTY_hard:
+    {
+      lua_pushboolean(l, !(bool)spr[sprite_number].hard);
+      break;
+    }
+    case SPRITE_PROPERTY_hitpoints:
+    {
+      lua_pushinteger(l, spr[sprite_number].hitpoints);
+      break;
+    }
+    case SPRITE_PROPERTY_move_nohard:
+    {
+      lua_pushboolean(l, spr[sprite_number].move_nohard);
+      break;
+    }
+    case SPRITE_PROPERTY_mx:
+    {
+      lua_pushinteger(l, spr[sprite_number].mx);
+      break;
+    }
+    case SPRITE_PROPERTY_my:
+    {
+      lua_pushinteger(l, spr[sprite_number].my);
+      break;
+    }
+    case SPRITE_PROPERTY_noclip:
+    {
+      lua_pushboolean(l, spr[sprite_number].noclip);
+      break;
+    }
+    case SPRITE_PROPERTY_nocontrol:
+    {
+      lua_pushboolean(l, spr[sprite_number].nocontrol);
+      break;
+    }
+    case SPRITE_PROPERTY_nodraw:
+    {
+      lua_pushboolean(l, spr[sprite_number].nodraw);
+      break;
+    }
+    case SPRITE_PROPERTY_nohit:
+    {
+      lua_pushboolean(l, spr[sprite_number].nohit);
+      break;
+    }
+    case SPRITE_PROPERTY_notouch:
+    {
+      lua_pushboolean(l, spr[sprite_number].notouch);
+      break;
+    }
+    case SPRITE_PROPERTY_pframe:
+    {
+      lua_pushinteger(l, spr[sprite_number].pframe);
+      break;
+    }
+    case SPRITE_PROPERTY_picfreeze:
+    {
+      lua_pushboolean(l, spr[sprite_number].picfreeze);
+      break;
+    }
+    case SPRITE_PROPERTY_pseq:
+    {
+      lua_pushinteger(l, spr[sprite_number].pseq);
+      break;
+    }
+    case SPRITE_PROPERTY_que:
+    {
+      lua_pushinteger(l, spr[sprite_number].que);
+      break;
+    }
+    case SPRITE_PROPERTY_range:
+    {
+      lua_pushinteger(l, spr[sprite_number].range);
+      break;
+    }
+    case SPRITE_PROPERTY_reverse:
+    {
+      lua_pushboolean(l, spr[sprite_number].reverse);
+      break;
+    }
+    case SPRITE_PROPERTY_seq:
+    {
+      lua_pushinteger(l, spr[sprite_number].seq);
+      break;
+    }
+    case SPRITE_PROPERTY_size:
+    {
+      lua_pushinteger(l, spr[sprite_number].size);
+      break;
+    }
+    case SPRITE_PROPERTY_sound:
+    {
+      lua_pushinteger(l, spr[sprite_number].sound);
+      break;
+    }
+    case SPRITE_PROPERTY_speed:
+    {
+      lua_pushinteger(l, spr[sprite_number].speed);
+      break;
+    }
+    case SPRITE_PROPERTY_strength:
+    {
+      lua_pushinteger(l, spr[sprite_number].strength);
+      break;
+    }
+    case SPRITE_PROPERTY_target:
+    {
+      if (spr[sprite_number].target > 0)
+        dinklua_push_sprite_object(l, spr[sprite_number].target);
+      else
+        lua_pushnil(l);
+      break;
+    }
+    case SPRITE_PROPERTY_timing:
+    {
+      lua_pushinteger(l, spr[sprite_number].timing);
+      break;
+    }
+    case SPRITE_PROPERTY_touch_damage:
+    {
+      lua_pushinteger(l, spr[sprite_number].touch_damage);
+      break;
+    }
+    case SPRITE_PROPERTY_x:
+    {
+      lua_pushinteger(l, spr[sprite_number].x);
+      break;
+    }
+    case SPRITE_PROPERTY_y:
+    {
+      lua_pushinteger(l, spr[sprite_number].y);
+      break;
+    }
+    case SPRITE_PROPERTY_kill:
+    {
+      lua_pushinteger(l, spr[sprite_number].kill_ttl);
+      break;
+    }
+    case SPRITE_PROPERTY_editor_num:
+    {
+      lua_pushinteger(l, spr[sprite_number].sp_index);
+      break;
+    }
+    case SPRITE_PROPERTY_script:
+    {
+      int script_number = spr[sprite_number].script;
+      if (sinfo[script_number] != NULL)
+        if (sinfo[script_number]->name != NULL)
+          lua_pushstring(l, sinfo[script_number]->name);
+        else
+          lua_pushnil(l);
+      else
+        lua_pushnil(l);
+      break;
+    }
+    case SPRITE_PROPERTY_blood_num:
+    {
+      lua_pushinteger(l, spr[sprite_number].bloodnum);
+      break;
+    }
+    case SPRITE_PROPERTY_blood_seq:
+    {
+      lua_pushinteger(l, spr[sprite_number].bloodseq);
+      break;
+    }
+    case SPRITE_PROPERTY_clip_bottom:
+    {
+      lua_pushinteger(l, spr[sprite_number].alt.bottom);
+      break;
+    }
+    case SPRITE_PROPERTY_clip_left:
+    {
+      lua_pushinteger(l, spr[sprite_number].alt.left);
+      break;
+    }
+    case SPRITE_PROPERTY_clip_right:
+    {
+      lua_pushinteger(l, spr[sprite_number].alt.right);
+      break;
+    }
+    case SPRITE_PROPERTY_clip_top:
+    {
+      lua_pushinteger(l, spr[sprite_number].alt.top);
+      break;
+    }
+    case SPRITE_PROPERTY_freeze:
+    {
+      lua_pushboolean(l, spr[sprite_number].freeze);
+      break;
+    }
+    case SPRITE_PROPERTY_action:
+    {
+      lua_pushinteger(l, spr[sprite_number].action);
+      break;
+    }
+    case SPRITE_PROPERTY_sprite_number:
     {
-      // TODO: Test that this outputs the right information
-      int line = dinklua_get_current_line(l);
-      log_error("🌝[Lua] %s.lua:%d: invalid sequence %d, ignoring",
-                sinfo[current_lua_script]->name, line, seq);
+      lua_pushinteger(l, sprite_number);
+      break;
     }
-    else
+    case SPRITE_PROPERTY_custom:
     {
-      change_sprite_noreturn(sprite_number, seq, &spr[sprite_number].seq);
+      dinklua_push_sprite_custom_object(l, sprite_number);
+      break;
     }
-  }
-  else if (strcmp(sprite_command, "size") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(size);
-
-    int size = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, size, &spr[sprite_number].size);
-  }
-  else if (strcmp(sprite_command, "sound") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(sound);
-
-    int sound = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, sound, &spr[sprite_number].sound);
-
-    if (sound > 0)
+    case SPRITE_PROPERTY_get_speed:
     {
-      sfx_stop_sprite_sound(sprite_number);
-      sfx_play_sprite_sound(spr[sprite_number].sound, sprite_number, 1);
+      if (sprite_number != 1)
+        return dinklua_property_error(l, "Sprites do not have a '%s' property", sprite_command);
+      lua_pushinteger(l, dinkspeed);
+      break;
     }
-    else
-		  sfx_stop_sprite_sound(sprite_number);
-  }
-  else if (strcmp(sprite_command, "speed") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(speed);
-
-    int speed = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, speed, &spr[sprite_number].speed);
-    changedir(spr[sprite_number].dir, sprite_number, spr[sprite_number].base_walk);
-  }
-  else if (strcmp(sprite_command, "strength") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(strength);
-
-    int strength = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, strength, &spr[sprite_number].strength);
-  }
-  else if (strcmp(sprite_command, "target") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(target);
-
-    int target = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, target, &spr[sprite_number].target);
-  }
-  else if (strcmp(sprite_command, "timing") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(timing);
-
-    int timing = lua_tointeger(l, -1);
-    change_sprite(sprite_number, timing, &spr[sprite_number].timing);
-  }
-  else if (strcmp(sprite_command, "touch_damage") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(touch_damage);
-
-    int touch_damage = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, touch_damage, &spr[sprite_number].touch_damage);
-  }
-  else if (strcmp(sprite_command, "x") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(x);
-
-    int x = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, x, &spr[sprite_number].x);
-  }
-  else if (strcmp(sprite_command, "y") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(y);
-
-    int y = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, y, &spr[sprite_number].y);
-  }
-  else if (strcmp(sprite_command, "kill") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(kill);
-
-    int kill = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, kill, &spr[sprite_number].kill_ttl);
-  }
-  else if (strcmp(sprite_command, "editor_num") == 0)
-  {
-    LUA_REPORT_READ_ONLY(editor_num);
-  }
-  else if (strcmp(sprite_command, "script") == 0)
-  {
-    LUA_REPORT_PROPERTY_STRING_ERROR(script);
-
-    const char *script = lua_tostring(l, -1);
-    scripting_sp_script(sprite_number, script);
-  }
-  else if (strcmp(sprite_command, "blood_num") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(blood_num);
-
-    int blood_num = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, blood_num, &spr[sprite_number].bloodnum);
-  }
-  else if (strcmp(sprite_command, "blood_seq") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(blood_seq);
-
-    int blood_seq = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, blood_seq, &spr[sprite_number].bloodseq);
-  }
-  else if (strcmp(sprite_command, "clip_bottom") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(clip_bottom);
-
-    int clip_bottom = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, clip_bottom, &spr[sprite_number].alt.bottom);
-  }
-  else if (strcmp(sprite_command, "clip_left") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(clip_left);
-
-    int clip_left = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, clip_left, &spr[sprite_number].alt.left);
-  }
-  else if (strcmp(sprite_command, "clip_right") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(clip_right);
-
-    int clip_right = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, clip_right, &spr[sprite_number].alt.right);
-  }
-  else if (strcmp(sprite_command, "clip_top") == 0)
-  {
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(clip_top);
-
-    int clip_top = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, clip_top, &spr[sprite_number].alt.top);
-  }
-  else if (strcmp(sprite_command, "freeze") == 0)
-  {
-    LUA_REPORT_PROPERTY_BOOLEAN_ERROR(freeze);
-
-    int freeze = lua_toboolean(l, -1);
-
-    // Set the value
-    if (freeze == 0)
-      spr[sprite_number].freeze = 0;
-    else if (freeze == 1)
-      spr[sprite_number].freeze = current_lua_script;
-  }
-  else if (strcmp(sprite_command, "action") == 0)
-  {
-    //ye: used by sprite brains
-    LUA_REPORT_PROPERTY_NUMBER_ERROR(action);
-
-    int action = lua_tointeger(l, -1);
-    change_sprite_noreturn(sprite_number, action, &spr[sprite_number].action);
-  }
-  else
-  {
-    return luaL_error(l, "Sprites do not have a '%s' property", sprite_command);
-  }
-
-  return 0;
-}
-
-static int dinklua_get_sprite_value(lua_State *l)
-{
-  int sprite_number = lua_tointeger(l, -2);
-  const char* sprite_command = lua_tostring(l, -1);
-
-  log_debug("🌝[Lua] get sprite value %s from sprite %d",
-            sprite_command, sprite_number);
-
-  if (strcmp(sprite_command, "active") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].active);
-  }
-  else if (strcmp(sprite_command, "attack_hit_sound") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].attack_hit_sound);
-  }
-  else if (strcmp(sprite_command, "attack_hit_sound_speed") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].attack_hit_sound_speed);
-  }
-  else if (strcmp(sprite_command, "attack_wait") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].attack_wait);
-  }
-  else if (strcmp(sprite_command, "base_attack") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].base_attack);
-  }
-  else if (strcmp(sprite_command, "base_die") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].base_die);
-  }
-  else if (strcmp(sprite_command, "base_hit") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].base_hit);
-  }
-  else if (strcmp(sprite_command, "base_idle") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].base_idle);
-  }
-  else if (strcmp(sprite_command, "base_walk") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].base_walk);
-  }
-  else if (strcmp(sprite_command, "brain") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].brain);
-  }
-  else if (strcmp(sprite_command, "brain_parm") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].brain_parm);
-  }
-  else if (strcmp(sprite_command, "brain_parm2") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].brain_parm2);
-  }
-  else if (strcmp(sprite_command, "defense") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].defense);
-  }
-  else if (strcmp(sprite_command, "dir") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].dir);
-  }
-  else if (strcmp(sprite_command, "disabled") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].disabled);
-  }
-  else if (strcmp(sprite_command, "distance") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].distance);
-  }
-  else if (strcmp(sprite_command, "exp") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].exp);
-  }
-  else if (strcmp(sprite_command, "flying") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].flying);
-  }
-  else if (strcmp(sprite_command, "follow") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].follow);
-  }
-  else if (strcmp(sprite_command, "frame") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].frame);
-  }
-  else if (strcmp(sprite_command, "frame_delay") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].frame_delay);
-  }
-  else if (strcmp(sprite_command, "gold") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].gold);
-  }
-  else if (strcmp(sprite_command, "hard") == 0)
-  {
-    lua_pushboolean(l, !(bool)spr[sprite_number].hard);
-  }
-  else if (strcmp(sprite_command, "hitpoints") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].hitpoints);
-  }
-  else if (strcmp(sprite_command, "move_nohard") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].move_nohard);
-  }
-  else if (strcmp(sprite_command, "mx") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].mx);
-  }
-  else if (strcmp(sprite_command, "my") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].my);
-  }
-  else if (strcmp(sprite_command, "noclip") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].noclip);
-  }
-  else if (strcmp(sprite_command, "nocontrol") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].nocontrol);
-  }
-  else if (strcmp(sprite_command, "nodraw") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].nodraw);
-  }
-  else if (strcmp(sprite_command, "nohit") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].nohit);
-  }
-  else if (strcmp(sprite_command, "notouch") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].notouch);
-  }
-  else if (strcmp(sprite_command, "pframe") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].pframe);
-  }
-  else if (strcmp(sprite_command, "picfreeze") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].picfreeze);
-  }
-  else if (strcmp(sprite_command, "pseq") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].pseq);
-  }
-  else if ((strcmp(sprite_command, "que") == 0) || (strcmp(sprite_command, "cue") == 0))
-  {
-    lua_pushinteger(l, spr[sprite_number].que);
-  }
-  else if (strcmp(sprite_command, "range") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].range);
-  }
-  else if (strcmp(sprite_command, "reverse") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].reverse);
-  }
-  else if (strcmp(sprite_command, "seq") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].seq);
-  }
-  else if (strcmp(sprite_command, "size") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].size);
-  }
-  else if (strcmp(sprite_command, "sound") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].sound);
-  }
-  else if (strcmp(sprite_command, "speed") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].speed);
-  }
-  else if (strcmp(sprite_command, "strength") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].strength);
-  }
-  else if (strcmp(sprite_command, "target") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].target);
-  }
-  else if (strcmp(sprite_command, "timing") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].timing);
-  }
-  else if (strcmp(sprite_command, "touch_damage") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].touch_damage);
-  }
-  else if (strcmp(sprite_command, "x") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].x);
-  }
-  else if (strcmp(sprite_command, "y") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].y);
-  }
-  else if (strcmp(sprite_command, "kill") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].kill_ttl);
-  }
-  else if (strcmp(sprite_command, "editor_num") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].sp_index);
-  }
-  else if (strcmp(sprite_command, "script") == 0)
-  {
-    int script_number = spr[sprite_number].script;
-    if (sinfo[script_number] != NULL)
-      if (sinfo[script_number]->name != NULL)
-        lua_pushstring(l, sinfo[script_number]->name);
-      else
-        lua_pushnil(l);
-    else
-      lua_pushnil(l);
-  }
-  else if (strcmp(sprite_command, "blood_num") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].bloodnum);
-  }
-  else if (strcmp(sprite_command, "blood_seq") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].bloodseq);
-  }
-  else if (strcmp(sprite_command, "clip_bottom") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].alt.bottom);
-  }
-  else if (strcmp(sprite_command, "clip_left") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].alt.left);
-  }
-  else if (strcmp(sprite_command, "clip_right") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].alt.right);
-  }
-  else if (strcmp(sprite_command, "clip_top") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].alt.top);
-  }
-  else if (strcmp(sprite_command, "freeze") == 0)
-  {
-    lua_pushboolean(l, spr[sprite_number].freeze);
-  }
-  else if (strcmp(sprite_command, "action") == 0)
-  {
-    lua_pushinteger(l, spr[sprite_number].action);
-  }
-  else
-  {
-    return luaL_error(l, "Sprites do not have a '%s' property", sprite_command);
+    case SPRITE_PROPERTY_set_speed:
+    {
+      // Method, called as player:set_speed(speed)
+      if (sprite_number != 1)
+        return dinklua_property_error(l, "Sprites do not have a '%s' property", sprite_command);
+      lua_pushcfunction(l, dinklua_dink_object_set_speed);
+      break;
+    }
+    default:
+      return dinklua_property_error(l, "Sprites do not have a '%s' property", sprite_command);
   }
 
   return 1;
@@ -2481,16 +2746,13 @@ static int dinklua_sp_custom(lua_State *l)
     }
     else
     {
-    if (spr[sprite].custom->find(key) == spr[sprite].custom->end())
-			spr[sprite].custom->insert(std::make_pair(key, 0));
+      int* value = sp_custom_get(&spr[sprite].custom, sp_custom_intern(key));
 
-		// Set the value
-		if (val != -1) {
-			spr[sprite].custom->erase(key);
-			spr[sprite].custom->insert(std::make_pair(key, val));
-		}
+      // Set the value
+      if (val != -1)
+        *value = val;
 
-      lua_pushinteger(l, spr[sprite].custom->find(key)->second);
+      lua_pushinteger(l, *value);
       return 1;
     }
   }
@@ -2966,6 +3228,195 @@ static int dinklua_engine_find_script(lua_State *l)
   return 1;
 }
 
+/* Sprite objects are a userdata holding the sprite number, answering
+   sprite.x and the like through the C metamethods below. Methods
+   (kill_wait, say_stop, ...) are Lua functions that init.lua stores
+   once in sprite_metatable.methods; a few computed properties
+   (editor_sprite, busy, ...) live in sprite_metatable.getters. */
+
+static int sprite_metatable_ref = LUA_NOREF;
+static int sprite_custom_metatable_ref = LUA_NOREF;
+static int sprite_objects_ref = LUA_NOREF;
+static int sprite_custom_objects_ref = LUA_NOREF;
+
+/* The same object is handed out for a sprite for as long as a script
+   holds on to it */
+static void push_cached_object(lua_State *l, int sprite_number,
+                               int cache_ref, int metatable_ref)
+{
+  lua_rawgeti(l, LUA_REGISTRYINDEX, cache_ref);
+  if (lua_rawgeti(l, -1, sprite_number) == LUA_TNIL)
+  {
+    lua_pop(l, 1);
+    int *object = (int*)lua_newuserdatauv(l, sizeof(int), 0);
+    *object = sprite_number;
+    lua_rawgeti(l, LUA_REGISTRYINDEX, metatable_ref);
+    lua_setmetatable(l, -2);
+    lua_pushvalue(l, -1);
+    lua_rawseti(l, -3, sprite_number);
+  }
+  lua_remove(l, -2);
+}
+
+static void dinklua_push_sprite_object(lua_State *l, int sprite_number)
+{
+  push_cached_object(l, sprite_number, sprite_objects_ref, sprite_metatable_ref);
+}
+
+static void dinklua_push_sprite_custom_object(lua_State *l, int sprite_number)
+{
+  push_cached_object(l, sprite_number, sprite_custom_objects_ref, sprite_custom_metatable_ref);
+}
+
+/* Sprite number of the sprite object at 'idx', or -1 if it isn't one */
+static int dinklua_to_sprite_object(lua_State *l, int idx)
+{
+  int *object = (int*)lua_touserdata(l, idx);
+  if (object == NULL || !lua_getmetatable(l, idx))
+    return -1;
+  lua_rawgeti(l, LUA_REGISTRYINDEX, sprite_metatable_ref);
+  int is_sprite = lua_rawequal(l, -1, -2);
+  lua_pop(l, 2);
+  return is_sprite ? *object : -1;
+}
+
+/* Property of the key at index 2, from the name table in the first
+   upvalue */
+static int sprite_property_lookup(lua_State *l)
+{
+  lua_pushvalue(l, 2);
+  lua_rawget(l, lua_upvalueindex(1));
+  int property = lua_tointeger(l, -1); // nil gives SPRITE_PROPERTY_NONE
+  lua_pop(l, 1);
+  return property;
+}
+
+static int dinklua_sprite_object_index(lua_State *l)
+{
+  int sprite_number = *(int*)lua_touserdata(l, 1);
+
+  // Methods first: 'freeze' is both a method and a property
+  lua_pushvalue(l, 2);
+  if (lua_rawget(l, lua_upvalueindex(2)) != LUA_TNIL)
+    return 1;
+  lua_pop(l, 1);
+
+  int property = sprite_property_lookup(l);
+  if (property != SPRITE_PROPERTY_NONE)
+    return dinklua_get_sprite_property(l, sprite_number, property, lua_tostring(l, 2));
+
+  lua_pushvalue(l, 2);
+  if (lua_rawget(l, lua_upvalueindex(3)) != LUA_TNIL)
+  {
+    lua_pushvalue(l, 1);
+    lua_call(l, 1, 1);
+    return 1;
+  }
+
+  return dinklua_property_error(l, "Sprites do not have a '%s' property", lua_tostring(l, 2));
+}
+
+static int dinklua_sprite_object_newindex(lua_State *l)
+{
+  int sprite_number = *(int*)lua_touserdata(l, 1);
+  int property = sprite_property_lookup(l);
+  return dinklua_set_sprite_property(l, sprite_number, property, lua_tostring(l, 2));
+}
+
+static int dinklua_sprite_object_tostring(lua_State *l)
+{
+  lua_pushfstring(l, "sprite %d", *(int*)lua_touserdata(l, 1));
+  return 1;
+}
+
+/* sprite.custom["whatnot"] = 5, or sprite.custom.whatnot = 5 */
+static int dinklua_sprite_custom_object_index(lua_State *l)
+{
+  lua_pushinteger(l, *(int*)lua_touserdata(l, 1));
+  lua_replace(l, 1);
+  lua_pushinteger(l, -1);
+  return dinklua_sp_custom(l);
+}
+
+static int dinklua_sprite_custom_object_newindex(lua_State *l)
+{
+  lua_pushinteger(l, *(int*)lua_touserdata(l, 1));
+  lua_replace(l, 1);
+  dinklua_sp_custom(l);
+  return 0;
+}
+
+static int dinklua_get_sprite_object(lua_State *l)
+{
+  dinklua_push_sprite_object(l, lua_tointeger(l, -1));
+  return 1;
+}
+
+static int new_object_cache(lua_State *l)
+{
+  lua_newtable(l);
+  lua_createtable(l, 0, 1);
+  lua_pushstring(l, "v");
+  lua_setfield(l, -2, "__mode");
+  lua_setmetatable(l, -2);
+  return luaL_ref(l, LUA_REGISTRYINDEX);
+}
+
+static void dinklua_sprite_object_init(lua_State *l)
+{
+  int nb_names = sizeof(sprite_property_names) / sizeof(sprite_property_names[0]);
+  lua_createtable(l, 0, nb_names);
+  for (int i = 0; i < nb_names; i++)
+  {
+    lua_pushinteger(l, sprite_property_names[i].property);
+    lua_setfield(l, -2, sprite_property_names[i].name);
+  }
+  int properties = lua_gettop(l);
+
+  luaL_newmetatable(l, "sprite");
+  int metatable = lua_gettop(l);
+  lua_newtable(l);
+  int methods = lua_gettop(l);
+  lua_newtable(l);
+  int getters = lua_gettop(l);
+  lua_pushvalue(l, methods);
+  lua_setfield(l, metatable, "methods");
+  lua_pushvalue(l, getters);
+  lua_setfield(l, metatable, "getters");
+
+  lua_pushvalue(l, properties);
+  lua_pushvalue(l, methods);
+  lua_pushvalue(l, getters);
+  lua_pushcclosure(l, dinklua_sprite_object_index, 3);
+  lua_setfield(l, metatable, "__index");
+  lua_pushvalue(l, properties);
+  lua_pushcclosure(l, dinklua_sprite_object_newindex, 1);
+  lua_setfield(l, metatable, "__newindex");
+  lua_pushcfunction(l, dinklua_sprite_object_tostring);
+  lua_setfield(l, metatable, "__tostring");
+  lua_pushboolean(l, 0);
+  lua_setfield(l, metatable, "__metatable");
+
+  // init.lua fills in the methods and recognizes sprites with it
+  lua_pushvalue(l, metatable);
+  lua_setglobal(l, "sprite_metatable");
+  lua_pushvalue(l, metatable);
+  sprite_metatable_ref = luaL_ref(l, LUA_REGISTRYINDEX);
+  lua_settop(l, properties - 1);
+
+  luaL_newmetatable(l, "sprite_custom");
+  lua_pushcfunction(l, dinklua_sprite_custom_object_index);
+  lua_setfield(l, -2, "__index");
+  lua_pushcfunction(l, dinklua_sprite_custom_object_newindex);
+  lua_setfield(l, -2, "__newindex");
+  lua_pushboolean(l, 0);
+  lua_setfield(l, -2, "__metatable");
+  sprite_custom_metatable_ref = luaL_ref(l, LUA_REGISTRYINDEX);
+
+  sprite_objects_ref = new_object_cache(l);
+  sprite_custom_objects_ref = new_object_cache(l);
+}
+
 void dinklua_bind_init()
 {
   luaL_Reg dink_funcs[] =
@@ -3247,8 +3698,7 @@ void dinklua_bind_init()
 
   luaL_Reg object_funcs[] =
   {
-    LUAREG(set_sprite_value),
-    LUAREG(get_sprite_value),
+    LUAREG(get_sprite_object),
     LUAREG(sprite_object_kill_wait),
     LUAREG(sprite_object_freeze),
     LUAREG(sprite_object_unfreeze),
@@ -3292,6 +3742,7 @@ void dinklua_bind_init()
   };
   luaL_newlib(luaVM, object_funcs);
   lua_setglobal(luaVM, "object");
+  dinklua_sprite_object_init(luaVM);
 
   luaL_Reg choice_menu_funcs[] =
   {
@@ -34,6 +34,10 @@
 #include "sfx.h"
 #include "log.h"
 #include "paths.h"
+#include "map_view.h"
+
+/* Bumped whenever a screen is written back to map.dat */
+int save_screen_count = 0;
 
 /**
  * Return hardness index for this screen tile, either its default
@@ -84,6 +88,17 @@ void screen_rank_editor_sprites(int* rank) {
  */
 int load_screen_to(const char* path, const int num,
 				struct editor_screen* screen) {
+	if (map_view_load_screen(path, num, screen) == 0)
+		return 0;
+	/* Not mappable, or a truncated map.dat */
+	return load_screen_stdio(path, num, screen);
+}
+
+/**
+ * Same as load_screen_to(), reading the screen field by field
+ */
+int load_screen_stdio(const char* path, const int num,
+				struct editor_screen* screen) {
 	char skipbuf[10000]; // more than any fseek we do
 
 	FILE* f = NULL;
@@ -302,6 +317,8 @@ void save_screen(const char* path, const int num) {
 		// offset 31280
 
 		fclose(f);
+		map_view_forget();
+		save_screen_count++;
 	}
 
 	log_info("💾 Done saving screen data..");
@@ -73,7 +73,10 @@ struct editor_screen {
 
 extern int load_screen_to(const char* path, const int num,
 						struct editor_screen* screen);
+extern int load_screen_stdio(const char* path, const int num,
+						struct editor_screen* screen);
 extern void save_screen(const char* path, const int num);
+extern int save_screen_count;
 extern void screen_rank_editor_sprites(int rank[]);
 extern int realhard(int tile);
 
@@ -28,249 +28,219 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-
-#ifdef _WIN32
-#include <windows.h>
-#include <io.h>
-/* #define strcasecmp(a,b) stricmp(a,b) */
-#else
-#include <unistd.h>
-#ifdef HAVE_MMAP
-#include <sys/mman.h>
-#endif
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#endif
-#include "str_util.h"
+#include <ctype.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SDL.h"
+#include "fastfile.h"
 #include "io_util.h"
-extern void FastFileFini(void);
+
+/**
+ * dir.ff archives are mapped the first time a sequence is read from
+ * them, and stay mapped until FastFileRegistryClear(). Each archive
+ * keeps a case-insensitive hash of its entry names. The mappings are
+ * shared by FF_Reader handles, which only hold a reference: several
+ * threads can decode from the same archive at once.
+ */
 
 #define HEADER_NB_ENTRIES_LEN 4
+#define ENTRY_LEN (4 + 13)
+#define ENTRY_NAME_LEN 13
 
 struct FF_Entry {
-	unsigned long off;
-	char name[13];
-};
-
-struct FF_Handle {
-	int alive;
-	unsigned long pos, off, len;
+	unsigned long off, len;
 };
 
-static struct FF_Entry* g_Entries = NULL;
-static struct FF_Handle* g_Handles = NULL;
-
-static unsigned int g_FileSize = 0;
-static unsigned int g_numEntries = 0;
-static unsigned int g_numHandles = 0;
-
-#ifdef HAVE_MMAP
-static int g_File = 0;
-#else
-#ifdef _WIN32
-HANDLE g_File; /* HANDLE == void*, cf. winnt.h */
-HANDLE g_FileMap;
-#else
-FILE* g_File = NULL;
-#endif
-#endif
-
-#if defined HAVE_MMAP || defined _WIN32
-unsigned char* g_MemMap = NULL;
-#endif
-
-int FastFileInit(char* filename, int max_handles) {
-	unsigned long count = 0;
-	FastFileFini();
-
-#if _WIN32 | HAVE_MMAP
-	unsigned char* buf = NULL;
-#endif
-
-#ifdef HAVE_MMAP
-	/* Open and mmap the file (Unix) */
-	g_File = open(filename, O_RDONLY);
-	if (g_File < 0)
-		return 0 /*false*/;
-	g_FileSize = lseek(g_File, 0, SEEK_END); /* needed by munmap */
-	lseek(g_File, 0, SEEK_SET);
+struct FF_Archive {
+	const unsigned char* data;
+	size_t size;
+	/* Lowercase entry name -> entry */
+	std::unordered_map<std::string, struct FF_Entry> index;
 
-	g_MemMap = mmap(NULL, g_FileSize, PROT_READ, MAP_PRIVATE, g_File, 0);
-#else
-#ifdef _WIN32
-	/* Open and mmap the file (Windows) */
-
-	/* first: file size (for later sanity checks) */
-	FILE* t = fopen(filename, "rb");
-	if (t == NULL)
-		return FALSE;
-	fseek(t, 0, SEEK_END);
-	g_FileSize = ftell(t);
-	fseek(t, 0, SEEK_SET);
-	fclose(t);
-
-	g_File = CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
-						OPEN_EXISTING, FILE_ANY_ACCESS, 0);
-	if (g_File == NULL)
-		return FALSE;
-
-	g_FileMap = CreateFileMapping(g_File, NULL, PAGE_READONLY, 0, 0, NULL);
-	g_MemMap = (unsigned char*)MapViewOfFile(g_FileMap, FILE_MAP_READ, 0, 0, 0);
-#else
-	/* C stdio (portable) */
-	g_File = fopen(filename, "rb");
-	if (g_File == NULL)
-		return 0 /*false*/;
-
-	fseek(g_File, 0, SEEK_END);
-	g_FileSize = ftell(g_File);
-	fseek(g_File, 0, SEEK_SET);
-#endif
-#endif
+	~FF_Archive() {
+		unmap_file(data, size);
+	}
+};
 
-	g_numHandles = max_handles;
-	/* Get the number of entries (from stored LSB int32) */
-#if defined HAVE_MMAP || defined _WIN32
-	buf = g_MemMap;
-	g_numEntries = (buf[3] << 24) | (buf[2] << 16) | (buf[1] << 8) | (buf[0]);
-	buf += 4;
-#else
-	g_numEntries = read_lsb_int(g_File);
-#endif
+struct FF_Reader {
+	std::shared_ptr<struct FF_Archive> archive;
+};
 
-	/* Allocate the memory */
-	g_Entries = (FF_Entry*)calloc(sizeof(struct FF_Entry), g_numEntries);
-	g_Handles = (FF_Handle*)calloc(sizeof(struct FF_Handle), max_handles);
+static std::mutex registry_mutex;
+static std::unordered_map<std::string, std::shared_ptr<struct FF_Archive>> registry;
+static struct fastfile_stats stats;
 
-	for (count = 0; count < g_numEntries; count++) {
-#if defined HAVE_MMAP || defined _WIN32
-		g_Entries[count].off =
-				(buf[3] << 24) | (buf[2] << 16) | (buf[1] << 8) | (buf[0]);
-		buf += 4;
-		strncpy(g_Entries[count].name, (char*)buf, 13);
-		buf += 13;
-#else
-		g_Entries[count].off = read_lsb_int(g_File);
-		fread(g_Entries[count].name, 13, 1, g_File);
-#endif
-		/* Ensure string is null-terminated */
-		g_Entries[count].name[12] = '\0';
+/**
+ * Lowercase 'name' into 'key'. Returns 0 if it's too long to be in a
+ * dir.ff index.
+ */
+static int ff_key(const char* name, char key[ENTRY_NAME_LEN]) {
+	int i;
+	for (i = 0; name[i] != '\0'; i++) {
+		if (i == ENTRY_NAME_LEN - 1)
+			return 0;
+		key[i] = tolower((unsigned char)name[i]);
 	}
-
+	key[i] = '\0';
 	return 1;
 }
 
-void FastFileFini(void) {
-	if (g_Entries != NULL) {
-		free(g_Entries);
-		g_Entries = NULL;
-	}
-	if (g_Handles != NULL) {
-		free(g_Handles);
-		g_Handles = NULL;
-	}
+/**
+ * Map 'filename' and index its entries. Returns NULL if it can't be
+ * read or its header is corrupted.
+ */
+static struct FF_Archive* ff_archive_open(const char* filename) {
+	size_t size = 0;
+	const unsigned char* data = map_file(filename, &size);
+	if (data == NULL)
+		return NULL;
 
-#ifdef HAVE_MMAP
-	/* Unmap and close the file (Unix) */
-	if (g_MemMap != NULL) {
-		munmap(g_MemMap, g_FileSize);
-		g_MemMap = NULL;
-	}
-	if (g_File != 0) {
-		close(g_File);
-		g_File = 0;
+	int num_entries = 0;
+	if (size >= HEADER_NB_ENTRIES_LEN)
+		decode_lsb_ints(data, &num_entries, 1);
+	/* Don't trust a corrupted header */
+	if (size < HEADER_NB_ENTRIES_LEN || num_entries < 0
+		|| (size_t)num_entries > (size - HEADER_NB_ENTRIES_LEN) / ENTRY_LEN) {
+		unmap_file(data, size);
+		return NULL;
 	}
-#else
-#ifdef _WIN32
-	if (g_MemMap != NULL) {
-		/* Unmap and close the file (Windows) */
-		CloseHandle(g_FileMap);
-		CloseHandle(g_File);
-		g_MemMap = NULL;
+
+	struct FF_Archive* a = new struct FF_Archive;
+	a->data = data;
+	a->size = size;
+
+	/* Offsets first: an entry's length depends on the next ones. One
+	past the end reads as 0, like a bogus trailing entry would. */
+	const unsigned char* entries = data + HEADER_NB_ENTRIES_LEN;
+	std::vector<unsigned long> offs(num_entries + 1, 0);
+	for (int i = 0; i < num_entries; i++) {
+		int off;
+		decode_lsb_ints(entries + i * ENTRY_LEN, &off, 1);
+		offs[i] = (unsigned int)off;
 	}
-#else
-	if (g_File != NULL) {
-		fclose(g_File);
-		g_File = NULL;
+
+	/* The last entry only marks the end of the data. Only the first
+	of several entries with the same name can be reached. */
+	a->index.reserve(num_entries);
+	for (int i = 0; i < num_entries - 1; i++) {
+		char name[ENTRY_NAME_LEN], key[ENTRY_NAME_LEN];
+		memcpy(name, entries + i * ENTRY_LEN + 4, ENTRY_NAME_LEN);
+		/* Ensure string is null-terminated */
+		name[ENTRY_NAME_LEN - 1] = '\0';
+		ff_key(name, key);
+
+		struct FF_Entry entry;
+		entry.off = offs[i];
+		/* Normal offset, tells where next the image bytes start */
+		unsigned long next_off = offs[i + 1];
+		if (next_off == 0)
+			/* Support badly generated dir.ff such as Mystery
+			Island's (skip 1 empty entry) */
+			next_off = offs[i + 2];
+		/* Watch for buffer overflows - check that 'off' is in a
+		reasonable range [0, len(file)], and doesn't overlap
+		another fastfile */
+		if (entry.off > size || entry.off > next_off)
+			entry.len = 0;
+		else
+			entry.len = next_off - entry.off;
+		a->index.emplace(key, entry);
 	}
-#endif
-#endif
+	return a;
 }
 
-void* FastFileOpen(char* name) {
-	struct FF_Handle* i;
-	long fCount;
-	long hCount;
-
-	/* Check for the file, don't include directory */
-	for (fCount = 0; fCount < (long)g_numEntries - 1; fCount++) {
-		if (strcasecmp(g_Entries[fCount].name, name) == 0) {
-			for (hCount = 0; hCount < (long)g_numHandles; hCount++) {
-				i = &g_Handles[hCount];
-
-				if (!i->alive) {
-					i->alive = 1;
-					i->off = g_Entries[fCount].off;
-					i->pos = 0;
-					/* Normal offset, tells where next the image bytes
-		start */
-					unsigned long next_off = g_Entries[fCount + 1].off;
-					if (next_off == 0)
-						/* Support badly generated dir.ff such as Mystery
-		Island's (skip 1 empty entry) */
-						/* TODO: check that fCount+2 is valid. */
-						next_off = g_Entries[fCount + 2].off;
-					/* Watch for buffer overflows - check that 'off' is
-		in a reasonable range [0, len(file)], and doesn't
-		overlap another fastfile */
-					if ((i->off < 0 || i->off > g_FileSize) ||
-						i->off > next_off)
-						i->len = 0;
-					else
-						i->len = next_off - i->off;
-					return (void*)i;
-				}
+/**
+ * Open a handle on the dir.ff at 'filename', mapping it if no other
+ * handle did already. Handles are independent: use one per thread.
+ */
+struct FF_Reader* FastFileReaderOpen(const char* filename) {
+	std::shared_ptr<struct FF_Archive> archive;
+	{
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		stats.opens++;
+		auto it = registry.find(filename);
+		if (it != registry.end()) {
+			archive = it->second;
+		} else {
+			archive.reset(ff_archive_open(filename));
+			/* Remember missing archives too, the sequences of a
+			directory are looked up one by one */
+			registry.emplace(filename, archive);
+			stats.parses++;
+			if (archive != nullptr) {
+				stats.archives++;
+				stats.bytes += archive->size;
 			}
-			return NULL;
 		}
 	}
-	return NULL;
+	if (archive == nullptr)
+		return NULL;
+	struct FF_Reader* r = new struct FF_Reader;
+	r->archive = archive;
+	return r;
 }
 
-int FastFileClose(struct FF_Handle* i) {
-	if (!i)
-		return 0;
+static const struct FF_Entry* ff_lookup(struct FF_Reader* r, const char* name) {
+	char key[ENTRY_NAME_LEN];
+	if (!ff_key(name, key))
+		return NULL;
+	auto it = r->archive->index.find(key);
+	if (it == r->archive->index.end())
+		return NULL;
+	return &it->second;
+}
 
-#if defined HAVE_MMAP || defined _WIN32
-	if (!g_MemMap)
-		return 0;
-#endif
+/**
+ * Is 'name' in the archive's index?
+ */
+int FastFileReaderHas(struct FF_Reader* r, const char* name) {
+	return ff_lookup(r, name) != NULL;
+}
 
-	i->alive = 0;
+/**
+ * Read 'name' from the archive. Return 0 if it's not in the index,
+ * otherwise set 'rw' (NULL on error). The SDL_RWops points into the
+ * mapping, and stays valid until the handle is closed.
+ */
+int FastFileReaderGet(struct FF_Reader* r, const char* name, SDL_RWops** rw) {
+	const struct FF_Entry* entry = ff_lookup(r, name);
+	if (entry == NULL)
+		return 0;
+	size_t size = r->archive->size;
+	unsigned long off = entry->off;
+	unsigned long len = entry->len;
+	/* Read up to the end of the archive when the index gives an
+	inconsistent length */
+	if (len == 0 && off < size)
+		len = size - off;
+	if (off > size)
+		off = size;
+	if (len > size - off)
+		len = size - off;
+	*rw = SDL_RWFromConstMem(r->archive->data + off, len);
 	return 1;
 }
 
-SDL_RWops* FastFileLock(struct FF_Handle* i) {
-	if (!i)
-		return NULL;
-
-#if defined HAVE_MMAP || defined _WIN32
-	char* buffer = NULL;
-	if (!g_MemMap)
-		return NULL;
-#endif
+void FastFileReaderClose(struct FF_Reader* r) {
+	delete r;
+}
 
-#if defined HAVE_MMAP || defined _WIN32
-	buffer = (char*)g_MemMap;
-	buffer += i->off;
-	return SDL_RWFromMem(buffer, i->len);
-#else
-	fseek(g_File, i->off, SEEK_SET);
-	return SDL_RWFromFP(g_File, /*autoclose=*/SDL_FALSE);
-#endif
+/**
+ * Forget every archive. Mappings still used by a handle are released
+ * when it's closed.
+ */
+void FastFileRegistryClear(void) {
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	registry.clear();
+	stats.archives = 0;
+	stats.bytes = 0;
 }
 
-int FastFileLen(struct FF_Handle* i) {
-	return i->len;
+void FastFileGetStats(struct fastfile_stats* out) {
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	*out = stats;
 }
@@ -24,13 +24,22 @@
 #ifndef _FASTFILE_H
 #define _FASTFILE_H
 
-struct FF_Handle;
-
-extern int FastFileInit(char* filename, int max_handles);
-extern void FastFileFini(void);
-extern struct FF_Handle* FastFileOpen(char* name);
-extern int FastFileClose(struct FF_Handle* pfe);
-extern SDL_RWops* FastFileLock(struct FF_Handle* pfe);
-extern int FastFileLen(void* i);
+/* Handle on a dir.ff archive, see fastfile.cpp */
+struct FF_Reader;
+
+extern struct FF_Reader* FastFileReaderOpen(const char* filename);
+extern int FastFileReaderHas(struct FF_Reader* r, const char* name);
+extern int FastFileReaderGet(struct FF_Reader* r, const char* name, SDL_RWops** rw);
+extern void FastFileReaderClose(struct FF_Reader* r);
+
+struct fastfile_stats {
+	unsigned int opens; // handles opened
+	unsigned int parses; // archives looked for on disk
+	unsigned int archives; // archives currently mapped
+	unsigned long long bytes;
+};
+
+extern void FastFileRegistryClear(void);
+extern void FastFileGetStats(struct fastfile_stats* stats);
 
 #endif
@@ -54,6 +54,7 @@
 #include "game_engine.h"
 #include "live_sprites_manager.h"
 #include "live_screen.h"
+#include "live_sprites_grid.h"
 #include "DMod.h"
 #include "meminfo.h"
 #include "dinkc_console.h"
@@ -62,6 +63,7 @@
 #include "savegame.h"
 #include "debug_imgui.h"
 #include "debug.h"
+#include "profiler.h"
 
 using tweeny::easing;
 using Random = effolkronium::random_static;
@@ -89,6 +91,7 @@ auto palcycle = tweeny::from(256).to(0).via(easing::quarticOut).during(400);
  * Returns 0 = can pass, <>0 = should be blocked
  */
 int check_if_move_is_legal(int u) {
+	prof_scope prof(PROF_MOVE);
 	if ((dversion >=
 		108) /* move_nohard is active for all movements, not just active moves */
 		|| (/* dversion == 107 && */ spr[u].move_active))
@@ -538,12 +541,45 @@ int hurt_thing(int h, int damage, int special) {
  * Check which sprites are affected by an attack from 'h', the
  * attacker.
  */
+/* Upper bound of the box inflation done in run_through_tag_list(),
+   whatever the attacker direction */
+static int tag_list_margin(int range) {
+	long r = labs(range);
+	if (r > 100000)
+		r = 100000;
+	return 60 + r + r / 6 + r / 8;
+}
+
+static int tag_list_candidates(int h, int after, int* out) {
+	if ((debug_mode && debug_hitboxsquares) || debug_pausetag)
+		return sprites_grid_all(after, out);
+	return sprites_grid_query(spr[h].x, spr[h].y, tag_list_margin(spr[h].range),
+							after, out);
+}
+
 void run_through_tag_list(int h, int strength) {
 	rect box;
 	int amount, amounty;
-	int i;
+	int i = 0;
+
+	/* Only visit sprites near the attacker, in the same order as the
+	   original 1..last_sprite_created scan; HIT procs may move or
+	   create sprites, in which case the candidates are fetched again */
+	int candidates[MAX_SPRITES_AT_ONCE];
+	int nb_candidates = 0, c = 0;
+	unsigned int generation = sprites_grid_generation() - 1;
+	for (;;) {
+		if (generation != sprites_grid_generation()) {
+			generation = sprites_grid_generation();
+			nb_candidates = tag_list_candidates(h, i, candidates);
+			c = 0;
+		}
+		if (c >= nb_candidates)
+			break;
+		i = candidates[c++];
+		if (i > last_sprite_created)
+			break;
 
-	for (i = 1; i <= last_sprite_created; i++) {
 		if (spr[i].active)
 			if (i != h)
 				if (!((spr[i].nohit == 1) && (spr[i].script == 0))) {
@@ -706,11 +742,36 @@ void run_through_tag_list(int h, int strength) {
 	}
 }
 
+/* A sprite with notouch stops at the first damaging sprite whatever
+   its position, so only use the grid when that can't happen */
+static int touch_damage_candidates(int h, int after, int* out, bool* all) {
+	*all = spr[h].notouch || (debug_mode && dbg.debug_pinksquares);
+	if (*all)
+		return sprites_grid_all(after, out);
+	return sprites_grid_query(spr[h].x, spr[h].y, 2, after, out);
+}
+
 void run_through_touch_damage_list(int h) {
 	rect box;
-	int i;
+	int i = 0;
+
+	int candidates[MAX_SPRITES_AT_ONCE];
+	int nb_candidates = 0, c = 0;
+	unsigned int generation = sprites_grid_generation() - 1;
+	bool all = false;
+	for (;;) {
+		/* getting hurt sets notouch, switch to the full scan */
+		if (generation != sprites_grid_generation() || (!all && spr[h].notouch)) {
+			generation = sprites_grid_generation();
+			nb_candidates = touch_damage_candidates(h, i, candidates, &all);
+			c = 0;
+		}
+		if (c >= nb_candidates)
+			break;
+		i = candidates[c++];
+		if (i > last_sprite_created)
+			break;
 
-	for (i = 1; i <= last_sprite_created; i++) {
 		if (spr[i].active)
 			if (i != h)
 				if ((spr[i].touch_damage != 0)) {
@@ -48,6 +48,7 @@
 #include "gfx_sprites.h"
 #include "hardness_tiles.h"
 #include "savegame.h"
+#include "screen_prefetch.h"
 #include "meminfo.h"
 //#include "dinkc.h"
 //#include "dinkc_bindings.h"
@@ -56,6 +57,9 @@
 #include "status.h"
 #include "debug_imgui.h"
 #include "debug.h"
+#include "random.hpp"
+
+using Random = effolkronium::random_static;
 
 int dversion = 108;
 //For get client fork, to determine which engine is running. Please increment if you fork.
@@ -130,6 +134,7 @@ void game_restart() {
 
 	/* Reset all game state */
 	memset(&play, 0, sizeof(play));
+	var_index_rebuild();
 
 	//ye: dinklua clear volatile table
 	if (dinklua_enabled)
@@ -194,6 +199,58 @@ void game_compute_speed() {
 	spr[1].speed = new_dinkspeed;
 }
 
+/* Deterministic runs (benchmarks, input replays): a clock that only
+moves when told to, and a fixed random seed */
+static /*bool*/ int fixed_clock = 0;
+static Uint64 fixed_tick_step = 0;
+static Uint64 fixed_ticks = 0;
+static /*bool*/ int fixed_seed = 0;
+
+/**
+ * Make game_GetTicks() advance 'step' ms per game_advance_fixed_ticks()
+ * instead of following the wall clock. 0 restores the wall clock.
+ */
+void game_set_fixed_tick_step(Uint64 step) {
+	fixed_clock = (step > 0);
+	fixed_tick_step = step;
+	/* Start where SDL's clock would roughly be, 0 means unset below */
+	fixed_ticks = 1000;
+}
+
+void game_advance_fixed_ticks() {
+	fixed_ticks += fixed_tick_step;
+}
+
+/**
+ * Stop following the wall clock, starting at 'start' ms; time then
+ * moves by game_advance_fixed_ticks_by() only
+ */
+void game_start_fixed_clock(Uint64 start) {
+	fixed_clock = 1;
+	fixed_tick_step = 0;
+	fixed_ticks = start;
+}
+
+void game_advance_fixed_ticks_by(Uint64 delta) {
+	fixed_ticks += delta;
+}
+
+/**
+ * Seed both the C and the C++ random generators, and keep game_init()
+ * from reseeding them with the time of day
+ */
+void game_seed_random(unsigned int seed) {
+	srand(seed);
+	Random::seed(seed);
+	fixed_seed = 1;
+}
+
+static Uint64 game_clock() {
+	if (fixed_clock)
+		return fixed_ticks;
+	return SDL_GetTicks64();
+}
+
 /**
  * Fake SDL_GetTicks if the player is in high-speed mode.  Make sure
  * you call it once per frame.
@@ -204,10 +261,10 @@ Uint64 game_GetTicks() {
 	static Uint64 pause_ticks = 0;
 
 	if (pauseTickCount > 0) {
-		pause_ticks = SDL_GetTicks64() - pauseTickCount;
+		pause_ticks = game_clock() - pauseTickCount;
 	}
 
-	Uint64 cur_sdl_ticks = SDL_GetTicks64() - pause_ticks;
+	Uint64 cur_sdl_ticks = game_clock() - pause_ticks;
 	pauseTickCount = 0;
 	/* Work-around incorrect initial value */
 	if (last_sdl_ticks == 0)
@@ -420,7 +477,8 @@ int game_load_screen(int mapdat_num) {
 	if (g_dmod.map.ts_loc_mem[mapdat_num] != NULL && mapdat_num < 768) {
 		//log_error("mapdat num is %i, size %i", mapdat_num, sizeof(g_dmod.map.ts_loc_mem[mapdat_num]));
 		memcpy(&cur_ed_screen, g_dmod.map.ts_loc_mem[mapdat_num], sizeof(struct editor_screen));
-	} else if (load_screen_to(g_dmod.map.map_dat.c_str(), mapdat_num,
+	} else if (!screen_prefetch_take(mapdat_num, &cur_ed_screen)
+		&& load_screen_to(g_dmod.map.map_dat.c_str(), mapdat_num,
 							&cur_ed_screen) < 0) {
 		return -1;
 	}
@@ -817,7 +875,7 @@ void set_mode(int new_mode) {
  */
 void apply_mode0() {
 	log_info("🐁 Applying mode zero to prepare mode 1 and running start script.");
-	memset(&spr[1], 0, sizeof(spr[1]));
+	lsm_reset_sprite(1);
 	spr[1].speed = 3;
 	spr[1].timing = 0;
 	spr[1].brain = 1;
@@ -836,7 +894,6 @@ void apply_mode0() {
 	spr[1].size = 100;
 	spr[1].base_hit = 100;
 	spr[1].active = true;
-	spr[1].custom = new std::map<std::string, int>;
 
 	SDL_WarpMouseInWindow(g_display->window, spr[1].x, spr[1].y);
 
@@ -892,18 +949,18 @@ errors properly instead of using this dirty trick. */
 	else
 		dversion_string = "YeOldeDink in 1.07 mode";
 
-	srand((unsigned)time(NULL));
+	if (!fixed_seed)
+		srand((unsigned)time(NULL));
 	scripting_init();
 }
 
 void game_quit() {
+	screen_prefetch_quit();
 	scripting_kill_all_scripts_for_real();
 
 	int i = 0;
 	for (i = 1; i < MAX_SPRITES_AT_ONCE; i++) {
-		if (spr[i].custom != NULL)
-			delete (spr[i].custom);
-		spr[i].custom = NULL;
+		sp_custom_release(&spr[i].custom);
 	}
 
 	scripting_quit();
@@ -98,6 +98,11 @@ extern void game_restart();
 
 extern void game_compute_speed();
 extern Uint64 game_GetTicks(void);
+extern void game_set_fixed_tick_step(Uint64 step);
+extern void game_advance_fixed_ticks(void);
+extern void game_start_fixed_clock(Uint64 start);
+extern void game_advance_fixed_ticks_by(Uint64 delta);
+extern void game_seed_random(unsigned int seed);
 extern void game_set_high_speed(void);
 extern void game_set_turbo_speed(void);
 extern void game_set_normal_speed(void);
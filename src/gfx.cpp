@@ -99,20 +99,22 @@ IOGfxDisplay* g_display = NULL;
 /**
  * Graphics subsystem initalization
  */
-int gfx_init(bool dinkgl, bool windowed, char* splash_path) {
+int gfx_init(bool dinkgl, bool windowed, char* splash_path, bool headless) {
+	if (headless)
+		g_display = new FakeIOGfxDisplay(window_w, window_h, truecolor, 0);
 	//yeolde: let's make it run in truecolour always when using GL
-	if (!dinkgl)
+	else if (!dinkgl)
 	#ifdef HAVE_SDL_GPU
 		g_display =
 				new IOGfxDisplayGL2(window_w, window_h, truecolor = true,
 									windowed ? SDL_WINDOW_RESIZABLE
 											: SDL_WINDOW_FULLSCREEN_DESKTOP | SDL_WINDOW_OPENGL);
 	#else
-	//Make a fake display if sdl gpu ain't installed
-		g_display = new FakeIOGfxDisplay(0, 0, true, 0);
+	//Fall back to the software renderer if sdl gpu ain't installed
+		dinkgl = true;
 	#endif
 
-	else
+	if (g_display == NULL)
 		g_display =
 				new IOGfxDisplaySW(window_w, window_h, truecolor,
 								windowed ? SDL_WINDOW_RESIZABLE
@@ -266,6 +268,11 @@ void gfx_log_meminfo() {
 		}
 		log_debug("GFX bmp    = %8d", sum);
 		total += sum;
+
+		struct gfx_sprites_slot_stats st;
+		gfx_sprites_get_slot_stats(&st);
+		log_debug("GFX slots  = %8d/%d (highest %d, next free %d)",
+				st.used, st.capacity, st.highest_used, st.lowest_free);
 	}
 
 	{
@@ -278,5 +285,8 @@ void gfx_log_meminfo() {
 }
 
 void save_screenshot_dmoddir() {
-	IMG_SavePNG(IOGFX_backbuffer->screenshot(), paths_dmodfile("screenshot.png"));
+	char* fullpath = paths_dmodfile("screenshot.png");
+	IMG_SavePNG(IOGFX_backbuffer->screenshot(), fullpath);
+	ciconvert_cache_invalidate(fullpath);
+	free(fullpath);
 }
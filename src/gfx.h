@@ -57,7 +57,7 @@ extern Uint64 truecolor_fade_lasttick;
 #define FPS 60
 extern FPSmanager framerate_manager;
 
-extern int gfx_init(bool dinkgl, bool windowed, char* splash_path);
+extern int gfx_init(bool dinkgl, bool windowed, char* splash_path, bool headless);
 extern void gfx_quit(void);
 extern void gfx_log_meminfo(void);
 extern void save_screenshot_dmoddir();
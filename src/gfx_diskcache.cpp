@@ -0,0 +1,342 @@
+/**
+ * Graphics - on-disk cache of decoded images
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Tilesets and sprites are stored as PNG/BMP (possibly in dir.ff
+ * archives) and go through decoding, palette conversion and index
+ * remapping on every launch. This cache keeps the final surfaces, in
+ * the blit format, in a directory of one file per image. Entries are
+ * keyed by source path, source mtime/size, load flags and blit format,
+ * so a modified D-Mod or a different display mode just misses and
+ * rewrites them. Files are mmap'd on load, so a warm start is mostly
+ * page-ins and a memcpy per surface.
+ *
+ * load/store may be called from the sprite loader threads.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gfx_diskcache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <string>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#define mkdir(name, mode) mkdir(name)
+#else
+#include <unistd.h>
+#endif
+
+#include "ImageLoader.h"
+#include "io_util.h"
+#include "log.h"
+
+#define DISKCACHE_MAGIC "YDC1"
+#define DISKCACHE_BYTE_ORDER 0x01020304
+
+/* File layout: header, key string, palette, pixel rows */
+struct diskcache_header {
+	char magic[4];
+	Uint32 byte_order;
+	Uint32 header_size;
+	Uint32 key_len;
+	Sint64 src_mtime;
+	Uint64 src_size;
+	Uint32 flags;
+	Uint32 blit_format;
+	Uint32 blit_palette;
+	Uint32 format;
+	Sint32 w, h, pitch;
+	Uint32 has_colorkey, colorkey;
+	Uint32 blend_mode;
+	Uint32 ncolors;
+};
+
+/* What a cached surface must match to be reused */
+struct diskcache_key {
+	std::string name;
+	Sint64 src_mtime;
+	Uint64 src_size;
+	Uint32 flags;
+	Uint32 blit_format;
+	Uint32 blit_palette;
+};
+
+static char* cache_dir = NULL;
+
+static std::atomic<unsigned int> stat_hits(0);
+static std::atomic<unsigned int> stat_misses(0);
+static std::atomic<unsigned int> stat_stores(0);
+static std::atomic<unsigned int> stat_failures(0);
+
+/**
+ * Enable the cache, storing files in 'dir'. NULL or "" disables it.
+ */
+void gfx_diskcache_init(const char* dir) {
+	gfx_diskcache_quit();
+	if (dir == NULL || dir[0] == '\0')
+		return;
+
+	if (!is_directory(dir) && mkdir(dir, 0777) < 0) {
+		log_error("💾 Cannot create image cache directory '%s', cache disabled", dir);
+		return;
+	}
+	cache_dir = strdup(dir);
+	log_info("💾 Image cache in '%s'", cache_dir);
+}
+
+void gfx_diskcache_quit() {
+	free(cache_dir);
+	cache_dir = NULL;
+}
+
+const char* gfx_diskcache_get_dir() {
+	return cache_dir;
+}
+
+void gfx_diskcache_get_stats(struct gfx_diskcache_stats* stats) {
+	stats->hits = stat_hits;
+	stats->misses = stat_misses;
+	stats->stores = stat_stores;
+	stats->failures = stat_failures;
+}
+
+static Uint32 fnv1a_32(const void* data, size_t len, Uint32 hash) {
+	const unsigned char* p = (const unsigned char*)data;
+	for (size_t i = 0; i < len; i++)
+		hash = (hash ^ p[i]) * 16777619u;
+	return hash;
+}
+
+static Uint64 fnv1a_64(const void* data, size_t len, Uint64 hash) {
+	const unsigned char* p = (const unsigned char*)data;
+	for (size_t i = 0; i < len; i++)
+		hash = (hash ^ p[i]) * 1099511628211ull;
+	return hash;
+}
+
+/**
+ * Describe an image: 'srcpath' is the file on disk, 'member' the name
+ * inside a dir.ff archive (or NULL). Fails if there's no blit format
+ * yet or the source can't be stat'd.
+ */
+static /*bool*/ int make_key(const char* srcpath, const char* member, int flags,
+							struct diskcache_key* key) {
+	SDL_Surface* blit = ImageLoader::blitFormat;
+	if (blit == NULL)
+		return 0;
+
+	struct stat buf;
+	if (stat(srcpath, &buf) < 0)
+		return 0;
+
+	key->name = srcpath;
+	if (member != NULL) {
+		key->name += '|';
+		key->name += member;
+	}
+	key->src_mtime = buf.st_mtime;
+	key->src_size = buf.st_size;
+	key->flags = flags;
+	key->blit_format = blit->format->format;
+	/* 8-bit surfaces are converted to the reference palette */
+	key->blit_palette = 0;
+	if (blit->format->palette != NULL)
+		key->blit_palette = fnv1a_32(blit->format->palette->colors,
+									blit->format->palette->ncolors * sizeof(SDL_Color),
+									2166136261u);
+	return 1;
+}
+
+static std::string cache_file(struct diskcache_key* key) {
+	Uint64 hash = 14695981039346656037ull;
+	hash = fnv1a_64(key->name.c_str(), key->name.length(), hash);
+	hash = fnv1a_64(&key->flags, sizeof(key->flags), hash);
+	hash = fnv1a_64(&key->blit_format, sizeof(key->blit_format), hash);
+	hash = fnv1a_64(&key->blit_palette, sizeof(key->blit_palette), hash);
+	char name[32];
+	sprintf(name, "/%016llx.surf", (unsigned long long)hash);
+	return std::string(cache_dir) + name;
+}
+
+/**
+ * Rebuild a surface from a cache file, or NULL if the file doesn't
+ * match 'key'
+ */
+static SDL_Surface* surface_from_file(const unsigned char* data, size_t len,
+									struct diskcache_key* key) {
+	struct diskcache_header hdr;
+	if (len < sizeof(hdr))
+		return NULL;
+	memcpy(&hdr, data, sizeof(hdr));
+	if (memcmp(hdr.magic, DISKCACHE_MAGIC, 4) != 0
+		|| hdr.byte_order != DISKCACHE_BYTE_ORDER
+		|| hdr.header_size != sizeof(hdr))
+		return NULL;
+	if (hdr.src_mtime != key->src_mtime || hdr.src_size != key->src_size
+		|| hdr.flags != key->flags || hdr.blit_format != key->blit_format
+		|| hdr.blit_palette != key->blit_palette)
+		return NULL;
+	if (hdr.w <= 0 || hdr.h <= 0 || hdr.pitch <= 0 || hdr.ncolors > 256)
+		return NULL;
+
+	size_t pixels_len = (size_t)hdr.h * hdr.pitch;
+	if (len != sizeof(hdr) + hdr.key_len + hdr.ncolors * sizeof(SDL_Color) + pixels_len)
+		return NULL;
+	const unsigned char* p = data + sizeof(hdr);
+	if (hdr.key_len != key->name.length()
+		|| memcmp(p, key->name.c_str(), hdr.key_len) != 0)
+		return NULL;
+	p += hdr.key_len;
+
+	SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, hdr.w, hdr.h,
+		SDL_BITSPERPIXEL(hdr.format), hdr.format);
+	if (surf == NULL)
+		return NULL;
+	int row_len = SDL_min(surf->pitch, hdr.pitch);
+	if (row_len < surf->w * surf->format->BytesPerPixel) {
+		SDL_FreeSurface(surf);
+		return NULL;
+	}
+
+	if (hdr.ncolors > 0 && surf->format->palette != NULL)
+		SDL_SetPaletteColors(surf->format->palette, (const SDL_Color*)p, 0,
+							SDL_min((int)hdr.ncolors, surf->format->palette->ncolors));
+	p += hdr.ncolors * sizeof(SDL_Color);
+
+	Uint8* dst = (Uint8*)surf->pixels;
+	for (int y = 0; y < hdr.h; y++)
+		memcpy(dst + y * surf->pitch, p + y * hdr.pitch, row_len);
+
+	if (hdr.has_colorkey)
+		SDL_SetColorKey(surf, SDL_TRUE, hdr.colorkey);
+	SDL_SetSurfaceBlendMode(surf, (SDL_BlendMode)hdr.blend_mode);
+	return surf;
+}
+
+/**
+ * Return a new copy of the cached surface for this image, or NULL if
+ * there's none (or it's stale)
+ */
+SDL_Surface* gfx_diskcache_load(const char* srcpath, const char* member, int flags) {
+	if (cache_dir == NULL)
+		return NULL;
+
+	struct diskcache_key key;
+	if (!make_key(srcpath, member, flags, &key))
+		return NULL;
+
+	std::string path = cache_file(&key);
+	size_t len = 0;
+	const unsigned char* data = map_file(path.c_str(), &len);
+	SDL_Surface* surf = NULL;
+	if (data != NULL) {
+		surf = surface_from_file(data, len, &key);
+		unmap_file(data, len);
+	}
+	if (surf != NULL)
+		stat_hits++;
+	else
+		stat_misses++;
+	return surf;
+}
+
+/**
+ * Save a decoded surface for the next launch. The file is written
+ * under a temporary name first so that concurrent or interrupted runs
+ * never see a partial entry.
+ */
+void gfx_diskcache_store(const char* srcpath, const char* member, int flags,
+						SDL_Surface* surf) {
+	if (cache_dir == NULL || surf == NULL)
+		return;
+
+	struct diskcache_key key;
+	if (!make_key(srcpath, member, flags, &key))
+		return;
+
+	struct diskcache_header hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, DISKCACHE_MAGIC, 4);
+	hdr.byte_order = DISKCACHE_BYTE_ORDER;
+	hdr.header_size = sizeof(hdr);
+	hdr.key_len = key.name.length();
+	hdr.src_mtime = key.src_mtime;
+	hdr.src_size = key.src_size;
+	hdr.flags = key.flags;
+	hdr.blit_format = key.blit_format;
+	hdr.blit_palette = key.blit_palette;
+	hdr.format = surf->format->format;
+	hdr.w = surf->w;
+	hdr.h = surf->h;
+	hdr.pitch = surf->pitch;
+	Uint32 colorkey = 0;
+	hdr.has_colorkey = (SDL_GetColorKey(surf, &colorkey) == 0);
+	hdr.colorkey = colorkey;
+	SDL_BlendMode blend_mode = SDL_BLENDMODE_NONE;
+	SDL_GetSurfaceBlendMode(surf, &blend_mode);
+	hdr.blend_mode = blend_mode;
+	if (surf->format->palette != NULL)
+		hdr.ncolors = surf->format->palette->ncolors;
+
+	std::string path = cache_file(&key);
+	char suffix[64];
+	sprintf(suffix, ".%lx-%llx.tmp", (unsigned long)SDL_ThreadID(),
+			(unsigned long long)SDL_GetPerformanceCounter());
+	std::string tmppath = path + suffix;
+
+	FILE* out = fopen(tmppath.c_str(), "wb");
+	if (out == NULL) {
+		stat_failures++;
+		return;
+	}
+	int ok = fwrite(&hdr, sizeof(hdr), 1, out) == 1
+		&& fwrite(key.name.c_str(), hdr.key_len, 1, out) == 1;
+	if (ok && hdr.ncolors > 0)
+		ok = fwrite(surf->format->palette->colors, hdr.ncolors * sizeof(SDL_Color), 1, out) == 1;
+	if (ok) {
+		SDL_LockSurface(surf);
+		ok = fwrite(surf->pixels, (size_t)surf->h * surf->pitch, 1, out) == 1;
+		SDL_UnlockSurface(surf);
+	}
+	if (fclose(out) != 0)
+		ok = 0;
+
+#ifdef _WIN32
+	/* rename() doesn't replace existing files on Woe */
+	if (ok)
+		remove(path.c_str());
+#endif
+	if (ok && rename(tmppath.c_str(), path.c_str()) == 0) {
+		stat_stores++;
+	} else {
+		remove(tmppath.c_str());
+		stat_failures++;
+	}
+}
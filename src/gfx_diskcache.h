@@ -0,0 +1,44 @@
+/**
+ * Graphics - on-disk cache of decoded images
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GFX_DISKCACHE_H
+#define _GFX_DISKCACHE_H
+
+#include "SDL.h"
+
+/* Key flag on top of the DINKINI_* load flags: the frame went through
+   the shadow patch */
+#define GFX_DISKCACHE_GOODSHADOWS 0x100
+
+struct gfx_diskcache_stats {
+	unsigned int hits, misses, stores, failures;
+};
+
+extern void gfx_diskcache_init(const char* dir);
+extern void gfx_diskcache_quit();
+extern const char* gfx_diskcache_get_dir();
+extern void gfx_diskcache_get_stats(struct gfx_diskcache_stats* stats);
+
+extern SDL_Surface* gfx_diskcache_load(const char* srcpath, const char* member, int flags);
+extern void gfx_diskcache_store(const char* srcpath, const char* member, int flags, SDL_Surface* surf);
+
+#endif
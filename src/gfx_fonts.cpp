@@ -37,6 +37,7 @@
 #include <algorithm>
 #include <climits>
 #include <sstream>
+#include <unordered_map>
 #include "SDL.h"
 #include "SDL_ttf.h"
 #include "gfx.h"
@@ -58,6 +59,7 @@ char dispfon[200];
 static SDL_Color text_color;
 
 static TTF_Font* load_default_font();
+static void glyphs_forget(TTF_Font* font);
 
 SDL_Color font_colors[16];
 SDL_Color font_extra_colors[16];
@@ -151,6 +153,7 @@ int gfx_fonts_init() {
  * Quit the font subsystem (and free loaded fonts from memory)
  */
 void gfx_fonts_quit(void) {
+	glyphs_forget(NULL);
 	if (dialog_font != NULL) {
 		TTF_CloseFont(dialog_font);
 		dialog_font = NULL;
@@ -270,6 +273,7 @@ int initfont(char* fontname) {
 		return -1;
 
 	/* new_font could be loaded - we can free the previous one */
+	glyphs_forget(dialog_font);
 	TTF_CloseFont(dialog_font);
 	dialog_font = new_font;
 
@@ -322,19 +326,25 @@ void FONTS_SetTextColor(Uint8 r, Uint8 g, Uint8 b) {
 	text_color.b = b;
 }
 
+/**
+ * Text color is using the physical palette (no palette-switching
+ * effect)
+ */
+static void map_text_color(SDL_Color* color) {
+	SDL_PixelFormat* fmt = gfx_palette_get_phys_format();
+	Uint32 phys_index = SDL_MapRGB(fmt, color->r, color->g, color->b);
+	SDL_GetRGB(phys_index, ImageLoader::blitFormat->format, &(color->r),
+			&(color->g), &(color->b));
+	SDL_FreeFormat(fmt);
+}
+
 /*static*/ SDL_Surface* print_text(TTF_Font* font, char* str,
 								SDL_Color /*&*/ color) {
 	if (strlen(str) == 0)
 		return NULL;
 
-	if (!truecolor) {
-		// Text color is using the physical palette (no palette-switching effect)
-		SDL_PixelFormat* fmt = gfx_palette_get_phys_format();
-		Uint32 phys_index = SDL_MapRGB(fmt, color.r, color.g, color.b);
-		SDL_GetRGB(phys_index, ImageLoader::blitFormat->format, &(color.r),
-				&(color.g), &(color.b));
-		SDL_FreeFormat(fmt);
-	}
+	if (!truecolor)
+		map_text_color(&color);
 
 	/* Transparent, low quality - closest to the original engine. */
 	/* Also we do need a monochrome rendering for palette support above */
@@ -428,6 +438,24 @@ static int process_text_for_wrapping(TTF_Font* font, char* str, int max_len) {
 	return line;
 }
 
+static TTF_Font* get_font(FONT_TYPE font_type) {
+	if (font_type == FONT_DIALOG)
+		return dialog_font;
+	else if (font_type == FONT_SYSTEM)
+		return system_font;
+	log_error("Error: unknown font type %d", font_type);
+	exit(1);
+}
+
+static int get_lineskip(TTF_Font* font) {
+	/* Workaround: with vgasys.fon, lineskip is always 1. We'll use it's
+	height instead. */
+	int lineskip = TTF_FontLineSkip(font);
+	if (lineskip == 1)
+		lineskip = TTF_FontHeight(font);
+	return lineskip;
+}
+
 /**
  * Print text 'str' in 'box', adding newlines if necessary
  * (word-wrapping). Return the text height in pixels.
@@ -446,20 +474,8 @@ int print_text_wrap_getcmds(char* str, rect* box,
 	TTF_Font* font;
 	int lineskip = 0;
 
-	if (font_type == FONT_DIALOG)
-		font = dialog_font;
-	else if (font_type == FONT_SYSTEM)
-		font = system_font;
-	else {
-		log_error("Error: unknown font type %d", font_type);
-		exit(1);
-	}
-
-	/* Workaround: with vgasys.fon, lineskip is always 1. We'll use it's
-	height instead. */
-	lineskip = TTF_FontLineSkip(font);
-	if (lineskip == 1)
-		lineskip = TTF_FontHeight(font);
+	font = get_font(font_type);
+	lineskip = get_lineskip(font);
 
 	tmp = strdup(str);
 	process_text_for_wrapping(font, tmp, box->right - box->left);
@@ -582,6 +598,329 @@ IOGfxSurface* print_text_flatten_cmds(std::vector<TextCommand>* cmds) {
 	return g_display->upload((*cmds)[0].img);
 }
 
+/* Glyph atlas: dialog text gets a dark outline, which took five
+TTF renderings of each line (four offset passes for the outline, one
+for the text). Glyphs are now rasterized once per font and style,
+along with the pixels their outline covers, and text is composed from
+them with plain copies. */
+
+/* Which neighbours of an outline pixel are inked */
+#define GLYPH_INK_LEFT 1
+#define GLYPH_INK_RIGHT 2
+#define GLYPH_INK_ABOVE 4
+#define GLYPH_INK_BELOW 8
+
+struct glyph {
+	int left; // TTF minx metric, where SDL_ttf starts rendering
+	int advance;
+	int x, y, w, h; // ink box, from the pen position and the line top
+	std::vector<Uint8> ink; // w*h, 1 where the glyph is drawn
+	std::vector<Uint8> outline; // (w+2)*(h+2), GLYPH_INK_* flags
+};
+
+struct glyph_key {
+	TTF_Font* font;
+	int style;
+	Uint32 ch;
+	bool operator==(const glyph_key& o) const {
+		return font == o.font && style == o.style && ch == o.ch;
+	}
+};
+
+struct glyph_key_hash {
+	size_t operator()(const glyph_key& k) const {
+		return std::hash<TTF_Font*>()(k.font) ^ ((size_t)k.style << 24)
+			^ (k.ch * 2654435761u);
+	}
+};
+
+static std::unordered_map<glyph_key, struct glyph, glyph_key_hash> glyphs;
+static struct gfx_fonts_glyph_stats glyph_stats;
+
+/**
+ * Drop the glyphs of 'font' before it is closed, NULL drops all
+ */
+static void glyphs_forget(TTF_Font* font) {
+	if (font == NULL) {
+		glyphs.clear();
+		return;
+	}
+	for (auto it = glyphs.begin(); it != glyphs.end();) {
+		if (it->first.font == font)
+			it = glyphs.erase(it);
+		else
+			++it;
+	}
+}
+
+void gfx_fonts_get_glyph_stats(struct gfx_fonts_glyph_stats* stats) {
+	*stats = glyph_stats;
+	stats->glyphs = glyphs.size();
+}
+
+static struct glyph* glyph_get(TTF_Font* font, Uint32 ch) {
+	glyph_key key = {font, TTF_GetFontStyle(font), ch};
+	auto it = glyphs.find(key);
+	if (it != glyphs.end()) {
+		glyph_stats.hits++;
+		return &it->second;
+	}
+	glyph_stats.misses++;
+
+	struct glyph* g = &glyphs[key];
+	int maxx, miny, maxy;
+	g->x = g->y = g->w = g->h = 0;
+	if (TTF_GlyphMetrics32(font, ch, &g->left, &maxx, &miny, &maxy, &g->advance) < 0) {
+		g->left = g->advance = 0;
+		return g;
+	}
+
+	SDL_Color white = {255, 255, 255, 255};
+	SDL_Surface* img = TTF_RenderGlyph32_Solid(font, ch, white);
+	if (img == NULL)
+		return g; /* blank */
+
+	Uint8* pixels = (Uint8*)img->pixels;
+	int x0 = img->w, x1 = -1, y0 = img->h, y1 = -1;
+	for (int y = 0; y < img->h; y++)
+		for (int x = 0; x < img->w; x++)
+			if (pixels[y * img->pitch + x] != 0) {
+				x0 = std::min(x0, x);
+				x1 = std::max(x1, x);
+				y0 = std::min(y0, y);
+				y1 = std::max(y1, y);
+			}
+	if (x1 >= 0) {
+		/* The rendering starts at 'left' if it's left of the pen */
+		g->x = x0 - std::max(0, -g->left);
+		g->y = y0;
+		g->w = x1 - x0 + 1;
+		g->h = y1 - y0 + 1;
+		g->ink.assign(g->w * g->h, 0);
+		g->outline.assign((g->w + 2) * (g->h + 2), 0);
+		int stride = g->w + 2;
+		for (int y = 0; y < g->h; y++) {
+			for (int x = 0; x < g->w; x++) {
+				if (pixels[(y0 + y) * img->pitch + x0 + x] == 0)
+					continue;
+				g->ink[y * g->w + x] = 1;
+				int o = (y + 1) * stride + x + 1;
+				g->outline[o + 1] |= GLYPH_INK_LEFT;
+				g->outline[o - 1] |= GLYPH_INK_RIGHT;
+				g->outline[o + stride] |= GLYPH_INK_ABOVE;
+				g->outline[o - stride] |= GLYPH_INK_BELOW;
+			}
+		}
+	}
+	SDL_FreeSurface(img);
+	return g;
+}
+
+/**
+ * Decode the UTF-8 character at '*ps' and skip past it
+ */
+static Uint32 utf8_next(const char** ps) {
+	const Uint8* s = (const Uint8*)*ps;
+	Uint32 ch;
+	int n;
+	if (s[0] < 0x80) {
+		ch = s[0];
+		n = 0;
+	} else if ((s[0] & 0xE0) == 0xC0) {
+		ch = s[0] & 0x1F;
+		n = 1;
+	} else if ((s[0] & 0xF0) == 0xE0) {
+		ch = s[0] & 0x0F;
+		n = 2;
+	} else if ((s[0] & 0xF8) == 0xF0) {
+		ch = s[0] & 0x07;
+		n = 3;
+	} else {
+		*ps += 1;
+		return 0xFFFD;
+	}
+	for (int i = 1; i <= n; i++) {
+		if ((s[i] & 0xC0) != 0x80) {
+			*ps += i;
+			return 0xFFFD;
+		}
+		ch = ch << 6 | (s[i] & 0x3F);
+	}
+	*ps += n + 1;
+	return ch;
+}
+
+struct text_line {
+	int x, y, w; // w is truncated to the box
+	std::vector<std::pair<struct glyph*, int> > glyphs; // and their x
+};
+
+/**
+ * Place the glyphs of 'str' the way TTF_RenderUTF8_Solid() does
+ */
+static void layout_line(TTF_Font* font, const char* str, struct text_line* line) {
+	int pen = 0, minx = 0;
+	Uint32 prev = 0;
+	const char* p = str;
+	while (*p != '\0') {
+		Uint32 ch = utf8_next(&p);
+		if (prev != 0)
+			pen += TTF_GetFontKerningSizeGlyphs32(font, prev, ch);
+		struct glyph* g = glyph_get(font, ch);
+		minx = std::min(minx, pen + g->left);
+		line->glyphs.push_back(std::make_pair(g, pen));
+		pen += g->advance;
+		prev = ch;
+	}
+	for (auto& lg : line->glyphs)
+		lg.second -= minx;
+}
+
+/**
+ * Render text 'str' in 'box' in color 'fg' with a 1-pixel 'bg' outline,
+ * i.e. what the dialog passes of print_text_wrap_getcmds() flattened by
+ * print_text_flatten_cmds() produce. Return NULL if there's nothing to
+ * draw, otherwise the image and its position relative to 'box' in
+ * 'dst'.
+ */
+SDL_Surface* print_text_outlined_getsurface(char* str, rect* box,
+											/*bool*/ int hcenter, FONT_TYPE font_type,
+											SDL_Color fg, SDL_Color bg, SDL_Rect* dst) {
+	TTF_Font* font = get_font(font_type);
+	int lineskip = get_lineskip(font);
+	int height = TTF_FontHeight(font);
+	int w = box->right - box->left;
+
+	char* tmp = strdup(str);
+	process_text_for_wrapping(font, tmp, w);
+
+	/* Bounding box of the text and the 4 outline passes */
+	std::vector<struct text_line> lines;
+	int min_x = INT_MAX, max_x = 0, min_y = INT_MAX, max_y = 0;
+	int y = box->top;
+	char* pline = tmp;
+	while (1) {
+		char* pc = strchr(pline, '\n');
+		if (pc != NULL)
+			*pc = '\0';
+		if (*pline != '\0') {
+			struct text_line line;
+			int line_w = 0;
+			TTF_SizeUTF8(font, pline, &line_w, NULL);
+			line.x = box->left;
+			if (hcenter)
+				line.x += w / 2 - line_w / 2;
+			line.y = y;
+			line.w = std::min(w, line_w); // truncate text if outside the box
+			layout_line(font, pline, &line);
+			min_x = std::min(min_x, line.x - 2);
+			max_x = std::max(max_x, line.x + line.w);
+			min_y = std::min(min_y, line.y - 1);
+			max_y = std::max(max_y, line.y + height + 1);
+			lines.push_back(line);
+		}
+		y += lineskip;
+		if (pc == NULL)
+			break;
+		pline = pc + 1;
+	}
+	free(tmp);
+	if (lines.empty())
+		return NULL;
+
+	/* Compose: 0 = transparent, 1 = outline, 2 = text */
+	SDL_Surface* mask = SDL_CreateRGBSurfaceWithFormat(0, max_x - min_x,
+			max_y - min_y, 8, SDL_PIXELFORMAT_INDEX8);
+	if (mask == NULL) {
+		log_error("print_text_outlined: %s", SDL_GetError());
+		return NULL;
+	}
+	SDL_FillRect(mask, NULL, 0);
+	Uint8* pixels = (Uint8*)mask->pixels;
+	for (auto& line : lines) {
+		/* Text is drawn 1 pixel left of the box position */
+		Uint8* origin = pixels + (line.y - min_y) * mask->pitch + (line.x - 1 - min_x);
+		/* Only pixels within the (truncated) line are drawn, including
+		those the outline comes from */
+		auto inked = [&](int sx, int sy) {
+			return sx >= 0 && sx < line.w && sy >= 0 && sy < height;
+		};
+		for (auto& lg : line.glyphs) {
+			struct glyph* g = lg.first;
+			if (g->ink.empty())
+				continue; /* blank */
+			int stride = g->w + 2;
+			for (int oy = 0; oy < g->h + 2; oy++) {
+				for (int ox = 0; ox < stride; ox++) {
+					int flags = g->outline[oy * stride + ox];
+					if (flags == 0)
+						continue;
+					int lx = lg.second + g->x + ox - 1;
+					int ly = g->y + oy - 1;
+					if (((flags & GLYPH_INK_LEFT) && inked(lx - 1, ly))
+						|| ((flags & GLYPH_INK_RIGHT) && inked(lx + 1, ly))
+						|| ((flags & GLYPH_INK_ABOVE) && inked(lx, ly - 1))
+						|| ((flags & GLYPH_INK_BELOW) && inked(lx, ly + 1))) {
+						Uint8* p = origin + ly * mask->pitch + lx;
+						if (*p == 0)
+							*p = 1;
+					}
+				}
+			}
+		}
+		for (auto& lg : line.glyphs) {
+			struct glyph* g = lg.first;
+			for (int gy = 0; gy < g->h; gy++) {
+				for (int gx = 0; gx < g->w; gx++) {
+					int lx = lg.second + g->x + gx;
+					int ly = g->y + gy;
+					if (g->ink[gy * g->w + gx] && inked(lx, ly))
+						origin[ly * mask->pitch + lx] = 2;
+				}
+			}
+		}
+	}
+
+	if (!truecolor) {
+		map_text_color(&fg);
+		map_text_color(&bg);
+	}
+	SDL_Color colors[3] = {{0, 0, 0, 255}, bg, fg};
+	SDL_SetPaletteColors(mask->format->palette, colors, 0, 3);
+	SDL_SetColorKey(mask, SDL_TRUE, 0);
+
+	// Find unused color for transparency
+	SDL_Surface* flat = ImageLoader::newWithBlitFormat(mask->w, mask->h);
+	Uint32 key = 0;
+	while (1) {
+		Uint8 r, g, b;
+		SDL_GetRGB(key, flat->format, &r, &g, &b);
+		if (!(r == bg.r && g == bg.g && b == bg.b)
+			&& !(r == fg.r && g == fg.g && b == fg.b))
+			break;
+		key++;
+	}
+	SDL_FillRect(flat, NULL, key);
+	SDL_SetColorKey(flat, SDL_TRUE, key);
+	if (SDL_BlitSurface(mask, NULL, flat, NULL) != 0)
+		log_error("print_text_outlined: %s", SDL_GetError());
+	SDL_FreeSurface(mask);
+
+	glyph_stats.texts++;
+	*dst = {min_x, min_y, 0, 0};
+	return flat;
+}
+
+IOGfxSurface* print_text_outlined(char* str, rect* box, /*bool*/ int hcenter,
+								FONT_TYPE font_type, SDL_Color fg, SDL_Color bg,
+								SDL_Rect* dst) {
+	SDL_Surface* img = print_text_outlined_getsurface(str, box, hcenter,
+													font_type, fg, bg, dst);
+	if (img == NULL)
+		return NULL;
+	return g_display->upload(img);
+}
+
 int print_text_wrap(char* str, rect* box,
 					/*bool*/ int hcenter, int calc_only, FONT_TYPE font_type) {
 	std::vector<TextCommand> cmds;
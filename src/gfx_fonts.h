@@ -45,6 +45,10 @@ details). 16 matches that size with SDL_ttf (possibly only for
 LiberationSans). */
 #define FONT_SIZE 16
 
+struct gfx_fonts_glyph_stats {
+	unsigned int glyphs, hits, misses, texts;
+};
+
 extern char dispfon[200];
 
 // D-Mod-defined font colors
@@ -67,6 +71,13 @@ extern int print_text_wrap_getcmds(char* str, rect* box, /*bool*/ int hcenter,
 extern void print_text_wrap_debug(const char* str, int x, int y);
 extern IOGfxSurface* print_text_flatten_cmds(std::vector<TextCommand>* cmds);
 extern void print_text_cache(IOGfxSurface* surf, SDL_Rect dst, int x, int y);
+extern SDL_Surface* print_text_outlined_getsurface(char* str, rect* box,
+												/*bool*/ int hcenter, FONT_TYPE font_type,
+												SDL_Color fg, SDL_Color bg, SDL_Rect* dst);
+extern IOGfxSurface* print_text_outlined(char* str, rect* box, /*bool*/ int hcenter,
+									FONT_TYPE font_type, SDL_Color fg, SDL_Color bg,
+									SDL_Rect* dst);
+extern void gfx_fonts_get_glyph_stats(struct gfx_fonts_glyph_stats* stats);
 
 extern void SaySmall(char thing[500], int px, int py, int r, int g, int b);
 extern void Say(char thing[500], int px, int py);
@@ -0,0 +1,297 @@
+/**
+ * Graphics - per-pixel kernels: truecolor fade, 8-bit palette expansion
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * These run on every pixel of the screen during fades, so they have
+ * SSE2/AVX2/NEON versions picked at runtime from the CPU features.
+ * The scalar versions are the reference: the others must give the
+ * exact same bytes (cf. test_gfx_pixels).
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gfx_pixels.h"
+
+#include <string.h>
+#include "SDL.h"
+
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+#define GFX_PIXELS_X86
+#include <immintrin.h>
+#endif
+#if (defined __ARM_NEON || defined __ARM_NEON__) && SDL_BYTEORDER == SDL_LIL_ENDIAN
+#define GFX_PIXELS_ARM
+#include <arm_neon.h>
+#endif
+
+/* Assume that pixel order is RGBA, as gfx_fade_apply() did */
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#define FADE_WHITE 0x00FFFFFF
+#else
+#define FADE_WHITE 0xFFFFFF00
+#endif
+
+static void (*fade_row)(Uint32*, int, int, int) = gfx_fade_row_scalar;
+static void (*expand_row)(const Uint8*, Uint32*, int,
+						  const struct gfx_palette_lut*) = gfx_expand_row_scalar;
+static enum gfx_pixels_impl current_impl = GFX_PIXELS_SCALAR;
+
+/**
+ * Darken the first 3 bytes of each pixel by brightness/256, leaving
+ * white alone if 'skip_white'
+ */
+void gfx_fade_row_scalar(Uint32* p, int n, int brightness, /*bool*/ int skip_white) {
+	for (int x = 0; x < n; x++) {
+		if (*p != FADE_WHITE || !skip_white) {
+			*((Uint8*)p) = *((Uint8*)p) * brightness >> 8;
+			*((Uint8*)p + 1) = *((Uint8*)p + 1) * brightness >> 8;
+			*((Uint8*)p + 2) = *((Uint8*)p + 2) * brightness >> 8;
+		}
+		p++;
+	}
+}
+
+void gfx_expand_row_scalar(const Uint8* src, Uint32* dst, int n,
+						   const struct gfx_palette_lut* lut) {
+	for (int x = 0; x < n; x++)
+		dst[x] = lut->pixels[src[x]];
+}
+
+#ifdef GFX_PIXELS_X86
+__attribute__((target("sse2")))
+static void fade_row_sse2(Uint32* p, int n, int brightness, /*bool*/ int skip_white) {
+	const __m128i zero = _mm_setzero_si128();
+	/* Multiplying the 4th byte by 256 then shifting keeps it as-is */
+	const __m128i mul = _mm_set_epi16(256, brightness, brightness, brightness,
+									  256, brightness, brightness, brightness);
+	const __m128i white = _mm_set1_epi32(FADE_WHITE);
+	const __m128i skip = _mm_set1_epi32(skip_white ? -1 : 0);
+	int x = 0;
+	for (; x + 4 <= n; x += 4) {
+		__m128i px = _mm_loadu_si128((__m128i*)(p + x));
+		__m128i lo = _mm_unpacklo_epi8(px, zero);
+		__m128i hi = _mm_unpackhi_epi8(px, zero);
+		lo = _mm_srli_epi16(_mm_mullo_epi16(lo, mul), 8);
+		hi = _mm_srli_epi16(_mm_mullo_epi16(hi, mul), 8);
+		__m128i faded = _mm_packus_epi16(lo, hi);
+		__m128i keep = _mm_and_si128(_mm_cmpeq_epi32(px, white), skip);
+		px = _mm_or_si128(_mm_and_si128(keep, px), _mm_andnot_si128(keep, faded));
+		_mm_storeu_si128((__m128i*)(p + x), px);
+	}
+	gfx_fade_row_scalar(p + x, n - x, brightness, skip_white);
+}
+
+__attribute__((target("avx2")))
+static void fade_row_avx2(Uint32* p, int n, int brightness, /*bool*/ int skip_white) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i mul = _mm256_set_epi16(256, brightness, brightness, brightness,
+										 256, brightness, brightness, brightness,
+										 256, brightness, brightness, brightness,
+										 256, brightness, brightness, brightness);
+	const __m256i white = _mm256_set1_epi32(FADE_WHITE);
+	const __m256i skip = _mm256_set1_epi32(skip_white ? -1 : 0);
+	int x = 0;
+	for (; x + 8 <= n; x += 8) {
+		__m256i px = _mm256_loadu_si256((__m256i*)(p + x));
+		/* unpack and pack both work per 128-bit lane, so pixels stay in place */
+		__m256i lo = _mm256_unpacklo_epi8(px, zero);
+		__m256i hi = _mm256_unpackhi_epi8(px, zero);
+		lo = _mm256_srli_epi16(_mm256_mullo_epi16(lo, mul), 8);
+		hi = _mm256_srli_epi16(_mm256_mullo_epi16(hi, mul), 8);
+		__m256i faded = _mm256_packus_epi16(lo, hi);
+		__m256i keep = _mm256_and_si256(_mm256_cmpeq_epi32(px, white), skip);
+		px = _mm256_blendv_epi8(faded, px, keep);
+		_mm256_storeu_si256((__m256i*)(p + x), px);
+	}
+	gfx_fade_row_scalar(p + x, n - x, brightness, skip_white);
+}
+
+__attribute__((target("avx2")))
+static void expand_row_avx2(const Uint8* src, Uint32* dst, int n,
+							const struct gfx_palette_lut* lut) {
+	int x = 0;
+	for (; x + 8 <= n; x += 8) {
+		__m128i idx8 = _mm_loadl_epi64((const __m128i*)(src + x));
+		__m256i idx = _mm256_cvtepu8_epi32(idx8);
+		__m256i px = _mm256_i32gather_epi32((const int*)lut->pixels, idx, 4);
+		_mm256_storeu_si256((__m256i*)(dst + x), px);
+	}
+	gfx_expand_row_scalar(src + x, dst + x, n - x, lut);
+}
+#endif
+
+#ifdef GFX_PIXELS_ARM
+static void fade_row_neon(Uint32* p, int n, int brightness, /*bool*/ int skip_white) {
+	const uint8x8_t mul = vdup_n_u8(brightness);
+	const uint32x4_t white = vdupq_n_u32(FADE_WHITE);
+	const uint32x4_t skip = vdupq_n_u32(skip_white ? 0xFFFFFFFF : 0);
+	const uint32x4_t fourth = vdupq_n_u32(0xFF000000);
+	int x = 0;
+	for (; x + 4 <= n; x += 4) {
+		uint8x16_t px = vld1q_u8((Uint8*)(p + x));
+		uint16x8_t lo = vmull_u8(vget_low_u8(px), mul);
+		uint16x8_t hi = vmull_u8(vget_high_u8(px), mul);
+		uint8x16_t faded = vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8));
+		uint32x4_t px32 = vreinterpretq_u32_u8(px);
+		uint32x4_t keep = vandq_u32(vceqq_u32(px32, white), skip);
+		keep = vorrq_u32(keep, fourth);
+		vst1q_u32(p + x, vbslq_u32(keep, px32, vreinterpretq_u32_u8(faded)));
+	}
+	gfx_fade_row_scalar(p + x, n - x, brightness, skip_white);
+}
+
+#ifdef __aarch64__
+/* No gather on NEON, but 64-byte table lookups: look each output
+byte up in its 256-entry plane, 64 entries at a time */
+static inline uint8x16_t lookup_plane(const uint8x16x4_t* t, uint8x16_t idx) {
+	const uint8x16_t step = vdupq_n_u8(64);
+	/* out-of-range indices give 0 with tbl, and are left alone by tbx */
+	uint8x16_t r = vqtbl4q_u8(t[0], idx);
+	idx = vsubq_u8(idx, step);
+	r = vqtbx4q_u8(r, t[1], idx);
+	idx = vsubq_u8(idx, step);
+	r = vqtbx4q_u8(r, t[2], idx);
+	idx = vsubq_u8(idx, step);
+	return vqtbx4q_u8(r, t[3], idx);
+}
+
+static void expand_row_neon(const Uint8* src, Uint32* dst, int n,
+							const struct gfx_palette_lut* lut) {
+	uint8x16x4_t t[4][4];
+	for (int c = 0; c < 4; c++)
+		for (int q = 0; q < 4; q++)
+			for (int k = 0; k < 4; k++)
+				t[c][q].val[k] = vld1q_u8(&lut->planes[c][q * 64 + k * 16]);
+	int x = 0;
+	for (; x + 16 <= n; x += 16) {
+		uint8x16_t idx = vld1q_u8(src + x);
+		uint8x16x4_t out;
+		for (int c = 0; c < 4; c++)
+			out.val[c] = lookup_plane(t[c], idx);
+		vst4q_u8((Uint8*)(dst + x), out);
+	}
+	gfx_expand_row_scalar(src + x, dst + x, n - x, lut);
+}
+#endif
+#endif
+
+/**
+ * Switch to the given implementation, if this CPU and build support
+ * it. Returns 0 otherwise.
+ */
+/*bool*/ int gfx_pixels_use(enum gfx_pixels_impl impl) {
+	switch (impl) {
+	case GFX_PIXELS_SCALAR:
+		fade_row = gfx_fade_row_scalar;
+		expand_row = gfx_expand_row_scalar;
+		break;
+#ifdef GFX_PIXELS_X86
+	case GFX_PIXELS_SSE2:
+		if (!SDL_HasSSE2())
+			return 0;
+		/* SSE2 has no gather; the scalar loop is as fast */
+		fade_row = fade_row_sse2;
+		expand_row = gfx_expand_row_scalar;
+		break;
+	case GFX_PIXELS_AVX2:
+		if (!SDL_HasAVX2())
+			return 0;
+		fade_row = fade_row_avx2;
+		expand_row = expand_row_avx2;
+		break;
+#endif
+#ifdef GFX_PIXELS_ARM
+	case GFX_PIXELS_NEON:
+#ifndef __aarch64__
+		if (!SDL_HasNEON())
+			return 0;
+#endif
+		fade_row = fade_row_neon;
+#ifdef __aarch64__
+		expand_row = expand_row_neon;
+#else
+		expand_row = gfx_expand_row_scalar;
+#endif
+		break;
+#endif
+	default:
+		return 0;
+	}
+	current_impl = impl;
+	return 1;
+}
+
+/**
+ * Pick the fastest implementation for this CPU
+ */
+void gfx_pixels_init() {
+	if (!gfx_pixels_use(GFX_PIXELS_AVX2) && !gfx_pixels_use(GFX_PIXELS_SSE2)
+		&& !gfx_pixels_use(GFX_PIXELS_NEON))
+		gfx_pixels_use(GFX_PIXELS_SCALAR);
+}
+
+const char* gfx_pixels_get_name() {
+	switch (current_impl) {
+	case GFX_PIXELS_SSE2:
+		return "SSE2";
+	case GFX_PIXELS_AVX2:
+		return "AVX2";
+	case GFX_PIXELS_NEON:
+		return "NEON";
+	default:
+		return "scalar";
+	}
+}
+
+/**
+ * Map 'palette' to 'format', which must be 32-bit
+ */
+void gfx_palette_lut_build(struct gfx_palette_lut* lut, SDL_Color* palette,
+						   SDL_PixelFormat* format) {
+	for (int i = 0; i < 256; i++) {
+		Uint32 pixel = SDL_MapRGB(format, palette[i].r, palette[i].g, palette[i].b);
+		lut->pixels[i] = pixel;
+		for (int c = 0; c < 4; c++)
+			lut->planes[c][i] = ((Uint8*)&pixel)[c];
+	}
+}
+
+/**
+ * Apply a [0-256] brightness to a row of 32-bit pixels
+ */
+void gfx_fade_row(Uint32* p, int n, int brightness, /*bool*/ int skip_white) {
+	if (brightness >= 256)
+		return;
+	if (brightness < 0)
+		brightness = 0;
+	fade_row(p, n, brightness, skip_white);
+}
+
+/**
+ * Convert a row of 8-bit pixels to 32-bit through 'lut'
+ */
+void gfx_expand_row(const Uint8* src, Uint32* dst, int n,
+					const struct gfx_palette_lut* lut) {
+	expand_row(src, dst, n, lut);
+}
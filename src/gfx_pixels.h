@@ -0,0 +1,58 @@
+/**
+ * Graphics - per-pixel kernels: truecolor fade, 8-bit palette expansion
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GFX_PIXELS_H
+#define _GFX_PIXELS_H
+
+#include "SDL.h"
+
+enum gfx_pixels_impl {
+	GFX_PIXELS_SCALAR,
+	GFX_PIXELS_SSE2,
+	GFX_PIXELS_AVX2,
+	GFX_PIXELS_NEON,
+};
+
+/* Palette mapped to a 32-bit format, also split per byte for table
+lookups */
+struct gfx_palette_lut {
+	Uint32 pixels[256];
+	Uint8 planes[4][256];
+};
+
+extern void gfx_pixels_init();
+extern /*bool*/ int gfx_pixels_use(enum gfx_pixels_impl impl);
+extern const char* gfx_pixels_get_name();
+
+extern void gfx_palette_lut_build(struct gfx_palette_lut* lut, SDL_Color* palette,
+								  SDL_PixelFormat* format);
+
+extern void gfx_fade_row(Uint32* p, int n, int brightness, /*bool*/ int skip_white);
+extern void gfx_expand_row(const Uint8* src, Uint32* dst, int n,
+						   const struct gfx_palette_lut* lut);
+
+/* Reference implementations */
+extern void gfx_fade_row_scalar(Uint32* p, int n, int brightness, /*bool*/ int skip_white);
+extern void gfx_expand_row_scalar(const Uint8* src, Uint32* dst, int n,
+								  const struct gfx_palette_lut* lut);
+
+#endif
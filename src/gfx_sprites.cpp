@@ -30,6 +30,14 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+#include <string>
+#include <vector>
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
 #include "SDL_image.h"
 
 #include "IOGfxPrimitives.h"
@@ -37,6 +45,7 @@
 #include "ImageLoader.h"
 
 #include "fastfile.h"
+#include "gfx_diskcache.h"
 #include "io_util.h"
 #include "log.h"
 #include "paths.h"
@@ -108,6 +117,66 @@ bool check_alpha_pixel(SDL_Surface *surf, int x, int y) {
 	return false;
 }
 
+/* GFX_k occupancy: one bit per slot, set while GFX_k[i].k is in use,
+and one bit per bitmap word that is full. Finding the lowest free slot
+then takes a couple of find-first-set rather than a scan of GFX_k. Only
+change GFX_k[].k through slot_set()/slot_free() so they stay in sync. */
+#define SLOT_WORDS ((MAX_SPRITES + 63) / 64)
+#define SLOT_FULL_WORDS ((SLOT_WORDS + 63) / 64)
+static Uint64 slot_used[SLOT_WORDS];
+static Uint64 slot_full[SLOT_FULL_WORDS];
+static int slots_in_use = 0;
+
+static inline int lowest_bit(Uint64 x) {
+#if defined __GNUC__ || defined __clang__
+	return __builtin_ctzll(x);
+#else
+	int n = 0;
+	while (!(x & 1)) {
+		x >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+static inline int highest_bit(Uint64 x) {
+#if defined __GNUC__ || defined __clang__
+	return 63 - __builtin_clzll(x);
+#else
+	int n = 0;
+	while (x >>= 1)
+		n++;
+	return n;
+#endif
+}
+
+static void slot_set(int i, IOGfxSurface* surf) {
+	GFX_k[i].k = surf;
+	if (surf == NULL)
+		return;
+	int w = i / 64;
+	Uint64 bit = (Uint64)1 << (i % 64);
+	if (!(slot_used[w] & bit))
+		slots_in_use++;
+	slot_used[w] |= bit;
+	if (slot_used[w] == ~(Uint64)0)
+		slot_full[w / 64] |= (Uint64)1 << (w % 64);
+}
+
+static void slot_free(int i) {
+	if (i < 0 || i >= MAX_SPRITES)
+		return;
+	delete GFX_k[i].k;
+	GFX_k[i].k = NULL;
+	int w = i / 64;
+	Uint64 bit = (Uint64)1 << (i % 64);
+	if (slot_used[w] & bit)
+		slots_in_use--;
+	slot_used[w] &= ~bit;
+	slot_full[w / 64] &= ~((Uint64)1 << (w % 64));
+}
+
 /**
  * Free memory used by sprites. It's not much useful in itself, since
  * it's only called when we're exiting the game, but it does avoid
@@ -119,14 +188,15 @@ void sprites_unload(void) {
 	int i = 0;
 	for (i = 0; i < MAX_SPRITES; i++) {
 		if (GFX_k[i].k != NULL)
-			delete GFX_k[i].k;
-		GFX_k[i].k = NULL;
+			slot_free(i);
 	}
 	for (i = 0; i < MAX_SEQUENCES; i++) {
 		if (seq[i].ini != NULL)
 			free(seq[i].ini);
 		seq[i].ini = NULL;
 	}
+	gfx_sprites_warm_clear();
+	FastFileRegistryClear();
 }
 
 /**
@@ -138,14 +208,43 @@ this (e.g. if getpic(...) < 1). */
 	/* TODO: I noticed that sprite in slot 0 (by default, this would be
 a small white square) would be displayed temporarily on the
 screen in some situations... */
-	int i = 1;
-	while (i < MAX_SPRITES && GFX_k[i].k != NULL)
-		i++;
-	return i;
+	for (int f = 0; f < SLOT_FULL_WORDS; f++) {
+		Uint64 not_full = ~slot_full[f];
+		while (not_full != 0) {
+			int w = f * 64 + lowest_bit(not_full);
+			if (w >= SLOT_WORDS)
+				return MAX_SPRITES;
+			Uint64 free_bits = ~slot_used[w];
+			if (w == 0)
+				free_bits &= ~(Uint64)1; // slot 0 is never handed out
+			if (free_bits != 0) {
+				int i = w * 64 + lowest_bit(free_bits);
+				return (i < MAX_SPRITES) ? i : MAX_SPRITES;
+			}
+			not_full &= not_full - 1;
+		}
+	}
+	return MAX_SPRITES;
 	/* Callee will need to check if i >= MAX_SPRITES and fail if
 necessary */
 }
 
+/**
+ * Slot usage, for the debug window and meminfo
+ */
+void gfx_sprites_get_slot_stats(struct gfx_sprites_slot_stats* stats) {
+	stats->used = slots_in_use;
+	stats->capacity = MAX_SPRITES - 1; // slot 0 is reserved
+	stats->lowest_free = next_slot();
+	stats->highest_used = 0;
+	for (int w = SLOT_WORDS - 1; w >= 0; w--) {
+		if (slot_used[w] != 0) {
+			stats->highest_used = w * 64 + highest_bit(slot_used[w]);
+			break;
+		}
+	}
+}
+
 /**
  * Free all graphic slots used by given sequence
  */
@@ -154,62 +253,125 @@ static void free_seq(int seq_no) {
 	int slot_index = -1;
 	while (i < MAX_FRAMES_PER_ABUSED_SEQUENCE + 1 &&
 		(slot_index = seq[seq_no].frame[i]) != 0) {
-		delete GFX_k[slot_index].k;
-		GFX_k[slot_index].k = NULL;
+		slot_free(slot_index);
 		i++;
 	}
 	/* 0 means end-of-sequence, no more frames */
 	if (i == MAX_FRAMES_PER_ABUSED_SEQUENCE + 1)
 		log_error("🌊 Invalid sequence %d, just avoided a buffer overflow\n", seq_no);
 }
-//ye: load from fastfile
-void load_sprite_pak(char seq_path_prefix[100], int seq_no, int delay,
-					int xoffset, int yoffset, rect hardbox, int flags,
-					/*bool*/ int samedir) {
+/* Where a sequence's frames are read from */
+enum seq_source { SEQ_SOURCE_PAK, SEQ_SOURCE_FILES };
+
+/* A frame decoded ahead of getting a GFX_k slot */
+struct decoded_frame {
+	SDL_Surface* surf; // NULL when the frame is skipped
+	char name[200]; // file name, for error messages
+	/*bool*/ int last; // loading stops here (end of sequence or error)
+	std::vector<std::string> errors; // logged when the frame is reached
+};
+
+/**
+ * The frames of a sequence, decoded but not uploaded yet. Decoding
+ * doesn't touch GFX_k/k/seq, so it can run ahead of time on a loader
+ * thread; load_decoded_seq() then does the bookkeeping on the main
+ * thread, picking slots in the same order as a serial load.
+ */
+struct decoded_seq {
+	char* seq_path_prefix;
+	int flags;
+	/*bool*/ int goodshadows; // run the shadow patch, decided when queued
+	enum seq_source source;
+	/*bool*/ int samedir; // D-Mod or fallback data
+	/*bool*/ int no_archive; // dir.ff couldn't be opened
+	char* fullpath; // dir.ff path, for error messages
+	char crap[200]; // last file looked up before the frames
+	std::vector<struct decoded_frame> frames;
+};
+
+static struct decoded_seq* decoded_seq_new(const char* seq_path_prefix,
+										int flags, /*bool*/ int goodshadows) {
+	struct decoded_seq* d = new decoded_seq();
+	d->seq_path_prefix = strdup(seq_path_prefix);
+	d->flags = flags;
+	d->goodshadows = goodshadows;
+	return d;
+}
+
+/**
+ * Whether sequences decoded from now on get redink1's shadow patch.
+ * The debug UI can toggle it, so read it on the main thread and pass
+ * it along to the loader threads.
+ */
+/*bool*/ int gfx_sprites_goodshadows(void) {
+	return truecolor && dbg.debug_goodshadows;
+}
+
+static void decoded_seq_free(struct decoded_seq* d) {
+	for (auto& frame : d->frames)
+		if (frame.surf != NULL)
+			SDL_FreeSurface(frame.surf);
+	free(d->seq_path_prefix);
+	free(d->fullpath);
+	delete d;
+}
+
+static void frame_error(struct decoded_frame* frame, const char* fmt, ...) {
+	char buf[512];
+	va_list ap;
+	va_start(ap, fmt);
+	vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+	frame->errors.push_back(buf);
+}
+
+static struct decoded_frame* add_frame(struct decoded_seq* d) {
+	d->frames.emplace_back();
+	struct decoded_frame* frame = &d->frames.back();
+	frame->surf = NULL;
+	frame->name[0] = '\0';
+	frame->last = 0;
+	return frame;
+}
+
+/**
+ * Decode the frames of a dir.ff sequence. Doesn't log, and only uses
+ * its own handle on the archive, so that it can run in a loader
+ * thread.
+ */
+static void decode_seq_pak(struct decoded_seq* d) {
 	char fname[20];
 	char crap[200];
 
-	int notanim = 0, black = 0, leftalign = 0;
-	if ((flags & DINKINI_NOTANIM) == DINKINI_NOTANIM)
-		notanim = 1;
-	if ((flags & DINKINI_BLACK) == DINKINI_BLACK)
+	int black = 0, leftalign = 0;
+	if ((d->flags & DINKINI_BLACK) == DINKINI_BLACK)
 		black = 1;
-	if ((flags & DINKINI_LEFTALIGN) == DINKINI_LEFTALIGN)
+	if ((d->flags & DINKINI_LEFTALIGN) == DINKINI_LEFTALIGN)
 		leftalign = 1;
 
-	/* If the sequence already exists, free it first */
-	free_seq(seq_no);
-
-	if (gfx_sprites_loading_listener)
-		gfx_sprites_loading_listener();
-
-	char* seq_dirname = pdirname(seq_path_prefix);
-	int n = strlen(seq_path_prefix) - strlen(seq_dirname) - 1;
-	char* fullpath = NULL;
-	strcpy(fname, &seq_path_prefix[strlen(seq_path_prefix) - n]);
+	char* seq_dirname = pdirname(d->seq_path_prefix);
+	int n = strlen(d->seq_path_prefix) - strlen(seq_dirname) - 1;
+	strcpy(fname, &d->seq_path_prefix[strlen(d->seq_path_prefix) - n]);
 	sprintf(crap, "%s/dir.ff", seq_dirname);
-	if (samedir)
-		fullpath = paths_dmodfile(crap);
+	strcpy(d->crap, crap);
+	if (d->samedir)
+		d->fullpath = paths_dmodfile(crap);
 	else
-		fullpath = paths_fallbackfile(crap);
+		d->fullpath = paths_fallbackfile(crap);
+	free(seq_dirname);
 
-	if (!FastFileInit(fullpath, 5)) {
-		log_error("🎭 Could not load dir.ff art file %s", crap);
-		free(fullpath);
-		free(seq_dirname);
+	struct FF_Reader* ff = FastFileReaderOpen(d->fullpath);
+	if (ff == NULL) {
+		d->no_archive = 1;
 		return;
 	}
-	free(seq_dirname);
-	/* keep 'fullpath' for error messages, free() it later */
+
+	/* The index remapping below depends on these */
+	int cache_flags = d->flags & (DINKINI_BLACK | DINKINI_LEFTALIGN);
 
 	int oo;
 	for (oo = 1; oo <= MAX_FRAMES_PER_SEQUENCE; oo++) {
-		int myslot = next_slot();
-		if (myslot >= MAX_SPRITES) {
-			log_error("🧚‍♀️ No sprite slot available! Index %d out of %d.", myslot,
-					MAX_SPRITES);
-			break;
-		}
+		struct decoded_frame* frame = add_frame(d);
 
 		char* leading_zero = NULL;
 		//load sprite
@@ -218,41 +380,49 @@ void load_sprite_pak(char seq_path_prefix[100], int seq_no, int delay,
 		else
 			leading_zero = "";
 
-		sprintf(crap, "%s%s%d.bmp", fname, leading_zero, oo);
+		sprintf(frame->name, "%s%s%d.bmp", fname, leading_zero, oo);
 
-		FF_Handle* pfile = FastFileOpen(crap);
-
-		if (pfile == NULL)
+		if (!FastFileReaderHas(ff, frame->name)) {
 			/* File not present in this fastfile - either missing file or
 end of sequence */
+			frame->last = 1;
 			break;
+		}
+
+		frame->surf = gfx_diskcache_load(d->fullpath, frame->name, cache_flags);
+		if (frame->surf != NULL)
+			continue;
+
+		SDL_RWops* rw = NULL;
+		FastFileReaderGet(ff, frame->name, &rw);
 
 		// GFX
 		SDL_Surface* surf = NULL;
-		SDL_RWops* rw = FastFileLock(pfile);
 		if (rw == NULL) {
 			/* rwops error? */
-			log_error("🦔 Failed to open '%s' in fastfile '%s'", crap, fullpath);
+			frame_error(frame, "🦔 Failed to open '%s' in fastfile '%s'",
+						frame->name, d->fullpath);
 		} else {
 			/* We use IMG_Load_RW instead of SDL_LoadBMP because there
 is no _RW access in plain SDL. However there is no
 intent to support anything else than 8bit BMPs. */
 			surf = IMG_Load_RW(rw, 1); // auto free()
 			if (surf == NULL)
-				log_error("🦔 Failed to load %s from fastfile %s: %s", crap,
-						fullpath, SDL_GetError());
+				frame_error(frame, "🦔 Failed to load %s from fastfile %s: %s",
+							frame->name, d->fullpath, SDL_GetError());
 		}
 		if (surf == NULL) {
-			log_error("🦔 Failed to load %s from fastfile %s (see error above)",
-					crap, fullpath);
-			FastFileClose(pfile);
+			frame_error(frame,
+						"🦔 Failed to load %s from fastfile %s (see error above)",
+						frame->name, d->fullpath);
+			frame->last = 1;
 			break;
 		}
 		if (surf->format->BitsPerPixel != 8) {
-			log_error("🦔 Failed to load %s from fastfile %s:"
-					" only 8bit paletted bitmaps are supported in dir.ff "
-					"archives.",
-					crap, fullpath);
+			frame_error(frame, "🦔 Failed to load %s from fastfile %s:"
+						" only 8bit paletted bitmaps are supported in dir.ff "
+						"archives.",
+						frame->name, d->fullpath);
 			SDL_FreeSurface(surf);
 			continue;
 		}
@@ -321,171 +491,33 @@ intent to support anything else than 8bit BMPs. */
 			SDL_SetColorKey(surf, SDL_TRUE, 0);
 		}
 
-		k[myslot].box.top = 0;
-		k[myslot].box.left = 0;
-		k[myslot].box.right = surf->w;
-		k[myslot].box.bottom = surf->h;
-
-		GFX_k[myslot].k = g_display->upload(surf);
-		surf = NULL;
-
-		/* Define the offsets / center of the image */
-		if (yoffset > 0) {
-			// explicitely set center
-			k[myslot].yoffset = yoffset;
-		} else {
-			if (oo > 1 && notanim)
-				// copy first frame info
-				k[myslot].yoffset = k[seq[seq_no].frame[1]].yoffset;
-			else
-				// compute default center
-				k[myslot].yoffset =
-						(k[myslot].box.bottom - (k[myslot].box.bottom / 4)) -
-						(k[myslot].box.bottom / 30);
-		}
-
-		if (xoffset > 0) {
-			// explicitely set center
-			k[myslot].xoffset = xoffset;
-		} else {
-			if (oo > 1 && notanim)
-				// copy first frame info
-				k[myslot].xoffset = k[seq[seq_no].frame[1]].xoffset;
-			else
-				// compute default center
-				k[myslot].xoffset =
-						(k[myslot].box.right - (k[myslot].box.right / 2)) +
-						(k[myslot].box.right / 6);
-		}
-		//ok, setup main offsets, lets build the hard block
-
-		if (hardbox.right > 0) {
-			//forced setting
-			k[myslot].hardbox.left = hardbox.left;
-			k[myslot].hardbox.right = hardbox.right;
-		} else {
-			//guess setting
-			int work = k[myslot].box.right / 4;
-			k[myslot].hardbox.left -= work;
-			k[myslot].hardbox.right += work;
-		}
-
-		if (hardbox.bottom > 0) {
-			k[myslot].hardbox.top = hardbox.top;
-			k[myslot].hardbox.bottom = hardbox.bottom;
-		} else {
-			int work = k[myslot].box.bottom / 10;
-			k[myslot].hardbox.top -= work;
-			k[myslot].hardbox.bottom += work;
-		}
-		FastFileClose(pfile);
-
-		seq[seq_no].frame[oo] = myslot;
-		seq[seq_no].delay[oo] = delay;
+		gfx_diskcache_store(d->fullpath, frame->name, cache_flags, surf);
+		frame->surf = surf;
 	}
-	FastFileFini();
-
-	/* Mark end-of-sequence */
-	seq[seq_no].frame[oo] = 0;
-	/* Length: inaccurate if 'set_frame_frame' is used */
-	seq[seq_no].len = oo - 1;
-
-	if (oo == 1)
-		log_error("🦔 Sprite_load_pak error:  Couldn't load %s in %s.", crap,
-				fullpath);
-	free(fullpath);
+	FastFileReaderClose(ff);
 }
 
-/* Load sprite, either from a dir.ff pack (delegated to
-load_sprite_pak), either from a BMP file */
-/* - seq_path_prefix: path to the file, relative to the current game (dink or dmod) */
-/* - not_anim: reuse xoffset and yoffset from the first frame of the animation (misnomer) */
-void load_sprites(char seq_path_prefix[100], int seq_no, int delay, int xoffset,
-				int yoffset, rect hardbox, int flags) {
-	char crap[200];
-	char* fullpath = NULL;
-	int use_fallback = 0;
-
-	int notanim = 0, black = 0;
-	if ((flags & DINKINI_NOTANIM) == DINKINI_NOTANIM)
-		notanim = 1;
-	if ((flags & DINKINI_BLACK) == DINKINI_BLACK)
+/**
+ * Decode the frames of a sequence stored as separate BMP/PNG files
+ */
+static void decode_seq_files(struct decoded_seq* d) {
+	int black = 0;
+	if ((d->flags & DINKINI_BLACK) == DINKINI_BLACK)
 		black = 1;
 
-	if (gfx_sprites_loading_listener)
-		gfx_sprites_loading_listener();
-
-	/* Order: */
-	/* - dmod/.../dir.ff */
-	/* Yeolde: Dmod .png */
-	/* - dmod/.../...01.BMP */
-	/* - ../dink/.../dir.ff */
-	/* - ../dink/.../...01.BMP */
-	char* seq_dirname = pdirname(seq_path_prefix);
-	int exists = 0;
-
-	if (!exists) {
-		sprintf(crap, "%s/dir.ff", seq_dirname);
-		fullpath = paths_dmodfile(crap);
-		exists = exist(fullpath);
-		free(fullpath);
-		if (exists) {
-			free(seq_dirname);
-			load_sprite_pak(seq_path_prefix, seq_no, delay, xoffset, yoffset,
-							hardbox, flags, /*true*/ 1);
-			return;
-		}
-	}
-
-	if (!exists) {
-		//Yeolde: Changed this to PNG
-		sprintf(crap, "%s01.PNG", seq_path_prefix);
-		fullpath = paths_dmodfile(crap);
-		exists = exist(fullpath);
-		free(fullpath);
-	}
-
-	if (!exists) {
-		sprintf(crap, "%s01.BMP", seq_path_prefix);
-		fullpath = paths_dmodfile(crap);
-		exists = exist(fullpath);
-		free(fullpath);
-	}
-
-	if (!exists) {
-		sprintf(crap, "%s/dir.ff", seq_dirname);
-		fullpath = paths_fallbackfile(crap);
-		exists = exist(fullpath);
-		free(fullpath);
-		if (exists) {
-			free(seq_dirname);
-			load_sprite_pak(seq_path_prefix, seq_no, delay, xoffset, yoffset,
-							hardbox, flags, /*false*/ 0);
-			return;
-		}
-	}
-
-	if (!exists) {
-		/* Let's look for the BMP below */
-		use_fallback = 1;
-	}
-
-	free(seq_dirname);
-
-	/* If the sequence already exists, free it first */
-	free_seq(seq_no);
+	/* Transparent color, and whether the shadow patch runs */
+	int cache_flags = d->flags & DINKINI_BLACK;
+	if (d->goodshadows)
+		cache_flags |= GFX_DISKCACHE_GOODSHADOWS;
 
 	/* Load the whole sequence (prefix-01.bmp, prefix-02.bmp, ...) */
 	int oo;
 	for (oo = 1; oo <= MAX_FRAMES_PER_ABUSED_SEQUENCE; oo++) {
-		int myslot = next_slot();
-		if (myslot >= MAX_SPRITES) {
-			log_error("🙈 No sprite slot available! Index %d out of %d.", myslot,
-					MAX_SPRITES);
-			break;
-		}
+		struct decoded_frame* frame = add_frame(d);
+		char* crap = frame->name;
 
 		FILE* in = NULL;
+		char* fullpath = NULL;
 		char* leading_zero = NULL;
 		if (oo < 10)
 			leading_zero = "0";
@@ -494,24 +526,39 @@ void load_sprites(char seq_path_prefix[100], int seq_no, int delay, int xoffset,
 		//Yeolde: changed this so it can support PNGs without having to do that renaming crap
 
 		/* Set the pixel data */
-		if (use_fallback) {
+		if (!d->samedir) {
 			//Yeolde: This will mean it will always expect bmps in your main data
-			sprintf(crap, "%s%s%d.bmp", seq_path_prefix, leading_zero, oo);
-			in = paths_fallbackfile_fopen(crap, "rb");
+			sprintf(crap, "%s%s%d.bmp", d->seq_path_prefix, leading_zero, oo);
+			fullpath = paths_fallbackfile(crap);
+			in = fopen(fullpath, "rb");
 		}
 		else {
-			sprintf(crap, "%s%s%d.png", seq_path_prefix, leading_zero, oo);
-			in = paths_dmodfile_fopen(crap, "rb");
+			sprintf(crap, "%s%s%d.png", d->seq_path_prefix, leading_zero, oo);
+			fullpath = paths_dmodfile(crap);
+			in = fopen(fullpath, "rb");
 			//Get a bmp instead
 			if (!in) {
-				sprintf(crap, "%s%s%d.bmp", seq_path_prefix, leading_zero, oo);
-				in = paths_dmodfile_fopen(crap, "rb");
+				free(fullpath);
+				sprintf(crap, "%s%s%d.bmp", d->seq_path_prefix, leading_zero, oo);
+				fullpath = paths_dmodfile(crap);
+				in = fopen(fullpath, "rb");
+			}
+		}
+
+		if (in != NULL) {
+			frame->surf = gfx_diskcache_load(fullpath, NULL, cache_flags);
+			if (frame->surf != NULL) {
+				fclose(in);
+				free(fullpath);
+				continue;
 			}
 		}
 
 		SDL_Surface* surf = ImageLoader::loadToBlitFormat(in);
 		if (surf == NULL) {
 			// end of sequence
+			free(fullpath);
+			frame->last = 1;
 			break;
 		}
 
@@ -523,20 +570,12 @@ void load_sprites(char seq_path_prefix[100], int seq_no, int delay, int xoffset,
 			SDL_SetColorKey(surf, SDL_TRUE,
 							SDL_MapRGB(surf->format, 255, 255, 255));
 
-		/* Fill in .box; this was previously done in DDSethLoad; in
-		the future we could get rid of the .box field and rely
-		directly on SDL_Surface's .w and .h fields instead: */
-		k[myslot].box.top = 0;
-		k[myslot].box.left = 0;
-		k[myslot].box.right = surf->w;
-		k[myslot].box.bottom = surf->h;
-
 		// Let's put a half-assed reimplementation of redink1's shadow patch here
 		//TODO: actually let's put a thing here to convert white to transparent
 		SDL_PixelFormat *fmt;
 		Uint32 alph, r, g, b;
 		SDL_Surface *converted = NULL;
-		if (surf->h > 1 && surf->w > 1 && truecolor && dbg.debug_goodshadows)
+		if (surf->h > 1 && surf->w > 1 && d->goodshadows)
 		{
 			converted = SDL_ConvertSurfaceFormat(surf, SDL_PIXELFORMAT_ARGB32, 0);
 			fmt = converted->format;
@@ -586,11 +625,143 @@ void load_sprites(char seq_path_prefix[100], int seq_no, int delay, int xoffset,
 				}
 			}
 			SDL_UnlockSurface(converted);
-			GFX_k[myslot].k = g_display->upload(converted);
+			SDL_FreeSurface(surf);
+			surf = converted;
 		}
-		else {
-		GFX_k[myslot].k = g_display->upload(surf);
+		gfx_diskcache_store(fullpath, NULL, cache_flags, surf);
+		free(fullpath);
+		frame->surf = surf;
+	}
+}
+
+/**
+ * Find where a sequence is stored, then decode it
+ */
+static void decode_seq(struct decoded_seq* d) {
+	char crap[200];
+	char* fullpath = NULL;
+
+	/* Order: */
+	/* - dmod/.../dir.ff */
+	/* Yeolde: Dmod .png */
+	/* - dmod/.../...01.BMP */
+	/* - ../dink/.../dir.ff */
+	/* - ../dink/.../...01.BMP */
+	char* seq_dirname = pdirname(d->seq_path_prefix);
+	int exists = 0;
+
+	if (!exists) {
+		sprintf(crap, "%s/dir.ff", seq_dirname);
+		fullpath = paths_dmodfile(crap);
+		exists = exist(fullpath);
+		free(fullpath);
+		if (exists) {
+			free(seq_dirname);
+			d->source = SEQ_SOURCE_PAK;
+			d->samedir = /*true*/ 1;
+			decode_seq_pak(d);
+			return;
 		}
+	}
+
+	if (!exists) {
+		//Yeolde: Changed this to PNG
+		sprintf(crap, "%s01.PNG", d->seq_path_prefix);
+		fullpath = paths_dmodfile(crap);
+		exists = exist(fullpath);
+		free(fullpath);
+	}
+
+	if (!exists) {
+		sprintf(crap, "%s01.BMP", d->seq_path_prefix);
+		fullpath = paths_dmodfile(crap);
+		exists = exist(fullpath);
+		free(fullpath);
+	}
+
+	if (!exists) {
+		sprintf(crap, "%s/dir.ff", seq_dirname);
+		fullpath = paths_fallbackfile(crap);
+		exists = exist(fullpath);
+		free(fullpath);
+		if (exists) {
+			free(seq_dirname);
+			d->source = SEQ_SOURCE_PAK;
+			d->samedir = /*false*/ 0;
+			decode_seq_pak(d);
+			return;
+		}
+	}
+
+	free(seq_dirname);
+
+	d->source = SEQ_SOURCE_FILES;
+	/* If not found, let's look for the BMP in the fallback data */
+	d->samedir = exists;
+	strcpy(d->crap, crap);
+	decode_seq_files(d);
+}
+
+/**
+ * Assign GFX_k slots to decoded frames and fill in k[] and seq[]
+ */
+static void load_decoded_seq(struct decoded_seq* d, int seq_no, int delay,
+							int xoffset, int yoffset, rect hardbox) {
+	int pak = (d->source == SEQ_SOURCE_PAK);
+	int notanim = 0;
+	if ((d->flags & DINKINI_NOTANIM) == DINKINI_NOTANIM)
+		notanim = 1;
+	char* crap = d->crap;
+
+	/* If the sequence already exists, free it first */
+	free_seq(seq_no);
+
+	if (pak) {
+		if (gfx_sprites_loading_listener)
+			gfx_sprites_loading_listener();
+
+		if (d->no_archive) {
+			log_error("🎭 Could not load dir.ff art file %s", d->crap);
+			return;
+		}
+	}
+
+	int max_frames = pak ? MAX_FRAMES_PER_SEQUENCE : MAX_FRAMES_PER_ABUSED_SEQUENCE;
+	int oo;
+	for (oo = 1; oo <= max_frames; oo++) {
+		int myslot = next_slot();
+		if (myslot >= MAX_SPRITES) {
+			if (pak)
+				log_error("🧚‍♀️ No sprite slot available! Index %d out of %d.", myslot,
+						MAX_SPRITES);
+			else
+				log_error("🙈 No sprite slot available! Index %d out of %d.", myslot,
+						MAX_SPRITES);
+			break;
+		}
+
+		if (oo > (int)d->frames.size())
+			break;
+		struct decoded_frame* frame = &d->frames[oo - 1];
+		crap = frame->name;
+		for (auto& error : frame->errors)
+			log_error("%s", error.c_str());
+		if (frame->last)
+			break;
+		if (frame->surf == NULL)
+			continue;
+
+		/* Fill in .box; this was previously done in DDSethLoad; in
+		the future we could get rid of the .box field and rely
+		directly on SDL_Surface's .w and .h fields instead: */
+		k[myslot].box.top = 0;
+		k[myslot].box.left = 0;
+		k[myslot].box.right = frame->surf->w;
+		k[myslot].box.bottom = frame->surf->h;
+
+		slot_set(myslot, g_display->upload(frame->surf));
+		frame->surf = NULL;
+
 		/* Define the offsets / center of the image */
 		if (yoffset > 0) {
 			// explicitely set center
@@ -659,9 +830,248 @@ void load_sprites(char seq_path_prefix[100], int seq_no, int delay, int xoffset,
 
 	if (oo == 1) {
 		/* First frame didn't load! */
-		log_error("🙊 load_sprites: anim '%s' not found: couldn't open '%s'",
-				seq_path_prefix, crap);
+		if (pak)
+			log_error("🦔 Sprite_load_pak error:  Couldn't load %s in %s.", crap,
+					d->fullpath);
+		else
+			log_error("🙊 load_sprites: anim '%s' not found: couldn't open '%s'",
+					d->seq_path_prefix, crap);
+	}
+}
+
+/**
+ * Decoding ahead of time: load_batch() queues the dink.ini sequences
+ * in order, loader threads decode them, and load_sprites() picks them
+ * up when it reaches the same path and flags. Sequences that weren't
+ * queued are decoded on the spot.
+ */
+enum prefetch_state { PREFETCH_PENDING, PREFETCH_RUNNING, PREFETCH_DONE };
+struct prefetch_job {
+	struct decoded_seq* d;
+	enum prefetch_state state;
+	/*bool*/ int taken;
+};
+/* Don't decode too far ahead of the main thread, to cap memory use */
+#define PREFETCH_WINDOW 64
+
+/* Number of loader threads; -1 = one per extra CPU core, 0 = none */
+int gfx_sprites_decode_threads = -1;
+
+static std::vector<struct prefetch_job> prefetch_jobs;
+static size_t prefetch_next = 0; // first job not started
+static size_t prefetch_first_untaken = 0;
+static size_t prefetch_nb_taken = 0;
+static /*bool*/ int prefetch_stopping = 0;
+#ifndef __EMSCRIPTEN__
+static std::mutex prefetch_mutex;
+static std::condition_variable prefetch_cond;
+static std::vector<std::thread> prefetch_workers;
+
+static void prefetch_worker() {
+	std::unique_lock<std::mutex> lock(prefetch_mutex);
+	while (!prefetch_stopping) {
+		while (prefetch_next < prefetch_jobs.size()
+			&& prefetch_jobs[prefetch_next].state != PREFETCH_PENDING)
+			prefetch_next++;
+		size_t i = prefetch_next;
+		if (i < prefetch_jobs.size() && i < prefetch_nb_taken + PREFETCH_WINDOW) {
+			prefetch_jobs[i].state = PREFETCH_RUNNING;
+			struct decoded_seq* d = prefetch_jobs[i].d;
+			lock.unlock();
+			decode_seq(d);
+			lock.lock();
+			prefetch_jobs[i].state = PREFETCH_DONE;
+			prefetch_cond.notify_all();
+		} else {
+			prefetch_cond.wait(lock);
+		}
+	}
+}
+#endif
+
+void gfx_sprites_prefetch_start(void) {
+#ifndef __EMSCRIPTEN__
+	int nb_threads = gfx_sprites_decode_threads;
+	if (nb_threads < 0) {
+		nb_threads = SDL_GetCPUCount() - 1;
+		if (nb_threads < 1)
+			nb_threads = 1;
+		if (nb_threads > 8)
+			nb_threads = 8;
+	}
+	prefetch_stopping = 0;
+	for (int i = 0; i < nb_threads; i++)
+		prefetch_workers.emplace_back(prefetch_worker);
+#endif
+}
+
+/**
+ * Queue a sequence for decoding, in the order it will be loaded
+ */
+void gfx_sprites_prefetch(char* seq_path_prefix, int flags) {
+#ifndef __EMSCRIPTEN__
+	if (prefetch_workers.empty())
+		return;
+	std::lock_guard<std::mutex> lock(prefetch_mutex);
+	struct prefetch_job job;
+	job.d = decoded_seq_new(seq_path_prefix, flags, gfx_sprites_goodshadows());
+	job.state = PREFETCH_PENDING;
+	job.taken = 0;
+	prefetch_jobs.push_back(job);
+	prefetch_cond.notify_one();
+#endif
+}
+
+/**
+ * Get the decoded frames for this sequence, if it was queued
+ */
+static struct decoded_seq* prefetch_take(char* seq_path_prefix, int flags) {
+#ifndef __EMSCRIPTEN__
+	std::unique_lock<std::mutex> lock(prefetch_mutex);
+	size_t i;
+	for (i = prefetch_first_untaken; i < prefetch_jobs.size(); i++)
+		if (!prefetch_jobs[i].taken && prefetch_jobs[i].d->flags == flags
+			&& strcmp(prefetch_jobs[i].d->seq_path_prefix, seq_path_prefix) == 0)
+			break;
+	if (i == prefetch_jobs.size())
+		return NULL;
+
+	prefetch_jobs[i].taken = 1;
+	prefetch_nb_taken++;
+	while (prefetch_first_untaken < prefetch_jobs.size()
+		&& prefetch_jobs[prefetch_first_untaken].taken)
+		prefetch_first_untaken++;
+	prefetch_cond.notify_all();
+
+	struct decoded_seq* d = prefetch_jobs[i].d;
+	if (prefetch_jobs[i].state == PREFETCH_PENDING) {
+		/* Not started yet, don't wait for a loader thread */
+		prefetch_jobs[i].state = PREFETCH_RUNNING;
+		lock.unlock();
+		decode_seq(d);
+		lock.lock();
+		prefetch_jobs[i].state = PREFETCH_DONE;
+	} else {
+		while (prefetch_jobs[i].state != PREFETCH_DONE)
+			prefetch_cond.wait(lock);
+	}
+	prefetch_jobs[i].d = NULL;
+	return d;
+#else
+	return NULL;
+#endif
+}
+
+/**
+ * Stop the loader threads and drop what wasn't picked up
+ */
+void gfx_sprites_prefetch_stop(void) {
+#ifndef __EMSCRIPTEN__
+	{
+		std::lock_guard<std::mutex> lock(prefetch_mutex);
+		prefetch_stopping = 1;
+		prefetch_cond.notify_all();
+	}
+	for (auto& worker : prefetch_workers)
+		worker.join();
+	prefetch_workers.clear();
+	for (auto& job : prefetch_jobs)
+		if (job.d != NULL)
+			decoded_seq_free(job.d);
+	prefetch_jobs.clear();
+	prefetch_next = 0;
+	prefetch_first_untaken = 0;
+	prefetch_nb_taken = 0;
+#endif
+}
+
+/**
+ * Sequences decoded ahead of a screen change, see screen_prefetch.cpp.
+ * Unlike the dink.ini batch they may never be loaded, so only the
+ * latest few are kept.
+ */
+#define WARM_MAX 64
+static std::vector<struct decoded_seq*> warm_seqs; // oldest first
+static std::mutex warm_mutex;
+
+static std::vector<struct decoded_seq*>::iterator warm_find(const char* seq_path_prefix,
+															int flags, /*bool*/ int goodshadows) {
+	for (auto it = warm_seqs.begin(); it != warm_seqs.end(); it++)
+		if ((*it)->flags == flags && (*it)->goodshadows == goodshadows
+			&& strcmp((*it)->seq_path_prefix, seq_path_prefix) == 0)
+			return it;
+	return warm_seqs.end();
+}
+
+/**
+ * Decode a sequence so that load_sprites() can pick it up later. Can
+ * be called from any thread.
+ */
+void gfx_sprites_warm(const char* seq_path_prefix, int flags,
+					/*bool*/ int goodshadows) {
+	{
+		std::lock_guard<std::mutex> lock(warm_mutex);
+		if (warm_find(seq_path_prefix, flags, goodshadows) != warm_seqs.end())
+			return;
+	}
+	struct decoded_seq* d = decoded_seq_new(seq_path_prefix, flags, goodshadows);
+	decode_seq(d);
+
+	std::lock_guard<std::mutex> lock(warm_mutex);
+	warm_seqs.push_back(d);
+	if (warm_seqs.size() > WARM_MAX) {
+		decoded_seq_free(warm_seqs.front());
+		warm_seqs.erase(warm_seqs.begin());
+	}
+}
+
+static struct decoded_seq* warm_take(const char* seq_path_prefix, int flags) {
+	std::lock_guard<std::mutex> lock(warm_mutex);
+	auto it = warm_find(seq_path_prefix, flags, gfx_sprites_goodshadows());
+	if (it == warm_seqs.end())
+		return NULL;
+	struct decoded_seq* d = *it;
+	warm_seqs.erase(it);
+	return d;
+}
+
+void gfx_sprites_warm_clear(void) {
+	std::lock_guard<std::mutex> lock(warm_mutex);
+	for (auto d : warm_seqs)
+		decoded_seq_free(d);
+	warm_seqs.clear();
+}
+
+//ye: load from fastfile
+void load_sprite_pak(char seq_path_prefix[100], int seq_no, int delay,
+					int xoffset, int yoffset, rect hardbox, int flags,
+					/*bool*/ int samedir) {
+	struct decoded_seq* d = decoded_seq_new(seq_path_prefix, flags,
+											gfx_sprites_goodshadows());
+	d->source = SEQ_SOURCE_PAK;
+	d->samedir = samedir;
+	decode_seq_pak(d);
+	load_decoded_seq(d, seq_no, delay, xoffset, yoffset, hardbox);
+	decoded_seq_free(d);
+}
+
+/* Load sprite, either from a dir.ff pack, either from a BMP file */
+/* - seq_path_prefix: path to the file, relative to the current game (dink or dmod) */
+/* - not_anim: reuse xoffset and yoffset from the first frame of the animation (misnomer) */
+void load_sprites(char seq_path_prefix[100], int seq_no, int delay, int xoffset,
+				int yoffset, rect hardbox, int flags) {
+	if (gfx_sprites_loading_listener)
+		gfx_sprites_loading_listener();
+
+	struct decoded_seq* d = prefetch_take(seq_path_prefix, flags);
+	if (d == NULL)
+		d = warm_take(seq_path_prefix, flags);
+	if (d == NULL) {
+		d = decoded_seq_new(seq_path_prefix, flags, gfx_sprites_goodshadows());
+		decode_seq(d);
 	}
+	load_decoded_seq(d, seq_no, delay, xoffset, yoffset, hardbox);
+	decoded_seq_free(d);
 }
 
 /**
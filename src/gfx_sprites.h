@@ -76,7 +76,15 @@ extern struct pic_info k[MAX_SPRITES];
 extern struct GFX_pic_info GFX_k[MAX_SPRITES];
 extern struct sequence seq[MAX_SEQUENCES];
 
+/* GFX_k occupancy */
+struct gfx_sprites_slot_stats {
+	int used, capacity;
+	int lowest_free; // next slot a frame will get
+	int highest_used; // 0 if none
+};
+
 extern void sprites_unload(void);
+extern void gfx_sprites_get_slot_stats(struct gfx_sprites_slot_stats* stats);
 extern void load_sprite_pak(char seq_path_prefix[100], int seq_no, int speed,
 							int xoffset, int yoffset, rect hardbox, int flags,
 							int samedir);
@@ -84,6 +92,15 @@ extern void load_sprites(char seq_path_prefix[100], int seq_no, int speed,
 						int xoffset, int yoffset, rect hardbox, int flags);
 extern void seq_set_ini(int seq_no, char* line);
 
+extern int gfx_sprites_decode_threads;
+extern void gfx_sprites_prefetch_start(void);
+extern void gfx_sprites_prefetch(char* seq_path_prefix, int flags);
+extern void gfx_sprites_prefetch_stop(void);
+extern /*bool*/ int gfx_sprites_goodshadows(void);
+extern void gfx_sprites_warm(const char* seq_path_prefix, int flags,
+							/*bool*/ int goodshadows);
+extern void gfx_sprites_warm_clear(void);
+
 extern void (*gfx_sprites_loading_listener)();
 
 extern /*bool*/ int not_in_this_base(int seq, int base);
@@ -55,7 +55,7 @@ void save_hard(void) {
 	for (i = 0; i < HARDNESS_NB_TILES; i++) {
 		for (int x = 0; x < 50 + 1; x++)
 			for (int y = 0; y < 50 + 1; y++)
-				fwrite(&hmap.htile[i].hm[x][y], 1, 1, f);
+				fwrite(&hmap.htile[i].rows[y][x], 1, 1, f);
 		fputc(hmap.htile[i].used, f);
 		fwrite(skipbuf, 2, 1, f); // reproduce memory alignment
 		fwrite(skipbuf, 4, 1, f); // unused 'hold' field
@@ -113,7 +113,7 @@ void load_hard(void) {
 		//memset(&hmap.htile[i], mmap[i * 2608], sizeof(ts_block));
 		for (int x = 0; x < 50 + 1; x++)
 			for (int y = 0; y < 50 + 1; y++)
-				fread(&hmap.htile[i].hm[x][y], 1, 1, f);
+				fread(&hmap.htile[i].rows[y][x], 1, 1, f);
 		hmap.htile[i].used = fgetc(f);
 		fread(skipbuf, 2, 1, f); // reproduce memory alignment
 		fread(skipbuf, 4, 1, f); // unused 'hold' field
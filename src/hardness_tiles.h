@@ -28,7 +28,9 @@
  * 1 hardness block
  */
 struct ts_block {
-	unsigned char hm[50 + 1][50 + 1]; // tile hardness/hitmap
+	/* tile hardness/hitmap, row-major (rows[y][x]) so that tile rows can
+	be block-copied to screen_hitmap; hard.dat stores it x-major */
+	unsigned char rows[50 + 1][50 + 1];
 	BOOL_1BYTE used;
 };
 
@@ -0,0 +1,287 @@
+/**
+ * Input record/replay, for reproducible play-throughs
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "input_replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "game_engine.h"
+#include "input.h"
+#include "io_util.h"
+#include "log.h"
+
+/* Log format, little-endian:
+     "YDRP", version (short), sizeof(SDL_Event) (short),
+     random seed (uint), starting game clock (2 x uint)
+   then for each frame:
+     'F', ms since the previous frame (uint)
+     'E', event type (uint), payload size (short), payload
+   for each SDL event the game received that frame. Payloads are the
+   raw SDL event structs, so logs are only portable across builds with
+   the same SDL ABI.
+   Input typed into the debug console (while ImGui has the keyboard)
+   is not recorded, and pausing on focus loss is off while recording
+   or replaying. */
+#define REPLAY_MAGIC "YDRP"
+#define REPLAY_VERSION 1
+
+static enum input_replay_mode replay_mode = INPUT_REPLAY_OFF;
+static FILE* replay_file = NULL;
+static char* replay_path = NULL;
+static int next_tag = EOF;
+static Uint64 last_wall_ticks = 0;
+static Uint64 frame = 0;
+static unsigned int seed = 0;
+
+enum input_replay_mode input_replay_get_mode() {
+	return replay_mode;
+}
+
+Uint64 input_replay_get_frame() {
+	return frame;
+}
+
+unsigned int input_replay_get_seed() {
+	return seed;
+}
+
+/* Size of the part of SDL_Event used by 'type', 0 for events the
+game doesn't look at */
+static size_t event_size(Uint32 type) {
+	switch (type) {
+	case SDL_QUIT:
+		return sizeof(SDL_QuitEvent);
+	case SDL_WINDOWEVENT:
+		return sizeof(SDL_WindowEvent);
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+		return sizeof(SDL_KeyboardEvent);
+	case SDL_TEXTEDITING:
+		return sizeof(SDL_TextEditingEvent);
+	case SDL_TEXTINPUT:
+		return sizeof(SDL_TextInputEvent);
+	case SDL_MOUSEMOTION:
+		return sizeof(SDL_MouseMotionEvent);
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+		return sizeof(SDL_MouseButtonEvent);
+	case SDL_MOUSEWHEEL:
+		return sizeof(SDL_MouseWheelEvent);
+	case SDL_CONTROLLERAXISMOTION:
+		return sizeof(SDL_ControllerAxisEvent);
+	case SDL_CONTROLLERBUTTONDOWN:
+	case SDL_CONTROLLERBUTTONUP:
+		return sizeof(SDL_ControllerButtonEvent);
+	case SDL_CONTROLLERDEVICEADDED:
+	case SDL_CONTROLLERDEVICEREMOVED:
+	case SDL_CONTROLLERDEVICEREMAPPED:
+		return sizeof(SDL_ControllerDeviceEvent);
+	case SDL_FINGERDOWN:
+	case SDL_FINGERUP:
+	case SDL_FINGERMOTION:
+		return sizeof(SDL_TouchFingerEvent);
+	default:
+		return 0;
+	}
+}
+
+/* Controllers are polled rather than read from events, so they'd slip
+past the log */
+static void disable_polled_input() {
+	if (joystick)
+		log_info("🎥 Joystick disabled while recording or replaying input");
+	joystick = 0;
+}
+
+/**
+ * Start logging input to 'path'. Seeds the random generators and
+ * switches the game to a clock sampled once per frame, so that a
+ * replay sees the same values.
+ */
+/*bool*/ int input_replay_record(const char* path) {
+	input_replay_stop();
+	replay_file = fopen(path, "wb");
+	if (replay_file == NULL) {
+		log_error("🎥 Cannot record input to %s: %s", path, strerror(errno));
+		return 0;
+	}
+
+	seed = (unsigned int)time(NULL) ^ (unsigned int)SDL_GetPerformanceCounter();
+	last_wall_ticks = SDL_GetTicks64();
+	fwrite(REPLAY_MAGIC, 4, 1, replay_file);
+	write_lsb_short(REPLAY_VERSION, replay_file);
+	write_lsb_short(sizeof(SDL_Event), replay_file);
+	write_lsb_uint(seed, replay_file);
+	write_lsb_uint(last_wall_ticks & 0xFFFFFFFF, replay_file);
+	write_lsb_uint(last_wall_ticks >> 32, replay_file);
+
+	game_seed_random(seed);
+	game_start_fixed_clock(last_wall_ticks);
+	disable_polled_input();
+	replay_path = strdup(path);
+	replay_mode = INPUT_REPLAY_RECORD;
+	frame = 0;
+	log_info("🎥 Recording input to %s (seed %u)", path, seed);
+	return 1;
+}
+
+/**
+ * Feed the game the input logged in 'path' instead of the player's
+ */
+/*bool*/ int input_replay_play(const char* path) {
+	input_replay_stop();
+	replay_file = fopen(path, "rb");
+	if (replay_file == NULL) {
+		log_error("🎥 Cannot replay %s: %s", path, strerror(errno));
+		return 0;
+	}
+
+	char magic[4];
+	if (fread(magic, 4, 1, replay_file) != 1 || memcmp(magic, REPLAY_MAGIC, 4) != 0) {
+		log_error("🎥 %s is not an input log", path);
+		fclose(replay_file);
+		replay_file = NULL;
+		return 0;
+	}
+	int version = read_lsb_short(replay_file);
+	int ev_size = read_lsb_short(replay_file);
+	if (version != REPLAY_VERSION || ev_size != sizeof(SDL_Event)) {
+		log_error("🎥 %s was recorded by an incompatible build (v%d, %d-byte events)",
+				path, version, ev_size);
+		fclose(replay_file);
+		replay_file = NULL;
+		return 0;
+	}
+	seed = read_lsb_uint(replay_file);
+	Uint64 start = read_lsb_uint(replay_file);
+	start |= (Uint64)read_lsb_uint(replay_file) << 32;
+	next_tag = fgetc(replay_file);
+
+	game_seed_random(seed);
+	game_start_fixed_clock(start);
+	disable_polled_input();
+	replay_path = strdup(path);
+	replay_mode = INPUT_REPLAY_PLAY;
+	frame = 0;
+	log_info("🎥 Replaying input from %s (seed %u)", path, seed);
+	return 1;
+}
+
+void input_replay_stop() {
+	if (replay_file != NULL) {
+		if (replay_mode == INPUT_REPLAY_RECORD)
+			log_info("🎥 Recorded %llu frames to %s", (unsigned long long)frame,
+					replay_path);
+		fclose(replay_file);
+		replay_file = NULL;
+	}
+	free(replay_path);
+	replay_path = NULL;
+	replay_mode = INPUT_REPLAY_OFF;
+}
+
+/**
+ * Move the game clock to the next frame: by the logged delta when
+ * replaying, by the wall clock otherwise. Returns 0 once a replay has
+ * run out of frames.
+ */
+/*bool*/ int input_replay_frame_begin() {
+	if (replay_mode == INPUT_REPLAY_OFF)
+		return 1;
+
+	if (replay_mode == INPUT_REPLAY_PLAY) {
+		/* Skip events the game didn't poll last frame */
+		SDL_Event ignored;
+		while (input_replay_poll_event(&ignored))
+			;
+		if (next_tag == 'F') {
+			Uint32 delta = read_lsb_uint(replay_file);
+			next_tag = fgetc(replay_file);
+			game_advance_fixed_ticks_by(delta);
+			frame++;
+			return 1;
+		}
+		if (next_tag != EOF)
+			log_error("🎥 Corrupt input log %s at frame %llu", replay_path,
+					(unsigned long long)frame);
+		log_info("🎥 Replay finished after %llu frames", (unsigned long long)frame);
+		fclose(replay_file);
+		replay_file = NULL;
+		replay_mode = INPUT_REPLAY_FINISHED;
+		last_wall_ticks = SDL_GetTicks64();
+		return 0;
+	}
+
+	/* Recording, or playing on after a replay: keep the clock sampled
+	once per frame */
+	Uint64 now = SDL_GetTicks64();
+	Uint32 delta = now - last_wall_ticks;
+	last_wall_ticks = now;
+	game_advance_fixed_ticks_by(delta);
+	if (replay_mode == INPUT_REPLAY_RECORD) {
+		fputc('F', replay_file);
+		write_lsb_uint(delta, replay_file);
+		frame++;
+	}
+	return 1;
+}
+
+void input_replay_record_event(SDL_Event* ev) {
+	if (replay_mode != INPUT_REPLAY_RECORD)
+		return;
+	size_t size = event_size(ev->type);
+	if (size == 0)
+		return;
+	fputc('E', replay_file);
+	write_lsb_uint(ev->type, replay_file);
+	write_lsb_short(size, replay_file);
+	fwrite(ev, size, 1, replay_file);
+}
+
+/**
+ * Get the next logged event for the current frame. Returns 0 when
+ * there is none left.
+ */
+/*bool*/ int input_replay_poll_event(SDL_Event* ev) {
+	if (replay_mode != INPUT_REPLAY_PLAY || next_tag != 'E')
+		return 0;
+	unsigned int type = read_lsb_uint(replay_file);
+	size_t size = (unsigned short)read_lsb_short(replay_file);
+	memset(ev, 0, sizeof(*ev));
+	size_t keep = SDL_min(size, sizeof(*ev));
+	if (fread(ev, 1, keep, replay_file) != keep
+			|| fseek(replay_file, size - keep, SEEK_CUR) != 0) {
+		next_tag = EOF;
+		return 0;
+	}
+	ev->type = type;
+	next_tag = fgetc(replay_file);
+	return 1;
+}
@@ -0,0 +1,47 @@
+/**
+ * Input record/replay, for reproducible play-throughs
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INPUT_REPLAY_H
+#define _INPUT_REPLAY_H
+
+#include "SDL.h"
+
+enum input_replay_mode {
+	INPUT_REPLAY_OFF = 0,
+	INPUT_REPLAY_RECORD,
+	INPUT_REPLAY_PLAY,
+	INPUT_REPLAY_FINISHED, // replay over, the player has control again
+};
+
+extern enum input_replay_mode input_replay_get_mode();
+extern Uint64 input_replay_get_frame();
+extern unsigned int input_replay_get_seed();
+
+extern /*bool*/ int input_replay_record(const char* path);
+extern /*bool*/ int input_replay_play(const char* path);
+extern void input_replay_stop();
+
+extern /*bool*/ int input_replay_frame_begin();
+extern void input_replay_record_event(SDL_Event* ev);
+extern /*bool*/ int input_replay_poll_event(SDL_Event* ev);
+
+#endif
@@ -30,12 +30,20 @@
 #include <strings.h> /* strcasecmp */
 #include <dirent.h>
 #include <errno.h>
-#include <filesystem>
+#include <time.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 /* stat(2) */
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
 
 #include "SDL.h"
 #ifdef HAVE_LIBZIP
@@ -47,9 +55,14 @@
 #endif
 
 #include "paths.h"
+#include "io_util.h"
 
 #if defined _WIN32 || defined __WIN32__ || defined __CYGWIN__ ||               \
 		defined __EMX__ || defined __DJGPP__ || defined __EMSCRIPTEN__
+void ciconvert_cache_invalidate(const char* path) {}
+void ciconvert_get_stats(struct ciconvert_stats* stats) {
+	memset(stats, 0, sizeof(*stats));
+}
 #else
 /* Returns a pointer to the end of the current path element (file or
 directory) */
@@ -59,6 +72,149 @@ static char* end_of_elt(char* str) {
 		p++;
 	return p;
 }
+
+/* Directory listings used by ciconvert(), so that probing for files
+(sprite frames, dir.ff, .PNG/.BMP variants...) doesn't walk the
+filesystem each time. Listings are read on first use. Exact matches
+are then answered from memory; misses and case-folded matches check
+the directory's mtime first (one stat) and re-read it if it changed.
+Writes through paths.cpp drop the listing explicitly, which covers
+filesystems with coarse timestamps. */
+enum ci_listing_state { CI_MISSING, CI_UNREADABLE, CI_LISTED };
+struct ci_listing {
+	enum ci_listing_state state;
+	struct timespec mtime;
+	std::unordered_set<std::string> exact;
+	std::unordered_map<std::string, std::string> folded; // lowercase -> name on disk
+};
+static std::unordered_map<std::string, struct ci_listing> ci_listings;
+static std::mutex ci_mutex; // paths are resolved from sprite loader threads too
+static struct ciconvert_stats ci_stats;
+
+static std::string ci_fold(const char* name) {
+	std::string folded(name);
+	for (auto& c : folded)
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+	return folded;
+}
+
+static /*bool*/ int ci_stat_dir(const std::string& dir, struct timespec* mtime) {
+	struct stat buf;
+	ci_stats.syscalls++;
+	if (stat(dir.c_str(), &buf) < 0)
+		return 0;
+#ifdef __APPLE__
+	*mtime = buf.st_mtimespec;
+#else
+	*mtime = buf.st_mtim;
+#endif
+	return 1;
+}
+
+static void ci_read_listing(const std::string& dir, struct ci_listing* l) {
+	l->exact.clear();
+	l->folded.clear();
+	if (!ci_stat_dir(dir, &l->mtime)) {
+		l->state = (errno == EACCES) ? CI_UNREADABLE : CI_MISSING;
+		return;
+	}
+
+	DIR* list;
+	struct dirent* entry;
+	ci_stats.scans++;
+	ci_stats.syscalls += 3; // opendir, getdents, closedir
+	list = opendir(dir.c_str());
+	if (list != NULL) {
+		l->state = CI_LISTED;
+		while ((entry = readdir(list)) != NULL) {
+			l->exact.insert(entry->d_name);
+			/* first entry wins, like the readdir() scan did */
+			l->folded.emplace(ci_fold(entry->d_name), entry->d_name);
+		}
+		closedir(list);
+	} else if (errno == EACCES) {
+		/* Maybe attempting to read a private prefix dir such as
+	/data/data on Android, try to use it as-is. */
+		l->state = CI_UNREADABLE;
+	} else {
+		l->state = CI_MISSING;
+	}
+}
+
+/**
+ * Look 'name' up in directory 'dir', fixing its case in-place.
+ * Return 0 if it's not there.
+ */
+static /*bool*/ int ci_lookup(const std::string& dir, char* name) {
+	auto it = ci_listings.find(dir);
+	struct ci_listing* l;
+	if (it == ci_listings.end()) {
+		l = &ci_listings[dir];
+		ci_read_listing(dir, l);
+	} else {
+		l = &it->second;
+		if (l->state == CI_LISTED && l->exact.count(name) > 0)
+			return 1;
+		/* Not an exact match: make sure the listing is current */
+		struct timespec mtime;
+		if (!ci_stat_dir(dir, &mtime)) {
+			if (l->state != CI_MISSING)
+				ci_read_listing(dir, l);
+		} else if (l->state == CI_MISSING || mtime.tv_sec != l->mtime.tv_sec
+				   || mtime.tv_nsec != l->mtime.tv_nsec) {
+			ci_read_listing(dir, l);
+		}
+	}
+
+	if (l->state == CI_UNREADABLE)
+		return 1;
+	if (l->state == CI_MISSING)
+		return 0;
+	if (l->exact.count(name) > 0)
+		return 1;
+	auto f = l->folded.find(ci_fold(name));
+	if (f == l->folded.end())
+		return 0;
+	/* Good case-insensitive match: replace the user-provided filename
+	with it */
+	strcpy(name, f->second.c_str());
+	return 1;
+}
+
+/**
+ * Forget the listing of the directory containing 'path', after
+ * creating or removing a file there. NULL forgets everything.
+ */
+void ciconvert_cache_invalidate(const char* path) {
+	std::lock_guard<std::mutex> lock(ci_mutex);
+	if (path == NULL) {
+		ci_listings.clear();
+		return;
+	}
+	/* Build the listing key the same way ciconvert() does */
+	std::string dir = (path[0] == '/') ? "/" : "./";
+	const char* p = path;
+	while (1) {
+		while (*p == '/' || *p == '\\')
+			p++;
+		const char* end = p;
+		while (*end != '/' && *end != '\\' && *end != '\0')
+			end++;
+		if (*end == '\0')
+			break;
+		dir.append(p, end - p);
+		dir += '/';
+		p = end;
+	}
+	ci_listings.erase(dir);
+}
+
+void ciconvert_get_stats(struct ciconvert_stats* stats) {
+	std::lock_guard<std::mutex> lock(ci_mutex);
+	*stats = ci_stats;
+	stats->dirs = ci_listings.size();
+}
 #endif
 
 /**
@@ -82,36 +238,17 @@ void ciconvert(char* filename) {
 	}
 #else
 	/* Parse all the directories that composes filename */
-	char* cur_dir = NULL;
-	char *pcur_elt, *pend_of_elt, *pend_of_cur_dir;
+	char *pcur_elt, *pend_of_elt;
 	int error = 0;
+	int exact = 1;
+	int nb_elts = 0;
 
-	//ye: opening file with cpp filesystem. probably does the same as below
-	std::filesystem::path mypath = filename;
-	if (std::filesystem::exists(mypath)) {
-		return;
-	}
-
-	/* First simply try to open the file, constant complexity. Permits
-decent speed for careful authors who write exact filenames. */
-	FILE* f;
-	if ((f = fopen(filename, "r")) != NULL) {
-		fclose(f);
-		return;
-	}
+	std::lock_guard<std::mutex> lock(ci_mutex);
+	ci_stats.calls++;
 
-	/* Else, check each path element of the filename */
 	/* No need to support volumes ("C:\"...) because this function
 already returned in case-insensitive environments (woe&dos) */
-	if (filename[0] == '/') {
-		cur_dir = (char*)malloc(strlen("/") + strlen(filename) + 1);
-		strcpy(cur_dir, "/");
-		pend_of_cur_dir = cur_dir + 1;
-	} else {
-		cur_dir = (char*)malloc(strlen("./") + strlen(filename) + 1);
-		strcpy(cur_dir, "./");
-		pend_of_cur_dir = cur_dir + 2;
-	}
+	std::string cur_dir = (filename[0] == '/') ? "/" : "./";
 	pcur_elt = filename;
 	do {
 		char end_of_elt_backup;
@@ -129,29 +266,12 @@ already returned in case-insensitive environments (woe&dos) */
 	path element. */
 
 		/* Now check if there's a matching entry in the directory */
-		DIR* list;
-		struct dirent* entry;
-		int found = 0;
-
-		list = opendir(cur_dir);
-		if (list != NULL) {
-			/* note: we may want to sort list first */
-			while ((entry = readdir(list)) != NULL && !found) {
-				if (strcasecmp(pcur_elt, entry->d_name) == 0) {
-					/* Good case-insensitive match: replace the
-		user-provided filename with it */
-					strcpy(pcur_elt, entry->d_name);
-					found = 1;
-				}
-			}
-			closedir(list);
-		} else if (errno == EACCES) {
-			/* Maybe attempting to read a private prefix dir such as
-	/data/data on Android, try to use it as-is. */
-			found = 1;
-		}
-		if (!found)
+		std::string requested(pcur_elt);
+		if (!ci_lookup(cur_dir, pcur_elt))
 			error = 1;
+		else if (requested != pcur_elt)
+			exact = 0;
+		nb_elts++;
 
 		/* Prepare parsing next path element, unless the current element
 	was the last one */
@@ -159,18 +279,19 @@ already returned in case-insensitive environments (woe&dos) */
 			*pend_of_elt = '/'; /* restore */
 
 			/* Prepare next directory */
-			{
-				int cur_elt_len = pend_of_elt - pcur_elt;
-				strncpy(pend_of_cur_dir, pcur_elt, cur_elt_len + 1);
-				pend_of_cur_dir += cur_elt_len + 1;
-				*pend_of_cur_dir = '\0';
-			}
+			cur_dir.append(pcur_elt, pend_of_elt - pcur_elt);
+			cur_dir += '/';
 
 			/* go to the next path element */
 			pcur_elt = pend_of_elt + 1;
 		}
 	} while (*pend_of_elt != '\0' && !error);
-	free(cur_dir);
+
+	/* What the uncached lookup cost: a stat, and unless the path was
+	exact, an fopen probe plus opendir/getdents/closedir per element */
+	ci_stats.syscalls_uncached += 1;
+	if (error || !exact)
+		ci_stats.syscalls_uncached += 1 + 3 * nb_elts;
 
 	/* If there was an error, we return a half-converted path (maybe the
 file didn't exist yet, but leading directories still needed to be
@@ -293,3 +414,84 @@ void write_lsb_short(short n, FILE* f) {
 	buf[1] = (n >> (1 * 8)) & 0xFF;
 	fwrite(buf, 2, 1, f);
 }
+
+/**
+ * Decode 'n' little-endian ints at once, e.g. from a file read or
+ * mapped in memory. 'dst' may be the same as 'src'.
+ */
+void decode_lsb_ints(const void* src, int* dst, int n) {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+	if ((const void*)dst != src)
+		memmove(dst, src, n * sizeof(int));
+#else
+	const unsigned char* buf = (const unsigned char*)src;
+	for (int i = 0; i < n; i++, buf += 4)
+		dst[i] = (buf[3] << 24) | (buf[2] << 16) | (buf[1] << 8) | (buf[0]);
+#endif
+}
+
+/**
+ * Write 'str' as a quoted JSON string, escaping quotes, backslashes
+ * and control characters
+ */
+void write_json_string(const char* str, FILE* f) {
+	fputc('"', f);
+	for (; *str != '\0'; str++) {
+		unsigned char c = *str;
+		if (c == '"' || c == '\\')
+			fprintf(f, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(f, "\\u%04x", c);
+		else
+			fputc(c, f);
+	}
+	fputc('"', f);
+}
+
+/**
+ * Map a whole file read-only; stdio fallback on Woe
+ */
+const unsigned char* map_file(const char* path, size_t* len) {
+#ifdef _WIN32
+	FILE* f = fopen(path, "rb");
+	if (f == NULL)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	unsigned char* data = NULL;
+	if (size > 0) {
+		data = (unsigned char*)malloc(size);
+		if (fread(data, size, 1, f) != 1) {
+			free(data);
+			data = NULL;
+		}
+	}
+	fclose(f);
+	*len = size;
+	return data;
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	struct stat buf;
+	void* data = NULL;
+	*len = 0;
+	if (fstat(fd, &buf) == 0 && buf.st_size > 0) {
+		*len = buf.st_size;
+		data = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED)
+			data = NULL;
+	}
+	close(fd);
+	return (const unsigned char*)data;
+#endif
+}
+
+void unmap_file(const unsigned char* data, size_t len) {
+#ifdef _WIN32
+	free((void*)data);
+#else
+	munmap((void*)data, len);
+#endif
+}
@@ -34,7 +34,18 @@
 			different size and savegame format will
 			change! */
 
+/* ciconvert() directory listings cache */
+struct ciconvert_stats {
+	Uint64 calls; // ciconvert() lookups
+	Uint64 scans; // directories read
+	Uint64 syscalls; // filesystem calls made
+	Uint64 syscalls_uncached; // estimate of what the uncached lookups made
+	Uint64 dirs; // directories currently cached
+};
+
 extern void ciconvert(char* filename);
+extern void ciconvert_cache_invalidate(const char* path);
+extern void ciconvert_get_stats(struct ciconvert_stats* stats);
 extern /*bool*/ int exist(char* name);
 extern int is_directory(const char* name);
 extern char* pdirname(const char* filename);
@@ -45,5 +56,10 @@ extern unsigned int read_lsb_uint(FILE* f);
 extern void write_lsb_uint(unsigned int n, FILE* f);
 extern short read_lsb_short(FILE* f);
 extern void write_lsb_short(short n, FILE* f);
+extern void decode_lsb_ints(const void* src, int* dst, int n);
+extern void write_json_string(const char* str, FILE* f);
+
+extern const unsigned char* map_file(const char* path, size_t* len);
+extern void unmap_file(const unsigned char* data, size_t len);
 
 #endif
@@ -25,8 +25,6 @@
 #include <config.h>
 #endif
 
-#include <parallel_hashmap/btree.h>
-
 #include "indicators.hpp"
 #include "game_engine.h"
 #include "live_sprites_manager.h"
@@ -40,12 +38,13 @@
 #include "dinkini.h"
 #include "debug_imgui.h"
 #include "debug.h"
+#include "profiler.h"
 
 /* base editor screen */
 struct editor_screen cur_ed_screen;
 
 /* hardness */
-unsigned char screen_hitmap[600 + 1][400 + 1]; /* hit_map */
+alignas(64) unsigned char screen_hitmap[400 + 1][HITMAP_STRIDE]; /* hit_map, [y][x] */
 
 int playx = 620;
 int playl = 20;
@@ -63,59 +62,12 @@ void live_screen_init() {
 /**
  * Fills an int[MAX_SPRITES_AT_ONCE] with the index of the current
  * screen's sprites, sorted by ascending height/queue.
+ *
+ * Ties are broken by sprite number, same as the original selection
+ * sort; the live sprites manager keeps the order between frames.
  */
 void screen_rank_game_sprites(int* rank) {
-	memset(rank, 0, MAX_SPRITES_AT_ONCE * sizeof(int));
-
-	//if (!debug_ranksprites) {
-
-	int r1 = 0;
-	bool already_checked[MAX_SPRITES_AT_ONCE + 1] = {0};
-
-	for (r1 = 0; r1 < last_sprite_created; r1++) {
-		rank[r1] = 0;
-
-		int highest_sprite = 22000; //more than it could ever be
-
-		for (int h1 = 1; h1 <= last_sprite_created; h1++) {
-			if (!already_checked[h1] && spr[h1].active) {
-				int height;
-				if (spr[h1].que != 0)
-					height = spr[h1].que;
-				else
-					height = spr[h1].y;
-
-				if (height < highest_sprite) {
-					highest_sprite = height;
-					rank[r1] = h1;
-				}
-			}
-		}
-
-		if (rank[r1] != 0)
-			already_checked[rank[r1]] = true;
-	}
-
-	//} else {
-	//New sorting system - incomplete
-	//std::multimap<int, int> rankings;
-	phmap::btree_multimap<int, int> rankings;
-	//get akll sprites and use their Y if no que
-	for (int i=0; i <= last_sprite_created; i++) {
-			if (spr[i].que != 0) {
-				rankings.insert(std::make_pair(spr[i].que, i));
-			}
-			else {
-				rankings.insert(std::make_pair(spr[i].y, i));
-			}
-	}
-	int kk = 0;
-	for (auto const& entry: rankings) {
-		//rank[kk] = entry.second;
-		kk++;
-	}
-
-	//}
+	lsm_depth_rank(rank);
 }
 
 void fill_hard_sprites() {
@@ -148,26 +100,24 @@ void fill_whole_hard(void) {
 	for (til = 0; til < 96; til++) {
 		int offx = (til * 50 - ((til / 12) * 600));
 		int offy = (til / 12) * 50;
-		int x, y;
-		for (x = 0; x < 50; x++)
-			for (y = 0; y < 50; y++)
-				screen_hitmap[offx + x][offy + y] =
-						hmap.htile[realhard(til)].hm[x][y];
+		struct ts_block* block = &hmap.htile[realhard(til)];
+		for (int y = 0; y < 50; y++)
+			memcpy(&screen_hitmap[offy + y][offx], block->rows[y], 50);
 	}
 }
 
 //add hardness from a sprite
 void add_hardness(int sprite, int num) {
-	int xx;
-	for (xx = spr[sprite].x + k[getpic(sprite)].hardbox.left; xx < spr[sprite].x + k[getpic(sprite)].hardbox.right; xx++) {
-		for (int yy = spr[sprite].y + k[getpic(sprite)].hardbox.top; yy < spr[sprite].y + k[getpic(sprite)].hardbox.bottom; yy++) {
-			if ((xx - 20 > 600) | (xx - 20 < 0) | (yy > 400) | (yy < 0)) {
-				//log_debug("Not adding hard from sprite %d", sprite);
-			} else {
-				screen_hitmap[xx - 20][yy] = num;
-			}
-		}
-	}
+	rect* hardbox = &k[getpic(sprite)].hardbox;
+	/* Clip to the hitmap, in screen coordinates (x is offset by 20) */
+	int x1 = SDL_max(spr[sprite].x + hardbox->left - 20, 0);
+	int x2 = SDL_min(spr[sprite].x + hardbox->right - 20, 600 + 1);
+	int y1 = SDL_max(spr[sprite].y + hardbox->top, 0);
+	int y2 = SDL_min(spr[sprite].y + hardbox->bottom, 400 + 1);
+	if (x1 >= x2)
+		return;
+	for (int yy = y1; yy < y2; yy++)
+		memset(&screen_hitmap[yy][x1], num, x2 - x1);
 }
 
 unsigned char get_hard_map(int x1, int y1) {
@@ -188,7 +138,7 @@ unsigned char get_hard_map(int x1, int y1) {
 
 	//Msg("tile %d ",til);
 
-	return (hmap.htile[realhard(til)].hm[offx][offy]);
+	return (hmap.htile[realhard(til)].rows[offy][offx]);
 }
 
 void fill_hardxy(rect box) {
@@ -202,9 +152,17 @@ void fill_hardxy(rect box) {
 	if (box.left < 0)
 		box.left = 0;
 
-	for (int x1 = box.left; x1 < box.right; x1++)
-		for (int y1 = box.top; y1 < box.bottom; y1++)
-			screen_hitmap[x1][y1] = get_hard_map(x1, y1);
+	/* Copy each row tile by tile, rather than looking up every pixel */
+	for (int y1 = box.top; y1 < box.bottom; y1++) {
+		int x1 = box.left;
+		while (x1 < box.right) {
+			int til = (x1 / 50) + ((y1 / 50) * 12);
+			int x2 = SDL_min((x1 / 50 + 1) * 50, box.right);
+			memcpy(&screen_hitmap[y1][x1], &hmap.htile[realhard(til)].rows[y1 % 50][x1 % 50],
+				x2 - x1);
+			x1 = x2;
+		}
+	}
 }
 
 /**
@@ -232,7 +190,7 @@ unsigned char get_hard(int x1, int y1, int screenlock) {
 	if ((x1 < 0) || (y1 < 0) || (x1 > 599) || (y1 > 399))
 		return 0;
 
-	int value = screen_hitmap[x1][y1];
+	int value = hitmap_get(x1, y1);
 	return (value);
 }
 
@@ -391,6 +349,7 @@ void draw_sprite_game(IOGfxSurface* GFX_lpdest, int h) {
 	if (spr[h].nodraw == 1 && !debug_invspri)
 		return; // invisible
 
+	prof_scope prof(PROF_DRAW);
 	rect box_crap, box_real;
 
 	if (get_box(h, &box_crap, &box_real, false)) {
@@ -582,6 +541,6 @@ void grab_trick(int dir) {
 }
 
 int get_screen_hitmap(int x, int y) {
-	int val = screen_hitmap[x][y];
+	int val = hitmap_get(x, y);
 	return val;
 }
@@ -31,8 +31,13 @@
 /* base editor screen */
 extern struct editor_screen cur_ed_screen;
 
-// struct for hardness map
-extern unsigned char screen_hitmap[600 + 1][400 + 1];
+// struct for hardness map, row-major with each row padded to whole
+// cache lines; use hitmap_get() rather than indexing it
+#define HITMAP_STRIDE 640
+extern unsigned char screen_hitmap[400 + 1][HITMAP_STRIDE];
+static inline unsigned char hitmap_get(int x, int y) {
+	return screen_hitmap[y][x];
+}
 
 extern int playl;
 extern int playx;
@@ -43,6 +48,7 @@ extern /*bool*/ int transition_in_progress;
 extern void live_screen_init();
 extern void add_hardness(int sprite, int num);
 extern unsigned char get_hard(int x1, int y1, int screenlock);
+extern unsigned char get_hard_map(int x1, int y1);
 extern void fill_hard_sprites(void);
 extern void fill_whole_hard(void);
 extern void fill_hardxy(rect box);
@@ -32,29 +32,28 @@
 #include "cereal/cereal.hpp"
 
 #include "IOGfxSurface.h"
+#include "live_sprite_custom.h"
 
-struct sp {
-	int x, moveman;
-	int y;
+/**
+ * Live sprite fields that the per-frame loops don't scan. The ones
+ * they do (x, y, seq, frame, que, brain, size, active) are kept in
+ * parallel arrays by the live sprites manager, cf. struct sp_hot.
+ */
+struct sp_cold {
+	int moveman;
 	int mx, my;
 	int lpx[51], lpy[51];
 	int speed;
-	int brain;
 	int seq_orig, dir;
-	int seq;
-	int frame;
 	Uint64 delay;
 	int pseq;
 	int pframe;
 
-	bool active;
 	int attrib;
 	Uint64 wait;
 	int timing;
 	int skip;
 	int skiptimer;
-	int size;
-	int que;
 	int base_walk;
 	int base_idle;
 	int base_attack;
@@ -120,8 +119,46 @@ struct sp {
 	/* v1.08 */
 	int bloodseq;
 	int bloodnum;
-	std::map<std::string, int>* custom;
+	struct sp_custom custom;
 	SoLoud::handle sounds;
+};
+
+/* Every sp_cold field, in declaration order */
+#define SP_COLD_FIELDS(X) \
+	X(moveman) X(mx) X(my) X(lpx) X(lpy) X(speed) X(seq_orig) X(dir) \
+	X(delay) X(pseq) X(pframe) X(attrib) X(wait) X(timing) X(skip) \
+	X(skiptimer) X(base_walk) X(base_idle) X(base_attack) X(base_hit) \
+	X(last_sound) X(hard) X(alt) X(althard) X(sp_index) X(nocontrol) \
+	X(idle) X(strength) X(damage) X(defense) X(hitpoints) X(exp) X(gold) \
+	X(base_die) X(kill_ttl) X(kill_start) X(script_num) X(text) \
+	X(text_owner) X(text_cache) X(text_cache_reldst) X(text_cache_color) \
+	X(script) X(sound) X(say_stop_callback) X(freeze) X(move_active) \
+	X(move_script) X(move_dir) X(move_num) X(move_nohard) X(follow) \
+	X(nohit) X(notouch) X(notouch_timer) X(flying) X(touch_damage) \
+	X(brain_parm) X(brain_parm2) X(noclip) X(reverse) X(disabled) \
+	X(target) X(attack_wait) X(move_wait) X(distance) X(last_hit) X(live) \
+	X(range) X(attack_hit_sound) X(attack_hit_sound_speed) X(action) \
+	X(nodraw) X(frame_delay) X(picfreeze) X(bloodseq) X(bloodnum) \
+	X(custom) X(sounds)
+
+/**
+ * A live sprite as seen through spr[h]: references to its fields
+ * wherever they're stored, so that spr[h].field reads, assigns and
+ * takes addresses as if it were a plain struct.
+ */
+struct sp_ref {
+	int& x;
+	int& y;
+	int& seq;
+	int& frame;
+	int& que;
+	int& brain;
+	int& size;
+	bool& active;
+#define SP_COLD_REF(name) decltype(sp_cold::name)& name;
+	SP_COLD_FIELDS(SP_COLD_REF)
+#undef SP_COLD_REF
+
 	//TODO: remove
 	template <class Archive>
 	void serialize(Archive & archive) {
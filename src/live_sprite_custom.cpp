@@ -0,0 +1,161 @@
+/**
+ * Custom properties of live sprites (sp_custom)
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * D-Mods use sp_custom() as per-sprite variables, often reading them
+ * every frame from AI scripts. Key strings are interned once in a
+ * global table, and each sprite keeps a small open-addressed table of
+ * key ids, so that a lookup neither allocates nor compares strings
+ * beyond the intern hash.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "live_sprite_custom.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "live_sprites_manager.h" /* lsm_custom_alloc */
+
+struct cstr_hash {
+	size_t operator()(const char* s) const {
+		/* FNV-1a */
+		size_t h = 2166136261u;
+		for (; *s != '\0'; s++)
+			h = (h ^ (unsigned char)*s) * 16777619u;
+		return h;
+	}
+};
+struct cstr_equal {
+	bool operator()(const char* a, const char* b) const {
+		return strcmp(a, b) == 0;
+	}
+};
+
+/* Interned keys live for the whole session: ids stay valid in every
+   sprite's table */
+static std::unordered_map<const char*, int, cstr_hash, cstr_equal> key_ids;
+static std::deque<std::string> key_names = { "" }; // id 0 is 'no key'
+
+/**
+ * Id of 'key' (case-sensitive, like the original std::map), adding it
+ * if it's new. Always > 0.
+ */
+int sp_custom_intern(const char* key) {
+	auto it = key_ids.find(key);
+	if (it != key_ids.end())
+		return it->second;
+	int id = key_names.size();
+	key_names.push_back(key);
+	key_ids.emplace(key_names.back().c_str(), id);
+	return id;
+}
+
+const char* sp_custom_key_name(int key) {
+	if (key <= 0 || key >= (int)key_names.size())
+		return NULL;
+	return key_names[key].c_str();
+}
+
+int sp_custom_nb_keys(void) {
+	return key_names.size() - 1;
+}
+
+static inline int slot_index(int key, int cap) {
+	/* Fibonacci hashing, ids are sequential */
+	return ((unsigned int)key * 2654435769u) & (cap - 1);
+}
+
+static struct sp_custom_slot* probe(struct sp_custom* c, int key) {
+	int i = slot_index(key, c->cap);
+	while (c->slots[i].key != 0 && c->slots[i].key != key)
+		i = (i + 1) & (c->cap - 1);
+	return &c->slots[i];
+}
+
+/**
+ * Value of 'key', NULL if the sprite doesn't have it
+ */
+int* sp_custom_find(struct sp_custom* c, int key) {
+	if (c->count == 0)
+		return NULL;
+	struct sp_custom_slot* slot = probe(c, key);
+	if (slot->key == 0)
+		return NULL;
+	return &slot->value;
+}
+
+static void grow(struct sp_custom* c) {
+	struct sp_custom old = *c;
+	c->cap = (old.cap == 0) ? SP_CUSTOM_MIN_CAP : old.cap * 2;
+	c->slots = lsm_custom_alloc(c->cap);
+	for (int i = 0; i < old.cap; i++)
+		if (old.slots[i].key != 0)
+			*probe(c, old.slots[i].key) = old.slots[i];
+	if (old.slots != NULL)
+		lsm_custom_free(old.slots, old.cap);
+}
+
+/**
+ * Value of 'key', added as 0 if the sprite doesn't have it yet
+ */
+int* sp_custom_get(struct sp_custom* c, int key) {
+	if (c->cap > 0) {
+		struct sp_custom_slot* slot = probe(c, key);
+		if (slot->key == key)
+			return &slot->value;
+	}
+	/* Keep at least a quarter of the slots empty */
+	if ((c->count + 1) * 4 > c->cap * 3)
+		grow(c);
+	struct sp_custom_slot* slot = probe(c, key);
+	slot->key = key;
+	slot->value = 0;
+	c->count++;
+	return &slot->value;
+}
+
+/**
+ * Remove all properties, keeping the slots
+ */
+void sp_custom_clear(struct sp_custom* c) {
+	if (c->slots != NULL)
+		memset(c->slots, 0, c->cap * sizeof(struct sp_custom_slot));
+	c->count = 0;
+}
+
+/**
+ * Remove all properties and give the slots back to the pool
+ */
+void sp_custom_release(struct sp_custom* c) {
+	if (c->slots != NULL)
+		lsm_custom_free(c->slots, c->cap);
+	c->slots = NULL;
+	c->cap = 0;
+	c->count = 0;
+}
@@ -0,0 +1,51 @@
+/**
+ * Custom properties of live sprites (sp_custom)
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LIVE_SPRITE_CUSTOM_H
+#define _LIVE_SPRITE_CUSTOM_H
+
+#define SP_CUSTOM_MIN_CAP 8
+
+/* One key/value pair; key is an interned id, 0 for an empty slot */
+struct sp_custom_slot {
+	int key;
+	int value;
+};
+
+/* Open-addressed table of a sprite's custom properties. All zeroes is
+   an empty table; slots come from the live sprites manager's pool. */
+struct sp_custom {
+	struct sp_custom_slot* slots;
+	int cap; // power of 2
+	int count;
+};
+
+extern int sp_custom_intern(const char* key);
+extern const char* sp_custom_key_name(int key);
+extern int sp_custom_nb_keys(void);
+
+extern int* sp_custom_find(struct sp_custom* c, int key);
+extern int* sp_custom_get(struct sp_custom* c, int key);
+extern void sp_custom_clear(struct sp_custom* c);
+extern void sp_custom_release(struct sp_custom* c);
+
+#endif
@@ -0,0 +1,216 @@
+/**
+ * Broadphase grid for sprite collisions
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * The attack, touch and missile checks test a point (the attacker
+ * position) against the hardbox of every other sprite, inflated by a
+ * few pixels depending on the attacker. This grid bins the plain
+ * hardboxes so that only sprites near the point are tested; the
+ * callers still run the exact original test on each candidate.
+ *
+ * Sprites outside the play area are clamped to the border cells,
+ * which keeps the query conservative. The grid is rebuilt lazily
+ * after sprites_grid_invalidate() (start of frame, after a script
+ * ran, after a sequence was loaded) and single sprites are re-binned
+ * after sprites_grid_touch() (sprite moved or was created).
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "live_sprites_grid.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "live_sprites_manager.h"
+#include "gfx_sprites.h"
+
+#define GRID_LEFT 20 /* playl */
+#define GRID_TOP 0
+
+static std::vector<int> cells[SPRITES_GRID_COLS * SPRITES_GRID_ROWS];
+
+/* Cells covered by each binned sprite, -1 if not binned */
+static struct {
+	int c0, r0, c1, r1;
+} binned[MAX_SPRITES_AT_ONCE];
+
+static bool dirty = true;
+static std::vector<int> pending;
+static bool pending_mark[MAX_SPRITES_AT_ONCE];
+static unsigned int generation = 0;
+
+/* Query de-duplication */
+static unsigned int stamp[MAX_SPRITES_AT_ONCE];
+static unsigned int cur_stamp = 0;
+
+static inline int grid_col(long x) {
+	long c = (x - GRID_LEFT) / SPRITES_GRID_CELL;
+	if (c < 0)
+		return 0;
+	if (c >= SPRITES_GRID_COLS)
+		return SPRITES_GRID_COLS - 1;
+	return c;
+}
+
+static inline int grid_row(long y) {
+	long r = (y - GRID_TOP) / SPRITES_GRID_CELL;
+	if (r < 0)
+		return 0;
+	if (r >= SPRITES_GRID_ROWS)
+		return SPRITES_GRID_ROWS - 1;
+	return r;
+}
+
+static void grid_unbin(int sprite) {
+	if (binned[sprite].c0 < 0)
+		return;
+	for (int r = binned[sprite].r0; r <= binned[sprite].r1; r++) {
+		for (int c = binned[sprite].c0; c <= binned[sprite].c1; c++) {
+			std::vector<int>& cell = cells[r * SPRITES_GRID_COLS + c];
+			std::vector<int>::iterator it = std::find(cell.begin(), cell.end(), sprite);
+			if (it != cell.end()) {
+				*it = cell.back();
+				cell.pop_back();
+			}
+		}
+	}
+	binned[sprite].c0 = -1;
+}
+
+static void grid_bin(int sprite) {
+	if (!spr[sprite].active)
+		return;
+
+	/* Same box as the collision checks, before inflation. Boxes with
+	   left > right can still become valid once inflated, so bin them
+	   by their extent. */
+	rect box = k[getpic(sprite)].hardbox;
+	rect_offset(&box, spr[sprite].x, spr[sprite].y);
+	binned[sprite].c0 = grid_col(std::min(box.left, box.right));
+	binned[sprite].c1 = grid_col(std::max(box.left, box.right));
+	binned[sprite].r0 = grid_row(std::min(box.top, box.bottom));
+	binned[sprite].r1 = grid_row(std::max(box.top, box.bottom));
+
+	for (int r = binned[sprite].r0; r <= binned[sprite].r1; r++)
+		for (int c = binned[sprite].c0; c <= binned[sprite].c1; c++)
+			cells[r * SPRITES_GRID_COLS + c].push_back(sprite);
+}
+
+static void grid_update() {
+	if (dirty) {
+		for (int i = 0; i < SPRITES_GRID_COLS * SPRITES_GRID_ROWS; i++)
+			cells[i].clear();
+		for (int i = 0; i < MAX_SPRITES_AT_ONCE; i++)
+			binned[i].c0 = -1;
+		for (int i = 1; i < MAX_SPRITES_AT_ONCE; i++)
+			grid_bin(i);
+		dirty = false;
+	} else {
+		for (int sprite : pending) {
+			grid_unbin(sprite);
+			grid_bin(sprite);
+		}
+	}
+	for (int sprite : pending)
+		pending_mark[sprite] = false;
+	pending.clear();
+}
+
+/**
+ * Drop the whole grid, it will be rebuilt on next query
+ */
+void sprites_grid_invalidate() {
+	dirty = true;
+	generation++;
+}
+
+/**
+ * 'sprite' was created, or its position or picture changed
+ */
+void sprites_grid_touch(int sprite) {
+	if (!lsm_isValidSprite(sprite))
+		return;
+	generation++;
+	if (dirty || pending_mark[sprite])
+		return;
+	pending_mark[sprite] = true;
+	pending.push_back(sprite);
+}
+
+/**
+ * Changes whenever the candidates returned by a query may have
+ * changed; callers that run scripts between two candidates check it
+ * and query again.
+ */
+unsigned int sprites_grid_generation() {
+	return generation;
+}
+
+/**
+ * Fills 'out' with the numbers of the sprites above 'after' whose
+ * hardbox, inflated by at most 'margin' on each side, may contain
+ * (x,y). The result is sorted by sprite number, like the original
+ * 1..last_sprite_created scans. Returns the number of candidates.
+ */
+int sprites_grid_query(int x, int y, int margin, int after, int* out) {
+	grid_update();
+
+	if (margin < 0)
+		margin = -margin;
+	int c0 = grid_col((long)x - margin), c1 = grid_col((long)x + margin);
+	int r0 = grid_row((long)y - margin), r1 = grid_row((long)y + margin);
+
+	cur_stamp++;
+	if (cur_stamp == 0) {
+		memset(&stamp, 0, sizeof(stamp));
+		cur_stamp = 1;
+	}
+
+	int n = 0;
+	for (int r = r0; r <= r1; r++) {
+		for (int c = c0; c <= c1; c++) {
+			for (int sprite : cells[r * SPRITES_GRID_COLS + c]) {
+				if (sprite <= after || stamp[sprite] == cur_stamp)
+					continue;
+				stamp[sprite] = cur_stamp;
+				out[n++] = sprite;
+			}
+		}
+	}
+	std::sort(out, out + n);
+	return n;
+}
+
+/**
+ * Fills 'out' with all sprite numbers in ]after; last_sprite_created],
+ * for the debug views that need to visit every sprite.
+ */
+int sprites_grid_all(int after, int* out) {
+	int n = 0;
+	for (int i = after + 1; i <= last_sprite_created && i < MAX_SPRITES_AT_ONCE; i++)
+		out[n++] = i;
+	return n;
+}
@@ -0,0 +1,37 @@
+/**
+ * Broadphase grid for sprite collisions
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LIVE_SPRITES_GRID_H
+#define _LIVE_SPRITES_GRID_H
+
+/* Size of the grid cells, over the 600x400 play area */
+#define SPRITES_GRID_CELL 50
+#define SPRITES_GRID_COLS (600 / SPRITES_GRID_CELL)
+#define SPRITES_GRID_ROWS (400 / SPRITES_GRID_CELL)
+
+extern void sprites_grid_invalidate();
+extern void sprites_grid_touch(int sprite);
+extern unsigned int sprites_grid_generation();
+extern int sprites_grid_query(int x, int y, int margin, int after, int* out);
+extern int sprites_grid_all(int after, int* out);
+
+#endif
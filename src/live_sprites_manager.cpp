@@ -27,19 +27,212 @@
 
 #include "game_engine.h"
 #include "live_sprites_manager.h"
+#include "live_sprites_grid.h"
 #include "gfx_sprites.h"
 #include "dinkc.h"
 #include "soloud.h"
 #include "sfx.h"
+#include <vector>
 
 bool debug_drawblood = true;
 
-struct sp spr[MAX_SPRITES_AT_ONCE]; //max sprite control systems at once
+//max sprite control systems at once
+alignas(64) struct sp_hot spr_hot;
+struct sp_cold spr_cold[MAX_SPRITES_AT_ONCE];
+struct live_sprites spr;
 int last_sprite_created;
 
+/* Depth index: active sprites in drawing order, i.e. ascending
+   height ('que', or 'y' when que is 0), ties broken by sprite
+   number. The order is kept from one frame to the next, so ranking
+   only has to repair the few sprites that moved instead of
+   re-sorting everything. */
+static int depth_order[MAX_SPRITES_AT_ONCE];
+static int depth_count = 0;
+static bool depth_indexed[MAX_SPRITES_AT_ONCE];
+static int depth_height[MAX_SPRITES_AT_ONCE];
+
+/* Sprites at or above this height were never picked by the original
+   selection sort, keep skipping them */
+#define DEPTH_HEIGHT_MAX 22000
+
+/* Pool of sp_custom slot arrays, one free list per capacity
+   (SP_CUSTOM_MIN_CAP << i). Sprites come and go with every screen:
+   their tables are recycled rather than given back to the heap. */
+#define CUSTOM_POOL_CLASSES 20
+static std::vector<struct sp_custom_slot*> custom_pool[CUSTOM_POOL_CLASSES];
+
+static int custom_pool_class(int cap) {
+	int c = 0;
+	while ((SP_CUSTOM_MIN_CAP << c) < cap)
+		c++;
+	return c;
+}
+
+/**
+ * Zeroed slots for a table of 'cap' entries
+ */
+struct sp_custom_slot* lsm_custom_alloc(int cap) {
+	int c = custom_pool_class(cap);
+	struct sp_custom_slot* slots;
+	if (c < CUSTOM_POOL_CLASSES && !custom_pool[c].empty()) {
+		slots = custom_pool[c].back();
+		custom_pool[c].pop_back();
+		memset(slots, 0, cap * sizeof(struct sp_custom_slot));
+	} else {
+		slots = (struct sp_custom_slot*)calloc(cap, sizeof(struct sp_custom_slot));
+	}
+	return slots;
+}
+
+void lsm_custom_free(struct sp_custom_slot* slots, int cap) {
+	int c = custom_pool_class(cap);
+	if (c < CUSTOM_POOL_CLASSES)
+		custom_pool[c].push_back(slots);
+	else
+		free(slots);
+}
+
+/* Give back the custom tables of sprites that are gone */
+static void custom_release_inactive() {
+	for (int h = 0; h < MAX_SPRITES_AT_ONCE; h++)
+		if (!spr_hot.active[h] && spr_cold[h].custom.slots != NULL)
+			sp_custom_release(&spr_cold[h].custom);
+}
+
+static inline int lsm_depth_height(int h) {
+	if (spr[h].que != 0)
+		return spr[h].que;
+	return spr[h].y;
+}
+
 void live_sprites_manager_init() {
-	memset(&spr, 0, sizeof(spr));
+	for (int h = 0; h < MAX_SPRITES_AT_ONCE; h++)
+		sp_custom_release(&spr_cold[h].custom);
+	for (int c = 0; c < CUSTOM_POOL_CLASSES; c++) {
+		for (auto slots : custom_pool[c])
+			free(slots);
+		custom_pool[c].clear();
+	}
+	memset(&spr_hot, 0, sizeof(spr_hot));
+	memset(&spr_cold, 0, sizeof(spr_cold));
 	last_sprite_created = 0;
+
+	depth_count = 0;
+	memset(&depth_indexed, 0, sizeof(depth_indexed));
+}
+
+void lsm_depth_index_remove(int sprite) {
+	if (!lsm_isValidSprite(sprite) || !depth_indexed[sprite])
+		return;
+
+	for (int i = 0; i < depth_count; i++) {
+		if (depth_order[i] == sprite) {
+			memmove(&depth_order[i], &depth_order[i + 1],
+					(depth_count - i - 1) * sizeof(depth_order[0]));
+			depth_count--;
+			break;
+		}
+	}
+	depth_indexed[sprite] = false;
+}
+
+void lsm_depth_index_insert(int sprite) {
+	if (!lsm_isValidSprite(sprite))
+		return;
+	if (depth_indexed[sprite])
+		lsm_depth_index_remove(sprite);
+
+	/* Binary search on current heights; neighbours that moved since
+	   the last ranking are fixed up by lsm_depth_rank() anyway */
+	int height = lsm_depth_height(sprite);
+	int lo = 0, hi = depth_count;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		int other = depth_order[mid];
+		int other_height = lsm_depth_height(other);
+		if (other_height < height || (other_height == height && other < sprite))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	memmove(&depth_order[lo + 1], &depth_order[lo],
+			(depth_count - lo) * sizeof(depth_order[0]));
+	depth_order[lo] = sprite;
+	depth_count++;
+	depth_indexed[sprite] = true;
+}
+
+void lsm_depth_index_update(int sprite) {
+	if (!lsm_isValidSprite(sprite) || !spr[sprite].active)
+		return;
+	lsm_depth_index_insert(sprite);
+}
+
+/**
+ * Fills an int[MAX_SPRITES_AT_ONCE] with the index of the active
+ * sprites, sorted by ascending height/queue, zero-terminated.
+ */
+void lsm_depth_rank(int* rank) {
+	/* Catch up with sprites (de)activated without going through
+	   add_sprite()/lsm_remove_sprite(), e.g. savegame restore */
+	int n = 0;
+	for (int i = 0; i < depth_count; i++) {
+		int h = depth_order[i];
+		if (spr[h].active)
+			depth_order[n++] = h;
+		else
+			depth_indexed[h] = false;
+	}
+	depth_count = n;
+	for (int h = 1; h <= last_sprite_created && h < MAX_SPRITES_AT_ONCE; h++) {
+		if (spr[h].active && !depth_indexed[h]) {
+			depth_order[depth_count++] = h;
+			depth_indexed[h] = true;
+		}
+	}
+
+	for (int i = 0; i < depth_count; i++)
+		depth_height[depth_order[i]] = lsm_depth_height(depth_order[i]);
+
+	/* Insertion sort: linear when the previous order still mostly
+	   holds, which is the common case between two frames */
+	for (int i = 1; i < depth_count; i++) {
+		int h = depth_order[i];
+		int height = depth_height[h];
+		int j = i - 1;
+		while (j >= 0 && (depth_height[depth_order[j]] > height
+				|| (depth_height[depth_order[j]] == height && depth_order[j] > h))) {
+			depth_order[j + 1] = depth_order[j];
+			j--;
+		}
+		depth_order[j + 1] = h;
+	}
+
+	memset(rank, 0, MAX_SPRITES_AT_ONCE * sizeof(int));
+	int r = 0;
+	for (int i = 0; i < depth_count; i++) {
+		int h = depth_order[i];
+		if (h > last_sprite_created || depth_height[h] >= DEPTH_HEIGHT_MAX)
+			continue;
+		rank[r++] = h;
+	}
+}
+
+/**
+ * Zero all the fields of 'sprite', hot and cold
+ */
+void lsm_reset_sprite(int sprite) {
+	sp_custom_release(&spr_cold[sprite].custom);
+	memset(&spr_cold[sprite], 0, sizeof(spr_cold[sprite]));
+	spr_hot.x[sprite] = 0;
+	spr_hot.y[sprite] = 0;
+	spr_hot.seq[sprite] = 0;
+	spr_hot.frame[sprite] = 0;
+	spr_hot.que[sprite] = 0;
+	spr_hot.brain[sprite] = 0;
+	spr_hot.size[sprite] = 0;
+	spr_hot.active[sprite] = false;
 }
 
 bool lsm_isValidSprite(int sprite) {
@@ -51,10 +244,8 @@ void lsm_remove_sprite(int sprite) {
 		return;
 
 	spr[sprite].active = false;
-	if (spr[sprite].custom != NULL) {
-		delete spr[sprite].custom;
-		spr[sprite].custom = NULL;
-	}
+	lsm_depth_index_remove(sprite);
+	sp_custom_release(&spr[sprite].custom);
 	if (spr[sprite].text_cache != NULL) {
 		delete spr[sprite].text_cache;
 		spr[sprite].text_cache = NULL;
@@ -71,7 +262,7 @@ int add_sprite(int x1, int y, int brain, int pseq, int pframe) {
 	int x;
 	for (x = 1; x < MAX_SPRITES_AT_ONCE; x++) {
 		if (!spr[x].active) {
-			memset(&spr[x], 0, sizeof(spr[x]));
+			lsm_reset_sprite(x);
 
 			spr[x].active = true;
 			spr[x].x = x1;
@@ -97,11 +288,8 @@ int add_sprite(int x1, int y, int brain, int pseq, int pframe) {
 			spr[x].damage = 0;
 			spr[x].defense = 0;
 			spr[x].hard = 1;
-
-			if (spr[x].custom == NULL)
-				spr[x].custom = new std::map<std::string, int>;
-			else
-				spr[x].custom->clear();
+			lsm_depth_index_insert(x);
+			sprites_grid_touch(x);
 
 			return (x);
 		}
@@ -134,7 +322,7 @@ int add_sprite_dumb(int x1, int y, int brain, int pseq, int pframe, int size) {
 	int x;
 	for (x = 1; x < MAX_SPRITES_AT_ONCE; x++) {
 		if (!spr[x].active) {
-			memset(&spr[x], 0, sizeof(spr[x]));
+			lsm_reset_sprite(x);
 
 			//Msg("Making sprite %d.",x);
 			spr[x].active = true;
@@ -175,11 +363,8 @@ int add_sprite_dumb(int x1, int y, int brain, int pseq, int pframe, int size) {
 			spr[x].strength = 0;
 			spr[x].damage = 0;
 			spr[x].defense = 0;
-
-			if (spr[x].custom == NULL)
-				spr[x].custom = new std::map<std::string, int>;
-			else
-				spr[x].custom->clear();
+			lsm_depth_index_insert(x);
+			sprites_grid_touch(x);
 
 			return (x);
 		}
@@ -217,8 +402,10 @@ would trash spr[0] - cf. bugs.debian.org/688934 */
 	spr[crap2].base_walk = -1;
 	spr[crap2].nohit = 1;
 	spr[crap2].seq = myseq;
-	if (sprite > 0)
+	if (sprite > 0) {
 		spr[crap2].que = spr[sprite].y + 1;
+		lsm_depth_index_update(crap2);
+	}
 }
 }
 
@@ -252,6 +439,8 @@ static bool kill_highest_nonlive_sprite() {
 void lsm_kill_all_nonlive_sprites() {
 	while (kill_highest_nonlive_sprite())
 		;
+	/* Including sprites deactivated without lsm_remove_sprite() */
+	custom_release_inactive();
 }
 
 void get_last_sprite() {
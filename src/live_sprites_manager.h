@@ -27,14 +27,50 @@
 #include "live_sprite.h"
 
 #define MAX_SPRITES_AT_ONCE 1000
-extern struct sp spr[];
+
+/* Fields read for every sprite each frame (activity, depth ranking,
+   collisions, sounds), one array per field so that these loops walk
+   contiguous memory */
+struct sp_hot {
+	int x[MAX_SPRITES_AT_ONCE];
+	int y[MAX_SPRITES_AT_ONCE];
+	int seq[MAX_SPRITES_AT_ONCE];
+	int frame[MAX_SPRITES_AT_ONCE];
+	int que[MAX_SPRITES_AT_ONCE];
+	int brain[MAX_SPRITES_AT_ONCE];
+	int size[MAX_SPRITES_AT_ONCE];
+	bool active[MAX_SPRITES_AT_ONCE];
+};
+extern struct sp_hot spr_hot;
+extern struct sp_cold spr_cold[];
+
+/* spr[h].field, whether the field is hot or cold */
+struct live_sprites {
+	inline struct sp_ref operator[](int h) const {
+		struct sp_cold& c = spr_cold[h];
+#define SP_COLD_INIT(name) c.name,
+		return sp_ref{ spr_hot.x[h], spr_hot.y[h], spr_hot.seq[h], spr_hot.frame[h],
+			spr_hot.que[h], spr_hot.brain[h], spr_hot.size[h], spr_hot.active[h],
+			SP_COLD_FIELDS(SP_COLD_INIT) };
+#undef SP_COLD_INIT
+	}
+};
+extern struct live_sprites spr;
 extern int last_sprite_created;
 
 extern void live_sprites_manager_init();
 
+extern void lsm_reset_sprite(int sprite);
+extern struct sp_custom_slot* lsm_custom_alloc(int cap);
+extern void lsm_custom_free(struct sp_custom_slot* slots, int cap);
 extern bool lsm_isValidSprite(int sprite);
 extern void lsm_remove_sprite(int sprite);
 
+extern void lsm_depth_index_insert(int sprite);
+extern void lsm_depth_index_remove(int sprite);
+extern void lsm_depth_index_update(int sprite);
+extern void lsm_depth_rank(int* rank);
+
 extern int add_sprite(int x1, int y, int brain, int pseq, int pframe);
 extern int add_sprite_dumb(int x1, int y, int brain, int pseq, int pframe,
 						int size);
@@ -40,6 +40,9 @@
 #include "debug.h"
 
 int debug_mode = 0;
+#ifdef LOG_TRACE
+std::atomic<int> log_trace_enabled(0);
+#endif
 static std::string lastLog;
 static SDL_LogOutputFunction sdlLogger;
 static std::string filename;
@@ -47,12 +50,59 @@ static FILE* out = NULL;
 
 static char* init_error_msg = NULL;
 
+LogRing::LogRing(size_t capacity)
+	: lines(capacity), head(0), count(0), drops(0) {
+}
+
+void LogRing::append(const char* message) {
+	std::lock_guard<std::mutex> guard(mutex);
+	if (lines.empty())
+		return;
+	if (count == lines.size()) {
+		/* Overwrite the oldest line, reusing its storage */
+		lines[head].assign(message);
+		head = (head + 1) % lines.size();
+		drops++;
+	} else {
+		lines[(head + count) % lines.size()].assign(message);
+		count++;
+	}
+}
+
+void LogRing::clear() {
+	std::lock_guard<std::mutex> guard(mutex);
+	head = 0;
+	count = 0;
+	drops = 0;
+}
+
+size_t LogRing::size() {
+	return count;
+}
+
+Uint64 LogRing::dropped() {
+	return drops;
+}
+
+const std::string& LogRing::line(size_t i) {
+	return lines[(head + i) % lines.size()];
+}
+
+std::string LogRing::text() {
+	std::lock_guard<std::mutex> guard(mutex);
+	std::string all;
+	for (size_t i = 0; i < count; i++) {
+		all += line(i);
+		all += '\n';
+	}
+	return all;
+}
+
 void log_output(void* userdata, int category, SDL_LogPriority priority,
 				const char* message) {
 	lastLog = message;
 	//Yeolde: added this for imgui debug window
 	Buf.append(message);
-	Buf.append("\n");
 	debug_autoscroll[0] = true;
 
 	//Coloured text instead of the default SDL stuff. Should refactor evnetually
@@ -67,34 +117,29 @@ void log_output(void* userdata, int category, SDL_LogPriority priority,
 				dbg.logwindow = true;
 			}
 			errBuf.append(message);
-			errBuf.append("\n");
 			debug_autoscroll[1] = true;
 		}
 		else if (priority == SDL_LOG_PRIORITY_WARN)
 		{
 			spdlog::warn(message);
 			errBuf.append(message);
-			errBuf.append("\n");
 		}
 		else if (priority == SDL_LOG_PRIORITY_INFO)
 		{
 			spdlog::info(message);
 			infBuf.append(message);
-			infBuf.append("\n");
 			debug_autoscroll[2] = true;
 		}
 		else if (priority == SDL_LOG_PRIORITY_DEBUG)
 		{
 			spdlog::debug(message);
 			dbgBuf.append(message);
-			dbgBuf.append("\n");
 			debug_autoscroll[3] = true;
 		}
 		else
 		{
 			spdlog::trace(message);
 			traceBuf.append(message);
-			traceBuf.append("\n");
 			debug_autoscroll[4] = true;
 		}
 	}
@@ -138,6 +183,9 @@ void log_quit() {
 
 void log_debug_on(int level) {
 	debug_mode = 1;
+#ifdef LOG_TRACE
+	log_trace_enabled.store(level >= 2, std::memory_order_relaxed);
+#endif
 	/*SDL_LogSetAllPriority(SDL_LOG_PRIORITY_VERBOSE);*/
 	switch (level) {
 	case 0:
@@ -162,6 +210,9 @@ void log_debug_on(int level) {
 
 void log_debug_off() {
 	debug_mode = 0;
+#ifdef LOG_TRACE
+	log_trace_enabled.store(0, std::memory_order_relaxed);
+#endif
 	spdlog::set_level(spdlog::level::off);
 	spdlog::enable_backtrace(5);
 	SDL_LogResetPriorities();
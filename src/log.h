@@ -25,26 +25,41 @@
 #include "SDL.h"
 #include "spdlog/spdlog.h"
 #include <iostream>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
 
 extern int debug_mode;
 
-//#ifdef DEBUG
+/* Trace points cost nothing unless built with LOG_TRACE (meson
+-Dtrace_log=true). When built in, they are skipped with a single load
+of log_trace_enabled until the verbose log level is selected. */
+#ifdef LOG_TRACE
+extern std::atomic<int> log_trace_enabled;
+#define LOG_TRACE_ON() log_trace_enabled.load(std::memory_order_relaxed)
+#else
+#define LOG_TRACE_ON() 0
+#endif
+
 #define log_trace(...)                                                         \
-	SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_VERBOSE,     \
-		__VA_ARGS__)
+	do {                                                                       \
+		if (LOG_TRACE_ON())                                                    \
+			SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION,                       \
+				SDL_LOG_PRIORITY_VERBOSE, __VA_ARGS__);                        \
+	} while (0)
 #define log_enter(...)                                                         \
-	SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_VERBOSE,     \
-		"Enter: " __VA_ARGS__)
-#define log_exit(...)                                                         \
-	SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_VERBOSE,     \
-		"Exit: " __VA_ARGS__)
-//#else
-
-//#define log_trace(...)
-//#define log_enter(...)
-//#define log_exit(...)
-
-//#endif
+	do {                                                                       \
+		if (LOG_TRACE_ON())                                                    \
+			SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION,                       \
+				SDL_LOG_PRIORITY_VERBOSE, "Enter: " __VA_ARGS__);              \
+	} while (0)
+#define log_exit(...)                                                          \
+	do {                                                                       \
+		if (LOG_TRACE_ON())                                                    \
+			SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION,                       \
+				SDL_LOG_PRIORITY_VERBOSE, "Exit: " __VA_ARGS__);               \
+	} while (0)
 
 #define log_debug(...)                                                         \
 	SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_DEBUG,       \
@@ -70,6 +85,28 @@ extern void log_quit();
 extern void log_debug_on(int);
 extern void log_debug_off();
 
+/* Recent lines for the debug log window. Once full, the oldest lines
+are dropped and counted. */
+class LogRing {
+public:
+	LogRing(size_t capacity);
+	void append(const char* message);
+	void clear();
+	std::string text();
+	/* Hold the lock while reading size(), dropped() and line() */
+	std::mutex& lock() { return mutex; }
+	size_t size();
+	Uint64 dropped();
+	const std::string& line(size_t i); // 0 is the oldest
+
+private:
+	std::vector<std::string> lines;
+	size_t head; // oldest line
+	size_t count;
+	Uint64 drops;
+	std::mutex mutex;
+};
+
 extern const char* log_getLastLog();
 extern void log_set_output_file(const char* filename);
 
@@ -0,0 +1,239 @@
+/**
+ * map.dat mapped in memory
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * map.dat is an array of fixed-size little-endian screen records.
+ * Rather than going through stdio field by field, the whole file is
+ * mapped once and records are read through a struct with the same
+ * layout. Any screen can then be read without a syscall, from any
+ * thread.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "map_view.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include <string>
+
+#include "io_util.h"
+#include "paths.h"
+
+/* On-disk layout, cf. load_screen_stdio() */
+struct mapdat_tile {
+	int square_full_idx0;
+	int property; // unused
+	int althard;
+	char more[6]; // unused
+	char align[2];
+	char buff[60]; // unused
+};
+
+struct mapdat_sprite {
+	int x, y, seq, frame, type, size;
+	unsigned char active;
+	char align[3];
+	int rotation, special, brain;
+	char script[52];
+	int speed, base_walk, base_idle, base_attack, base_hit, timing, que, hard;
+	int alt_left, alt_top, alt_right, alt_bottom;
+	int is_warp, warp_map, warp_x, warp_y, parm_seq;
+	int base_die, gold, hitpoints, strength, defense, exp, sound, vision, nohit,
+		touch_damage;
+	char userdata[20];
+};
+
+struct mapdat_screen {
+	char name[20]; // unused
+	struct mapdat_tile t[97];
+	char v[160]; // unused
+	char s[80]; // unused
+	struct mapdat_sprite sprite[101];
+	char script[21];
+	char unused[1018];
+	char align[1];
+};
+
+static_assert(sizeof(int) == 4, "map.dat fields are 32-bit");
+static_assert(sizeof(struct mapdat_tile) == 80, "map.dat tile layout");
+static_assert(sizeof(struct mapdat_sprite) == 220, "map.dat sprite layout");
+static_assert(offsetof(struct mapdat_screen, sprite) == 8020, "map.dat screen layout");
+static_assert(sizeof(struct mapdat_screen) == 31280, "map.dat screen layout");
+
+struct map_view {
+	const unsigned char* data;
+	size_t len;
+	std::string key; // D-Mod path it was opened for
+};
+
+/**
+ * Map 'path' (relative to the D-Mod, or the fallback data if the
+ * D-Mod doesn't have it). Returns NULL if it can't be opened.
+ */
+struct map_view* map_view_open(const char* path) {
+	char* fullpath = paths_dmodfile(path);
+	std::string key = fullpath;
+	if (!exist(fullpath)) {
+		free(fullpath);
+		fullpath = paths_fallbackfile(path);
+	}
+	size_t len = 0;
+	const unsigned char* data = map_file(fullpath, &len);
+	free(fullpath);
+	if (data == NULL)
+		return NULL;
+
+	struct map_view* view = new struct map_view;
+	view->data = data;
+	view->len = len;
+	view->key = key;
+	return view;
+}
+
+void map_view_close(struct map_view* view) {
+	if (view == NULL)
+		return;
+	unmap_file(view->data, view->len);
+	delete view;
+}
+
+int map_view_nb_screens(const struct map_view* view) {
+	return view->len / sizeof(struct mapdat_screen);
+}
+
+/**
+ * Decode screen 'num' the way load_screen_stdio() does. Returns -1 if
+ * the file is too short.
+ */
+int map_view_read_screen(const struct map_view* view, int num,
+						struct editor_screen* screen) {
+	if (num < 1 || num > map_view_nb_screens(view))
+		return -1;
+	const struct mapdat_screen* rec = (const struct mapdat_screen*)
+		(view->data + sizeof(struct mapdat_screen) * (num - 1));
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	/* Swap a copy of the record, one run of ints at a time */
+	static thread_local struct mapdat_screen swapped;
+	memcpy(&swapped, rec, sizeof(swapped));
+	for (int i = 0; i < 97; i++)
+		decode_lsb_ints(&swapped.t[i].square_full_idx0, &swapped.t[i].square_full_idx0, 3);
+	for (int i = 0; i < 101; i++) {
+		struct mapdat_sprite* sp = &swapped.sprite[i];
+		decode_lsb_ints(&sp->x, &sp->x, 6);
+		decode_lsb_ints(&sp->rotation, &sp->rotation, 3);
+		decode_lsb_ints(&sp->speed, &sp->speed, 27);
+	}
+	rec = &swapped;
+#endif
+
+	for (int i = 0; i < 97; i++) {
+		screen->t[i].square_full_idx0 = rec->t[i].square_full_idx0;
+		screen->t[i].althard = rec->t[i].althard;
+	}
+
+	for (int i = 0; i < 101; i++) {
+		const struct mapdat_sprite* in = &rec->sprite[i];
+		struct editor_sprite* out = &screen->sprite[i];
+		out->x = in->x;
+		out->y = in->y;
+		out->seq = in->seq;
+		out->frame = in->frame;
+		out->type = in->type;
+		out->size = in->size;
+		out->active = in->active;
+		out->rotation = in->rotation;
+		out->special = in->special;
+		out->brain = in->brain;
+		memcpy(out->script, in->script, 52);
+		out->script[52 - 1] = '\0'; // safety
+		out->speed = in->speed;
+		out->base_walk = in->base_walk;
+		out->base_idle = in->base_idle;
+		out->base_attack = in->base_attack;
+		out->base_hit = in->base_hit;
+		out->timing = in->timing;
+		out->que = in->que;
+		out->hard = in->hard;
+		out->alt.left = in->alt_left;
+		out->alt.top = in->alt_top;
+		out->alt.right = in->alt_right;
+		out->alt.bottom = in->alt_bottom;
+		out->is_warp = in->is_warp;
+		out->warp_map = in->warp_map;
+		out->warp_x = in->warp_x;
+		out->warp_y = in->warp_y;
+		out->parm_seq = in->parm_seq;
+		out->base_die = in->base_die;
+		out->gold = in->gold;
+		out->hitpoints = in->hitpoints;
+		out->strength = in->strength;
+		out->defense = in->defense;
+		out->exp = in->exp;
+		out->sound = in->sound;
+		out->vision = in->vision;
+		out->nohit = in->nohit;
+		out->touch_damage = in->touch_damage;
+		memcpy(out->userdata, in->userdata, 20);
+		out->userdata[20 - 1] = '\0';
+	}
+
+	memcpy(screen->script, rec->script, 21);
+	screen->script[21 - 1] = '\0'; // safety
+	return 0;
+}
+
+/* The map.dat load_screen_to() reads from, kept mapped until it is
+saved to. Also used from the screen prefetch thread. */
+static std::mutex shared_mutex;
+static struct map_view* shared = NULL;
+
+/**
+ * Read a screen through the shared mapping of 'path'. Returns -1 if
+ * it can't be mapped or doesn't have that screen.
+ */
+int map_view_load_screen(const char* path, int num, struct editor_screen* screen) {
+	char* fullpath = paths_dmodfile(path);
+	std::lock_guard<std::mutex> lock(shared_mutex);
+	if (shared == NULL || shared->key != fullpath) {
+		map_view_close(shared);
+		shared = map_view_open(path);
+	}
+	free(fullpath);
+	if (shared == NULL)
+		return -1;
+	return map_view_read_screen(shared, num, screen);
+}
+
+/**
+ * Drop the shared mapping, after map.dat was written to
+ */
+void map_view_forget(void) {
+	std::lock_guard<std::mutex> lock(shared_mutex);
+	map_view_close(shared);
+	shared = NULL;
+}
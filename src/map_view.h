@@ -0,0 +1,40 @@
+/**
+ * map.dat mapped in memory
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MAP_VIEW_H
+#define _MAP_VIEW_H
+
+#include "editor_screen.h"
+
+struct map_view;
+
+extern struct map_view* map_view_open(const char* path);
+extern void map_view_close(struct map_view* view);
+extern int map_view_nb_screens(const struct map_view* view);
+extern int map_view_read_screen(const struct map_view* view, int num,
+								struct editor_screen* screen);
+
+extern int map_view_load_screen(const char* path, int num,
+								struct editor_screen* screen);
+extern void map_view_forget(void);
+
+#endif
@@ -173,6 +173,7 @@ std::string settingsPath() {
 #endif
 void ts_paths_init() {
 	char* cwd = paths_getcwd();
+	ciconvert_cache_invalidate(NULL);
 	pkgdatadir = br_build_path(cwd, "tmp_ts/pkgdatadir");
 	fallbackdir = br_build_path(cwd, "tmp_ts/fallbackdir");
 	dmoddir = br_build_path(cwd, "tmp_ts/dmoddir");
@@ -223,6 +224,7 @@ void ts_paths_init() {
 
 bool paths_init(char* argv0, char* refdir_opt, char* dmoddir_opt) {
 	char* refdir = NULL;
+	ciconvert_cache_invalidate(NULL);
 
 	/** pkgdatadir **/
 	{
@@ -506,6 +508,15 @@ char* paths_getluarequire(void) {
 	return fullpath;
 }
 
+/**
+ * ciconvert() caches directory listings, drop the one we may have
+ * just added a file to
+ */
+static void paths_written(const char* fullpath, const char* mode) {
+	if (strpbrk(mode, "wa") != NULL)
+		ciconvert_cache_invalidate(fullpath);
+}
+
 char* paths_dmodfile(const char* file) {
 	char* fullpath = br_build_path(dmoddir, file);
 	ciconvert(fullpath);
@@ -515,6 +526,7 @@ char* paths_dmodfile(const char* file) {
 FILE* paths_dmodfile_fopen(const char* file, const char* mode) {
 	char* fullpath = paths_dmodfile(file);
 	FILE* result = fopen(fullpath, mode);
+	paths_written(fullpath, mode);
 	free(fullpath);
 	return result;
 }
@@ -528,6 +540,7 @@ char* paths_fallbackfile(const char* file) {
 FILE* paths_fallbackfile_fopen(const char* file, const char* mode) {
 	char* fullpath = paths_fallbackfile(file);
 	FILE* result = fopen(fullpath, mode);
+	paths_written(fullpath, mode);
 	free(fullpath);
 	return result;
 }
@@ -541,6 +554,7 @@ char* paths_pkgdatafile(const char* file) {
 FILE* paths_pkgdatafile_fopen(const char* file, const char* mode) {
 	char* fullpath = paths_pkgdatafile(file);
 	FILE* result = fopen(fullpath, mode);
+	paths_written(fullpath, mode);
 	free(fullpath);
 	return result;
 }
@@ -592,6 +606,9 @@ exclusive mount point. */
 	if (fp == NULL)
 		fp = fopen(fullpath_in_userappdir, mode);
 
+	/* May also have created the save directory */
+	if (strpbrk(mode, "wa") != NULL)
+		ciconvert_cache_invalidate(NULL);
 	free(fullpath_in_dmoddir);
 	free(fullpath_in_userappdir);
 
@@ -642,6 +659,8 @@ exclusive mount point. */
 	if (fp == NULL) {
 		fp = fopen(fullpath_in_dmoddir, mode);
 		fclose(fp);
+		if (strpbrk(mode, "wa") != NULL)
+			ciconvert_cache_invalidate(NULL);
 		return fullpath_in_dmoddir;
 	}
 
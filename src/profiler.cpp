@@ -0,0 +1,310 @@
+/**
+ * Per-subsystem frame profiler
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_set>
+#include <unordered_map>
+
+#include "io_util.h"
+#include "log.h"
+
+bool prof_enabled = false;
+
+static const char* zone_names[PROF_NB_ZONES] = {
+	"Other",
+	"Input",
+	"Sprite ranking",
+	"Brains",
+	"Hardness checks",
+	"Sprite drawing",
+	"Text",
+	"Scripts",
+	"Callbacks",
+	"Sound",
+	"Flip",
+	"Frame limiter",
+};
+
+/* Completed scopes and frames go to ring buffers that are only
+written by the main thread. The write index is published after the
+slot is filled, so a reader can copy the most recent entries without
+locking and discard the ones that were overwritten meanwhile. */
+template <typename T, Uint32 N>
+struct prof_ring {
+	T* slots = NULL;
+	std::atomic<Uint32> head{0};
+
+	void push(const T& item) {
+		Uint32 h = head.load(std::memory_order_relaxed);
+		slots[h % N] = item;
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	/* Copy up to 'max' of the latest entries, oldest first */
+	int copy(T* out, int max) {
+		if (slots == NULL || max <= 0)
+			return 0;
+		Uint32 end = head.load(std::memory_order_acquire);
+		Uint32 n = std::min(std::min(end, N), (Uint32)max);
+		Uint32 begin = end - n;
+		for (Uint32 i = 0; i < n; i++)
+			out[i] = slots[(begin + i) % N];
+		/* Drop what the writer lapped while we were copying */
+		Uint32 now = head.load(std::memory_order_acquire);
+		Uint32 lapped = (now - begin > N) ? now - begin - N : 0;
+		if (lapped >= n)
+			return 0;
+		if (lapped > 0)
+			memmove(out, out + lapped, (n - lapped) * sizeof(T));
+		return n - lapped;
+	}
+};
+
+static prof_ring<struct prof_event, PROF_MAX_EVENTS> events;
+static prof_ring<struct prof_frame, PROF_MAX_FRAMES> frames;
+
+#define PROF_MAX_DEPTH 64
+struct prof_open_scope {
+	Uint64 start;
+	Uint64 children;
+	const char* name;
+	int zone;
+};
+static struct prof_open_scope stack[PROF_MAX_DEPTH];
+static int depth = 0;
+static Uint64 zone_ticks[PROF_NB_ZONES];
+
+struct prof_script_acc {
+	Uint64 calls;
+	Uint64 ticks;
+};
+static std::unordered_set<std::string> names;
+static std::unordered_map<const char*, struct prof_script_acc> scripts;
+
+static Uint64 freq = 1;
+static Uint64 origin = 0;
+static char* trace_path = NULL;
+
+static const char* intern(const char* name) {
+	return names.emplace(name).first->c_str();
+}
+
+static double ticks_to_ms(Uint64 ticks) {
+	return ticks * 1000.0 / freq;
+}
+
+static double ticks_to_us(Uint64 ticks) {
+	return ticks * 1000000.0 / freq;
+}
+
+void prof_enable(bool on) {
+	if (on && events.slots == NULL) {
+		events.slots = new struct prof_event[PROF_MAX_EVENTS];
+		frames.slots = new struct prof_frame[PROF_MAX_FRAMES];
+		freq = SDL_GetPerformanceFrequency();
+		origin = SDL_GetPerformanceCounter();
+	}
+	/* Buffers stay around: scopes opened while enabled still close */
+	prof_enabled = on;
+}
+
+/**
+ * Write a Chrome trace of the buffered events to 'path' when quitting
+ */
+void prof_set_trace_path(const char* path) {
+	free(trace_path);
+	trace_path = (path != NULL) ? strdup(path) : NULL;
+}
+
+void prof_quit() {
+	if (trace_path != NULL) {
+		prof_write_trace(trace_path);
+		free(trace_path);
+		trace_path = NULL;
+	}
+	prof_enabled = false;
+	delete[] events.slots;
+	delete[] frames.slots;
+	events.slots = NULL;
+	frames.slots = NULL;
+	events.head = 0;
+	frames.head = 0;
+	depth = 0;
+	scripts.clear();
+	names.clear();
+}
+
+void prof_frame_begin() {
+	depth = 0;
+	memset(zone_ticks, 0, sizeof(zone_ticks));
+	if (prof_enabled)
+		prof_begin(PROF_FRAME, NULL);
+}
+
+void prof_frame_end() {
+	if (depth == 0 || stack[0].zone != PROF_FRAME) {
+		depth = 0;
+		return;
+	}
+	Uint64 start = stack[0].start;
+	while (depth > 0)
+		prof_end();
+
+	struct prof_frame f;
+	f.start = start;
+	f.total_ms = 0;
+	for (int i = 0; i < PROF_NB_ZONES; i++) {
+		f.zone_ms[i] = ticks_to_ms(zone_ticks[i]);
+		f.total_ms += f.zone_ms[i];
+	}
+	frames.push(f);
+}
+
+void prof_begin(enum prof_zone zone, const char* name) {
+	if (depth >= PROF_MAX_DEPTH) {
+		depth++; // keep prof_end() balanced
+		return;
+	}
+	struct prof_open_scope* s = &stack[depth++];
+	s->zone = zone;
+	s->name = (name != NULL) ? intern(name) : zone_names[zone];
+	s->children = 0;
+	s->start = SDL_GetPerformanceCounter();
+}
+
+void prof_end() {
+	if (depth == 0)
+		return;
+	if (depth > PROF_MAX_DEPTH) {
+		depth--;
+		return;
+	}
+	Uint64 end = SDL_GetPerformanceCounter();
+	struct prof_open_scope* s = &stack[--depth];
+	Uint64 ticks = end - s->start;
+	Uint64 self = (ticks > s->children) ? ticks - s->children : 0;
+	if (depth > 0)
+		stack[depth - 1].children += ticks;
+	zone_ticks[s->zone] += self;
+	if (s->zone == PROF_SCRIPT) {
+		struct prof_script_acc* acc = &scripts[s->name];
+		acc->calls++;
+		acc->ticks += self;
+	}
+
+	struct prof_event ev;
+	ev.start = s->start;
+	ev.end = end;
+	ev.name = s->name;
+	ev.zone = s->zone;
+	ev.depth = depth;
+	events.push(ev);
+}
+
+const char* prof_zone_name(int zone) {
+	if (zone < 0 || zone >= PROF_NB_ZONES)
+		return "?";
+	return zone_names[zone];
+}
+
+int prof_get_frames(struct prof_frame* out, int max) {
+	return frames.copy(out, max);
+}
+
+int prof_get_events(struct prof_event* out, int max) {
+	return events.copy(out, max);
+}
+
+/**
+ * Per-script exclusive time since the last reset, most expensive
+ * first
+ */
+int prof_get_scripts(struct prof_script_stats* out, int max) {
+	std::vector<struct prof_script_stats> all;
+	for (auto& it : scripts)
+		all.push_back({it.first, it.second.calls, ticks_to_ms(it.second.ticks)});
+	std::sort(all.begin(), all.end(),
+		[](const struct prof_script_stats& a, const struct prof_script_stats& b) {
+			return a.ms > b.ms;
+		});
+	int n = std::min((int)all.size(), max);
+	std::copy(all.begin(), all.begin() + n, out);
+	return n;
+}
+
+void prof_reset_scripts() {
+	scripts.clear();
+}
+
+/**
+ * Dump the buffered events in Chrome's trace_event format, viewable
+ * in chrome://tracing or Perfetto
+ */
+/*bool*/ int prof_write_trace(const char* path) {
+	FILE* f = fopen(path, "w");
+	if (f == NULL) {
+		log_error("⏱️ Couldn't write trace %s: %s", path, strerror(errno));
+		return 0;
+	}
+
+	std::vector<struct prof_event> buf(PROF_MAX_EVENTS);
+	int n = prof_get_events(buf.data(), buf.size());
+	/* Events are recorded as scopes close; sort parents first */
+	std::stable_sort(buf.begin(), buf.begin() + n,
+		[](const struct prof_event& a, const struct prof_event& b) {
+			return a.start < b.start || (a.start == b.start && a.depth < b.depth);
+		});
+
+	fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+		"\"args\":{\"name\":\"Main\"}}");
+	for (int i = 0; i < n; i++) {
+		struct prof_event* ev = &buf[i];
+		fprintf(f, ",\n{\"name\":");
+		write_json_string(ev->name, f);
+		fprintf(f, ",\"cat\":");
+		write_json_string(prof_zone_name(ev->zone), f);
+		fprintf(f, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+			ticks_to_us(ev->start - origin), ticks_to_us(ev->end - ev->start));
+	}
+	fprintf(f, "\n]}\n");
+
+	if (fclose(f) != 0) {
+		log_error("⏱️ Couldn't write trace %s: %s", path, strerror(errno));
+		return 0;
+	}
+	log_info("⏱️ Wrote %d profiler events to %s", n, path);
+	return 1;
+}
@@ -0,0 +1,102 @@
+/**
+ * Per-subsystem frame profiler
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include "SDL.h"
+
+/* Frame phases. PROF_FRAME is the root zone: its exclusive time is
+whatever the other zones didn't cover. */
+enum prof_zone {
+	PROF_FRAME = 0,
+	PROF_INPUT,
+	PROF_RANK,
+	PROF_BRAINS,
+	PROF_MOVE,
+	PROF_DRAW,
+	PROF_TEXT,
+	PROF_SCRIPT,
+	PROF_CALLBACKS,
+	PROF_SOUND,
+	PROF_FLIP,
+	PROF_WAIT,
+	PROF_NB_ZONES
+};
+
+/* One timed scope, in performance counter ticks */
+struct prof_event {
+	Uint64 start;
+	Uint64 end;
+	const char* name; // zone or script name, interned
+	Uint16 zone;
+	Uint16 depth;
+};
+
+/* Exclusive time spent in each zone during one frame */
+struct prof_frame {
+	Uint64 start;
+	float total_ms;
+	float zone_ms[PROF_NB_ZONES];
+};
+
+struct prof_script_stats {
+	const char* name;
+	Uint64 calls;
+	double ms; // exclusive
+};
+
+#define PROF_MAX_EVENTS (1 << 18)
+#define PROF_MAX_FRAMES 512
+
+extern bool prof_enabled;
+
+extern void prof_enable(bool on);
+extern void prof_set_trace_path(const char* path);
+extern void prof_quit();
+
+extern void prof_frame_begin();
+extern void prof_frame_end();
+extern void prof_begin(enum prof_zone zone, const char* name);
+extern void prof_end();
+
+extern const char* prof_zone_name(int zone);
+extern int prof_get_frames(struct prof_frame* frames, int max);
+extern int prof_get_events(struct prof_event* events, int max);
+extern int prof_get_scripts(struct prof_script_stats* stats, int max);
+extern void prof_reset_scripts();
+extern /*bool*/ int prof_write_trace(const char* path);
+
+/* Times the enclosing block; costs a flag test when profiling is off */
+struct prof_scope {
+	bool active;
+	prof_scope(enum prof_zone zone, const char* name = NULL) : active(prof_enabled) {
+		if (active)
+			prof_begin(zone, name);
+	}
+	~prof_scope() {
+		if (active)
+			prof_end();
+	}
+};
+
+#endif
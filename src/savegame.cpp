@@ -245,6 +245,7 @@ the original savegame format */
 		play.var[i].active = fgetc(f);
 		fread(skipbuf, 3, 1, f); // reproduce memory alignment
 	}
+	var_index_rebuild();
 
 	play.push_active = fgetc(f);
 	fread(skipbuf, 3, 1, f); // reproduce memory alignment
@@ -0,0 +1,324 @@
+/**
+ * Background loading of the screens around the player
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "screen_prefetch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#include "DMod.h"
+#include "dinkini.h"
+#include "freedink.h" /* map_width, number_of_screens */
+#include "game_state.h"
+#include "gfx_sprites.h"
+#include "live_screen.h" /* playl, playx, playy */
+#include "live_sprites_manager.h"
+#include "log.h"
+
+/**
+ * A loader thread reads the map.dat records of the screens next to
+ * the player, so that crossing an edge is a memcpy. Once the player
+ * heads for an edge, the sequences of the screen behind it are
+ * decoded too, and picked up by check_seq_status() ->
+ * load_sprites(). Everything that touches seq[]/GFX_k[] stays on the
+ * main thread.
+ */
+
+#define NB_NEIGHBOURS 4
+/* How close to an edge (in pixels) before decoding the next screen's
+graphics */
+#define WARM_DISTANCE 100
+/* Stay under what gfx_sprites_warm() keeps */
+#define WARM_SEQS_MAX 48
+
+enum slot_state { SLOT_FREE, SLOT_PENDING, SLOT_LOADING, SLOT_READY, SLOT_FAILED };
+struct prefetch_slot {
+	enum slot_state state;
+	int mapdat_num;
+	int generation; // save_screen_count when requested
+	int priority; // lower is sooner
+	struct editor_screen screen;
+};
+struct warm_job {
+	std::string path;
+	int flags;
+	/*bool*/ int goodshadows;
+};
+
+static struct prefetch_slot slots[NB_NEIGHBOURS];
+static std::string map_path;
+static std::vector<struct warm_job> warm_jobs;
+static struct screen_prefetch_stats stats;
+static /*bool*/ int stopping = 0;
+/* Main thread only */
+static int last_player_map = -1;
+static int last_generation = -1;
+static int warmed_num = 0;
+
+#ifndef __EMSCRIPTEN__
+static std::mutex mutex;
+static std::condition_variable cond;
+static std::thread worker;
+
+static struct prefetch_slot* next_pending() {
+	struct prefetch_slot* next = NULL;
+	for (int i = 0; i < NB_NEIGHBOURS; i++)
+		if (slots[i].state == SLOT_PENDING && (next == NULL || slots[i].priority < next->priority))
+			next = &slots[i];
+	return next;
+}
+
+static void worker_main() {
+	std::unique_ptr<struct editor_screen> buf(new struct editor_screen);
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopping) {
+		/* Records first: they're cheap, and needed as soon as the
+		player crosses */
+		struct prefetch_slot* slot = next_pending();
+		if (slot != NULL) {
+			slot->state = SLOT_LOADING;
+			int num = slot->mapdat_num;
+			int generation = slot->generation;
+			std::string path = map_path;
+			lock.unlock();
+			int ret = load_screen_to(path.c_str(), num, buf.get());
+			lock.lock();
+			stats.screens_read++;
+			/* The slot may have been reassigned meanwhile */
+			if (slot->state == SLOT_LOADING && slot->mapdat_num == num
+				&& slot->generation == generation && path == map_path) {
+				if (ret < 0) {
+					slot->state = SLOT_FAILED;
+				} else {
+					memcpy(&slot->screen, buf.get(), sizeof(struct editor_screen));
+					slot->state = SLOT_READY;
+				}
+			}
+			continue;
+		}
+
+		if (!warm_jobs.empty()) {
+			struct warm_job job = warm_jobs.front();
+			warm_jobs.erase(warm_jobs.begin());
+			lock.unlock();
+			gfx_sprites_warm(job.path.c_str(), job.flags, job.goodshadows);
+			lock.lock();
+			continue;
+		}
+
+		cond.wait(lock);
+	}
+}
+
+/* Screens the player can walk to, as in did_player_cross_screen(),
+nearest edge first */
+static int get_neighbours(int* nums, int* dists) {
+	int here = *pplayer_map;
+	int candidates[NB_NEIGHBOURS] = { here - 1, here + 1, here - map_width, here + map_width };
+	int edge_dists[NB_NEIGHBOURS] = { spr[1].x - playl, (playx - 1) - spr[1].x,
+		spr[1].y, (playy - 1) - spr[1].y };
+	int n = 0;
+	for (int i = 0; i < NB_NEIGHBOURS; i++) {
+		int map = candidates[i];
+		if (map < 1 || map > number_of_screens || g_dmod.map.loc[map] <= 0)
+			continue;
+		/* Insertion sort by distance */
+		int j = n++;
+		for (; j > 0 && dists[j - 1] > edge_dists[i]; j--) {
+			nums[j] = nums[j - 1];
+			dists[j] = dists[j - 1];
+		}
+		nums[j] = g_dmod.map.loc[map];
+		dists[j] = edge_dists[i];
+	}
+	return n;
+}
+
+/* Point the slots at the screens around the player; keep the ones
+already read */
+static void request_screens(int* nums, int n) {
+	for (int i = 0; i < NB_NEIGHBOURS; i++) {
+		int wanted = -1;
+		for (int j = 0; j < n; j++)
+			if (slots[i].mapdat_num == nums[j])
+				wanted = j;
+		if (wanted < 0 || slots[i].generation != save_screen_count
+			|| map_path != g_dmod.map.map_dat) {
+			slots[i].state = SLOT_FREE;
+			slots[i].mapdat_num = 0;
+		} else {
+			slots[i].priority = wanted;
+		}
+	}
+	map_path = g_dmod.map.map_dat;
+	for (int j = 0; j < n; j++) {
+		int found = 0;
+		for (int i = 0; i < NB_NEIGHBOURS; i++)
+			if (slots[i].state != SLOT_FREE && slots[i].mapdat_num == nums[j])
+				found = 1;
+		if (found)
+			continue;
+		for (int i = 0; i < NB_NEIGHBOURS; i++) {
+			if (slots[i].state == SLOT_FREE) {
+				slots[i].state = SLOT_PENDING;
+				slots[i].mapdat_num = nums[j];
+				slots[i].generation = save_screen_count;
+				slots[i].priority = j;
+				break;
+			}
+		}
+	}
+	/* Graphics queued for a screen we left are no longer urgent */
+	warm_jobs.clear();
+}
+
+static void queue_seq(int seq_no, std::set<int>* seen) {
+	if (warm_jobs.size() >= WARM_SEQS_MAX || !seen->insert(seq_no).second)
+		return;
+	int flags = 0;
+	char* path = seq_unloaded_source(seq_no, &flags);
+	if (path == NULL)
+		return;
+	warm_jobs.push_back({path, flags, gfx_sprites_goodshadows()});
+	stats.seqs_queued++;
+	free(path);
+}
+
+/* Queue the sequences game_place_sprites() and the brains would load
+for this screen */
+static void queue_screen_seqs(struct editor_screen* screen) {
+	std::set<int> seen;
+	for (int j = 1; j <= MAX_SPRITES_EDITOR; j++) {
+		struct editor_sprite* sp = &screen->sprite[j];
+		if (!sp->active || (sp->vision != 0 && sp->vision != *pvision))
+			continue;
+		queue_seq(sp->seq, &seen);
+		int bases[] = { sp->base_walk, sp->base_idle, sp->base_attack, sp->base_die };
+		for (int base : bases)
+			if (base > 0)
+				for (int dir = 1; dir < 10; dir++)
+					queue_seq(base + dir, &seen);
+	}
+}
+#endif
+
+/**
+ * Follow the player: called once per frame during play
+ */
+void screen_prefetch_update() {
+#ifndef __EMSCRIPTEN__
+	if (stopping)
+		return;
+	if (!worker.joinable())
+		worker = std::thread(worker_main);
+
+	int nums[NB_NEIGHBOURS], dists[NB_NEIGHBOURS];
+	int n = get_neighbours(nums, dists);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (*pplayer_map != last_player_map || save_screen_count != last_generation
+		|| map_path != g_dmod.map.map_dat) {
+		request_screens(nums, n);
+		last_player_map = *pplayer_map;
+		last_generation = save_screen_count;
+		warmed_num = 0;
+		cond.notify_one();
+	}
+
+	/* Heading for an edge: decode what's behind it */
+	if (n == 0 || dists[0] > WARM_DISTANCE || nums[0] == warmed_num)
+		return;
+	for (int i = 0; i < NB_NEIGHBOURS; i++) {
+		if (slots[i].state == SLOT_READY && slots[i].mapdat_num == nums[0]) {
+			warm_jobs.clear();
+			queue_screen_seqs(&slots[i].screen);
+			warmed_num = nums[0];
+			cond.notify_one();
+		}
+	}
+#endif
+}
+
+/**
+ * Copy screen 'mapdat_num' if it was read ahead. Returns 0 if it
+ * needs to be loaded from map.dat.
+ */
+/*bool*/ int screen_prefetch_take(int mapdat_num, struct editor_screen* screen) {
+#ifndef __EMSCRIPTEN__
+	if (!worker.joinable())
+		return 0;
+	std::lock_guard<std::mutex> lock(mutex);
+	for (int i = 0; i < NB_NEIGHBOURS; i++) {
+		if (slots[i].state == SLOT_READY && slots[i].mapdat_num == mapdat_num
+			&& slots[i].generation == save_screen_count && map_path == g_dmod.map.map_dat) {
+			memcpy(screen, &slots[i].screen, sizeof(struct editor_screen));
+			stats.hits++;
+			return 1;
+		}
+	}
+	stats.misses++;
+#endif
+	return 0;
+}
+
+void screen_prefetch_quit() {
+#ifndef __EMSCRIPTEN__
+	if (worker.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = 1;
+			cond.notify_all();
+		}
+		worker.join();
+	}
+	for (int i = 0; i < NB_NEIGHBOURS; i++) {
+		slots[i].state = SLOT_FREE;
+		slots[i].mapdat_num = 0;
+	}
+	warm_jobs.clear();
+	stopping = 0;
+	last_player_map = -1;
+	last_generation = -1;
+	warmed_num = 0;
+	gfx_sprites_warm_clear();
+#endif
+}
+
+void screen_prefetch_get_stats(struct screen_prefetch_stats* out) {
+#ifndef __EMSCRIPTEN__
+	std::lock_guard<std::mutex> lock(mutex);
+#endif
+	*out = stats;
+}
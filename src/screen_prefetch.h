@@ -0,0 +1,38 @@
+/**
+ * Background loading of the screens around the player
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SCREEN_PREFETCH_H
+#define _SCREEN_PREFETCH_H
+
+#include "editor_screen.h"
+
+struct screen_prefetch_stats {
+	unsigned int hits, misses;
+	unsigned int screens_read, seqs_queued;
+};
+
+extern void screen_prefetch_update();
+extern /*bool*/ int screen_prefetch_take(int mapdat_num, struct editor_screen* screen);
+extern void screen_prefetch_quit();
+extern void screen_prefetch_get_stats(struct screen_prefetch_stats* stats);
+
+#endif
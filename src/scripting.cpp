@@ -25,6 +25,7 @@
 #include <config.h>
 #endif
 
+#include <ctype.h>
 #include <unistd.h>
 #include <entt/entt.hpp>
 #include "random.hpp"
@@ -37,6 +38,7 @@
 #include "paths.h"
 #include "log.h"
 #include "live_sprites_manager.h"
+#include "live_sprites_grid.h"
 
 #include <libintl.h>
 #define _(String) gettext (String)
@@ -47,6 +49,7 @@
 #include "dinklua.h"
 #include "gnulib.h"
 #include "debug_imgui.h"
+#include "profiler.h"
 
 using randint = effolkronium::random_static;
 
@@ -91,6 +94,82 @@ bool callbacksystem_new = false;
     }
 }
 
+/**
+ * Index of the active play.var[] slots, hashed by variable name, so
+ * that variable lookups don't scan the whole table. Each chain is
+ * kept in slot order, so the first matching slot still wins, as with
+ * the original linear scans (cf. search_var_with_this_scope_107).
+ * Only names are indexed: 'active' and 'scope' are checked on
+ * play.var[] itself.
+ *
+ * Code that activates or reuses a slot must call var_index_add();
+ * code that rewrites play.var[] wholesale (new game, savegame)
+ * calls var_index_rebuild().
+ *
+ * It also counts the indexed names without a '&', which
+ * var_replace() needs to be sure a line without '&' has nothing to
+ * replace.
+ */
+#define VAR_INDEX_BUCKETS 512
+static short var_index_head[VAR_INDEX_BUCKETS]; /* 0 = empty */
+static short var_index_next[MAX_VARS];
+static unsigned int var_index_hashes[MAX_VARS];
+static /*bool*/char var_index_indexed[MAX_VARS];
+static /*bool*/char var_index_plain[MAX_VARS];
+static int var_index_nb_plain = 0;
+
+/* Case-insensitive, like compare() */
+static unsigned int var_index_hash(const char* name)
+{
+  unsigned int h = 2166136261u;
+  for (; *name != '\0'; name++)
+    {
+      h ^= (unsigned char)tolower((unsigned char)*name);
+      h *= 16777619u;
+    }
+  return h;
+}
+
+static void var_index_remove(int slot)
+{
+  if (!var_index_indexed[slot])
+    return;
+  short* link = &var_index_head[var_index_hashes[slot] % VAR_INDEX_BUCKETS];
+  while (*link != slot)
+    link = &var_index_next[*link];
+  *link = var_index_next[slot];
+  var_index_indexed[slot] = /*false*/0;
+  if (var_index_plain[slot])
+    var_index_nb_plain--;
+}
+
+static void var_index_add(int slot)
+{
+  var_index_remove(slot);
+  unsigned int h = var_index_hash(play.var[slot].name);
+  short* link = &var_index_head[h % VAR_INDEX_BUCKETS];
+  while (*link != 0 && *link < slot)
+    link = &var_index_next[*link];
+  var_index_next[slot] = *link;
+  *link = slot;
+  var_index_hashes[slot] = h;
+  var_index_indexed[slot] = /*true*/1;
+  var_index_plain[slot] = (strchr(play.var[slot].name, '&') == NULL);
+  if (var_index_plain[slot])
+    var_index_nb_plain++;
+}
+
+void var_index_rebuild()
+{
+  memset(var_index_head, 0, sizeof(var_index_head));
+  memset(var_index_indexed, 0, sizeof(var_index_indexed));
+  var_index_nb_plain = 0;
+  int i;
+  for (i = 1; i < MAX_VARS; i++)
+    if (play.var[i].active)
+      var_index_add(i);
+}
+
 /**
  * v1.07-style scope. This function is buggy: the first memory slot
  * has precedence (independently of local/global scope).
@@ -100,9 +179,11 @@ bool callbacksystem_new = false;
  */
 int search_var_with_this_scope_107(char* variable, int var_scope)
 {
+  unsigned int h = var_index_hash(variable);
   int i;
-  for (i = 1; i < MAX_VARS; i ++)
-    if (play.var[i].active == 1
+  for (i = var_index_head[h % VAR_INDEX_BUCKETS]; i != 0; i = var_index_next[i])
+    if (var_index_hashes[i] == h
+	&& play.var[i].active == 1
 	&& ((play.var[i].scope == VAR_GLOBAL_SCOPE) || (play.var[i].scope == var_scope))
 	&& (compare(play.var[i].name, variable)))
       return i;
@@ -122,17 +203,19 @@ int search_var_with_this_scope_108(char* variable, int var_scope)
   search_scope[0] = var_scope; /* first local scope */
   search_scope[1] = VAR_GLOBAL_SCOPE; /* then global scope */
 
+  unsigned int h = var_index_hash(variable);
   int i;
   for (i = 0; i < 2; i++)
     {
-      //We'll start going through every var, starting at one
+      //We'll go through every var with this name, in slot order
       int v;
-      for (v = 1; v < MAX_VARS; v++)
+      for (v = var_index_head[h % VAR_INDEX_BUCKETS]; v != 0; v = var_index_next[v])
 	{
 	  //Okay... make sure the var is active,
 	  //The scope should match the script,
 	  //Then make sure the name is the same.
-	  if (play.var[v].active
+	  if (var_index_hashes[v] == h
+	      && play.var[v].active
 	      && play.var[v].scope == search_scope[i]
 	      && compare (play.var[v].name, variable))
 	    return v;
@@ -151,14 +234,15 @@ int search_var_with_this_scope(char* variable, int scope)
   return search_var_with_this_scope_107(variable, scope);
 }
 
-int var_exists(char name[20], int scope)
+int var_exists(const char name[20], int scope)
 {
+  unsigned int h = var_index_hash(name);
   int i;
-  for (i = 1; i < MAX_VARS; i++)
+  for (i = var_index_head[h % VAR_INDEX_BUCKETS]; i != 0; i = var_index_next[i])
   {
-    if (play.var[i].active)
+    if (var_index_hashes[i] == h && play.var[i].active)
     {
-      if (compare(play.var[i].name, name))
+      if (compare(play.var[i].name, (char*)name))
       {
         if (scope == play.var[i].scope)
         {
@@ -215,6 +299,7 @@ int scripting_make_int(char name[80], int value, int scope)
       strcpy(play.var[i].name, name);
       //g("var %s created, used slot %d ", name,i);
       play.var[i].var = value;
+      var_index_add(i);
       return 1;
     }
   }
@@ -254,27 +339,26 @@ static void var_replace_107(char** line_p, int scope)
  *   understanding what exactly is an end-of-variable delimiter, if
  *   such a thing exists)
  */
-static void var_replace_108(int i, int script, char** line_p, char *prevar)
+static void var_replace_108(int* slots, int nb_slots, int s, int script,
+			    char** line_p, char *prevar)
 {
-  while (i < MAX_VARS)
+  for (; s < nb_slots; s++)
     {
-      //First, make sure the variable is active.
-      //Then, make sure it is in scope,
-      //Then, see if the variable name is in the line
+      int i = slots[s];
+      //See if the variable name is in the line,
       //Then, prevar is null, or if prevar isn't null, see if current variable starts with prevar
-      if (play.var[i].active
-	  && i == search_var_with_this_scope_108(play.var[i].name, script)
-	  && strstr (*line_p, play.var[i].name)
-	  && (prevar == NULL || (prevar != NULL && strstr (play.var[i].name, prevar))))
+      //Then, make sure it's not hidden by a local variable of the same name
+      if (strstr (*line_p, play.var[i].name)
+	  && (prevar == NULL || (prevar != NULL && strstr (play.var[i].name, prevar)))
+	  && i == search_var_with_this_scope_108(play.var[i].name, script))
 	{
 	  //Look for shorter variables
-	  var_replace_108(i + 1, script, line_p, play.var[i].name);
+	  var_replace_108(slots, nb_slots, s + 1, script, line_p, play.var[i].name);
 	  //we didn't find any, so we replace!
 	  char crap[20];
 	  sprintf(crap, "%d", play.var[i].var);
 	  replace(play.var[i].name, crap, line_p);
 	}
-      i++;
     }
 }
 
@@ -328,11 +412,22 @@ void var_replace_rtdink(int script, char** line_p)
  */
 void var_replace(char** line_p, int scope)
 {
+  /* Replacements are numbers, they can't bring a '&' in */
+  if (var_index_nb_plain == 0 && strchr(*line_p, '&') == NULL)
+    return;
+
   if (dversion >= 108 && dbg.varreplace) {
     var_replace_rtdink(scope, line_p);
   }
   else if (dversion >= 108) {
-    var_replace_108(1, scope, line_p, NULL);
+    /* Only the active variables in scope, in slot order */
+    int slots[MAX_VARS];
+    int nb_slots = 0;
+    for (int i = 1; i < MAX_VARS; i++)
+      if (play.var[i].active
+	  && (play.var[i].scope == VAR_GLOBAL_SCOPE || play.var[i].scope == scope))
+	slots[nb_slots++] = i;
+    var_replace_108(slots, nb_slots, 0, scope, line_p, NULL);
   }
   else {
     var_replace_107(line_p, scope);
@@ -584,7 +679,14 @@ int scripting_run_proc(int script, char* proc)
   if (sinfo[script] == NULL)
     return 0;
 
-  return sinfo[script]->engine->run_script_proc(script, proc);
+  int ret;
+  {
+    prof_scope prof(PROF_SCRIPT, sinfo[script]->name);
+    ret = sinfo[script]->engine->run_script_proc(script, proc);
+  }
+  /* scripts can move anything */
+  sprites_grid_invalidate();
+  return ret;
 }
 
 void scripting_resume_script(int script)
@@ -594,7 +696,11 @@ void scripting_resume_script(int script)
   if (sinfo[script] == NULL)
     return;
 
-  sinfo[script]->engine->resume_script(script);
+  {
+    prof_scope prof(PROF_SCRIPT, sinfo[script]->name);
+    sinfo[script]->engine->resume_script(script);
+  }
+  sprites_grid_invalidate();
 }
 
 void scripting_kill_scripts_owned_by(int sprite)
@@ -818,6 +924,7 @@ int scripting_add_callback(const char name[20], int n1, int n2, int script)
 void scripting_process_callbacks(Uint64 now)
 {
   log_enter("📝 [Scripting] scripting_process_callbacks()");
+  prof_scope prof(PROF_CALLBACKS);
 
   for (int i = 1; i < MAX_SCRIPTS; i++)
     {
@@ -956,7 +1063,10 @@ void scripting_kill_script(int k)
     for (i = 1; i < MAX_VARS; i++)
     {
       if (play.var[i].active && play.var[i].scope == k)
+      {
         play.var[i].active = /*false*/0;
+        var_index_remove(i);
+      }
     }
     log_debug("🔪 Killed script %s. (num %d)", sinfo[k]->name, k);
 
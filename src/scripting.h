@@ -173,8 +173,10 @@ extern char scripting_error[255];
 extern struct script_engine script_engines[3];
 
 extern int var_exists(const char name[20], int scope);
+extern void var_index_rebuild();
 extern int scripting_make_int(char name[80], int value, int scope);
 extern int search_var_with_this_scope(char* variable, int scope);
+extern int search_var_with_this_scope_107(char* variable, int var_scope);
 extern int search_var_with_this_scope_108(char* variable, int var_scope);
 extern /*bool*/int load_game_small(int num, char line[196], int *mytime);
 extern void var_replace(char** line_p, int scope);
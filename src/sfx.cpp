@@ -63,6 +63,7 @@
 #include "math.h"
 #include "sfx.h"
 #include "gfx_sprites.h"
+#include "profiler.h"
 #include "log.h"
 
 //for pitch randomisation
@@ -276,6 +277,7 @@ void update_sound(void) {
 
 	if (!sound_on)
 		return;
+	prof_scope prof(PROF_SOUND);
 
 	for (int i = 1; i < MAX_SPRITES_AT_ONCE; i++) {
 			if (spr[i].active && gSoloud.isVoiceGroup(spr[i].sounds)) {
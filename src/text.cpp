@@ -38,6 +38,7 @@
 #include "text.h"
 #include "log.h"
 #include "sfx.h"
+#include "profiler.h"
 
 #define TEXT_MIN 2700
 #define TEXT_TIMER 77
@@ -112,6 +113,7 @@ int say_text_xy(char* text, int mx, int my, int script) {
 
 /* Get sprite #h, grab its text and display it */
 void text_draw(int h, double brightness) {
+	prof_scope prof(PROF_TEXT);
 	char crap[200];
 	char* cr;
 	rect rcRect;
@@ -223,18 +225,18 @@ void text_draw(int h, double brightness) {
 	else
 		fg = {255, 255, 255};
 
-	std::vector<TextCommand> cmds;
-
 	// Clear cache if color changed (i.e. during truecolor fade_down())
+	bool recolor = false;
 	if (spr[h].text_cache != NULL &&
-		memcmp(&spr[h].text_cache_color, &fg, sizeof(SDL_Color)) == 0) {
+		memcmp(&spr[h].text_cache_color, &fg, sizeof(SDL_Color)) != 0) {
 		delete spr[h].text_cache;
 		spr[h].text_cache = NULL;
+		recolor = true;
 	}
 
 	if (spr[h].text_cache == NULL) {
 		//Crappy speech synthesis. Only trigger if text is long enoguh. i.e. not a single-digit damage number
-		if (dbg.debug_speechsynth && strlen(cr) > 2) {
+		if (dbg.debug_speechsynth && strlen(cr) > 2 && !recolor) {
 			speech.setText(cr);
 		//Play through a bus so we can control it independently
 		//TODO: move this back to sfx
@@ -245,23 +247,11 @@ void text_draw(int h, double brightness) {
 		SDL_Color bg = {8, 14, 21};
 		rect rel = rcRect;
 		rect_offset(&rel, -rcRect.left, -rcRect.top);
-		FONTS_SetTextColor(bg.r, bg.g, bg.b);
-		print_text_wrap_getcmds(cr, &rel, 1, 0, FONT_DIALOG, &cmds);
-		rect_offset(&rel, -2, 0);
-		print_text_wrap_getcmds(cr, &rel, 1, 0, FONT_DIALOG, &cmds);
-		rect_offset(&rel, 1, 1);
-		print_text_wrap_getcmds(cr, &rel, 1, 0, FONT_DIALOG, &cmds);
-		rect_offset(&rel, 0, -2);
-		print_text_wrap_getcmds(cr, &rel, 1, 0, FONT_DIALOG, &cmds);
-
-		FONTS_SetTextColor(fg.r, fg.g, fg.b);
-		rect_offset(&rel, 0, 1);
-		print_text_wrap_getcmds(cr, &rel, 1, 0, FONT_DIALOG, &cmds);
-
-		if (cmds.size() > 0) {
-			IOGfxSurface* surf = print_text_flatten_cmds(&cmds);
+		IOGfxSurface* surf = print_text_outlined(cr, &rel, 1, FONT_DIALOG, fg, bg,
+												&spr[h].text_cache_reldst);
+		if (surf != NULL) {
 			spr[h].text_cache = surf;
-			spr[h].text_cache_reldst = cmds[0].dst;
+			spr[h].text_cache_color = fg;
 			print_text_cache(spr[h].text_cache, spr[h].text_cache_reldst,
 							rcRect.left, rcRect.top);
 		}
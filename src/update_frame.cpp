@@ -43,6 +43,7 @@
 #include "editor_screen.h"
 #include "live_screen.h"
 #include "live_sprite.h"
+#include "live_sprites_grid.h"
 #include "freedink.h"
 #include "brains.h"
 #include "gfx.h"
@@ -57,12 +58,14 @@
 #include "scripting.h"
 #include "text.h"
 #include "game_choice.h"
+#include "screen_prefetch.h"
 #include "game_choice_renderer.h"
 #include "status.h"
 #include "inventory.h"
 #include "savegame.h"
 #include "debug.h"
 #include "debug_imgui.h"
+#include "profiler.h"
 
 /* For printing strings in process_talk */
 #include "gfx_fonts.h"
@@ -338,7 +341,10 @@ trigger_start:
 		CyclePalette();
 
 	max_s = last_sprite_created;
-	screen_rank_game_sprites(rank);
+	{
+		prof_scope prof(PROF_RANK);
+		screen_rank_game_sprites(rank);
+	}
 
 	//Blit from background, which holds the base scene.
 	IOGFX_backbuffer->blit(IOGFX_background, NULL, NULL);
@@ -356,6 +362,10 @@ trigger_start:
 		return;
 	}
 
+	/* Collision checks below query the sprites grid, refreshed as
+	   each sprite moves */
+	sprites_grid_invalidate();
+
 	/* Update all active sprites */
 	for (int j = 0; j <= max_s; j++) {
 		int h = rank[j];
@@ -392,52 +402,55 @@ trigger_start:
 			goto past;
 
 		//brains - predefined bahavior patterns available to any sprite
-		if (spr[h].brain == 1) {
-			run_through_touch_damage_list(h);
-			if (process_warp == 0)
-				human_brain(h);
+		{
+			prof_scope prof(PROF_BRAINS);
+			if (spr[h].brain == 1) {
+				run_through_touch_damage_list(h);
+				if (process_warp == 0)
+					human_brain(h);
+			}
+			if (spr[h].brain == 2)
+				bounce_brain(h);
+			if (spr[h].brain == 0)
+				no_brain(h);
+			if (spr[h].brain == 3)
+				duck_brain(h);
+			if (spr[h].brain == 4)
+				pig_brain(h);
+			if (spr[h].brain == 5)
+				one_time_brain(h);
+			if (spr[h].brain == 6)
+				repeat_brain(h);
+			if (spr[h].brain == 7)
+				one_time_brain_for_real(h);
+			if (spr[h].brain == 8)
+				text_brain(h);
+			if (spr[h].brain == 9)
+				pill_brain(h);
+			if (spr[h].brain == 10)
+				dragon_brain(h);
+			if (spr[h].brain == 11)
+				missile_brain(h, /*true*/ 1);
+			if (spr[h].brain == 12)
+				scale_brain(h);
+			if (spr[h].brain == 13)
+				mouse_brain(h);
+			if (spr[h].brain == 14)
+				button_brain(h);
+			if (spr[h].brain == 15)
+				shadow_brain(h);
+			if (spr[h].brain == 16)
+				people_brain(h);
+			if (spr[h].brain == 17)
+				missile_brain_expire(h);
+			//ye: extra brains
+			if (spr[h].brain == 9000)
+				pingpong_brain(h);
+			if (spr[h].brain == 9001)
+				circle_brain(h);
+			if (spr[h].brain == 9002)
+				bounce_brain_superior(h);
 		}
-		if (spr[h].brain == 2)
-			bounce_brain(h);
-		if (spr[h].brain == 0)
-			no_brain(h);
-		if (spr[h].brain == 3)
-			duck_brain(h);
-		if (spr[h].brain == 4)
-			pig_brain(h);
-		if (spr[h].brain == 5)
-			one_time_brain(h);
-		if (spr[h].brain == 6)
-			repeat_brain(h);
-		if (spr[h].brain == 7)
-			one_time_brain_for_real(h);
-		if (spr[h].brain == 8)
-			text_brain(h);
-		if (spr[h].brain == 9)
-			pill_brain(h);
-		if (spr[h].brain == 10)
-			dragon_brain(h);
-		if (spr[h].brain == 11)
-			missile_brain(h, /*true*/ 1);
-		if (spr[h].brain == 12)
-			scale_brain(h);
-		if (spr[h].brain == 13)
-			mouse_brain(h);
-		if (spr[h].brain == 14)
-			button_brain(h);
-		if (spr[h].brain == 15)
-			shadow_brain(h);
-		if (spr[h].brain == 16)
-			people_brain(h);
-		if (spr[h].brain == 17)
-			missile_brain_expire(h);
-		//ye: extra brains
-		if (spr[h].brain == 9000)
-			pingpong_brain(h);
-		if (spr[h].brain == 9001)
-			circle_brain(h);
-		if (spr[h].brain == 9002)
-			bounce_brain_superior(h);
 
 	animate:
 		move_result = check_if_move_is_legal(h);
@@ -465,12 +478,14 @@ trigger_start:
 	past:
 		check_seq_status(spr[h].seq);
 		draw_sprite_game(IOGFX_backbuffer, h);
+		sprites_grid_touch(h);
 	} /* for 0->max_s */
 
 	apply_mode();
 
 	/* Screen transition? */
 	if (spr[1].active && spr[1].brain == 1) {
+		screen_prefetch_update();
 		if (did_player_cross_screen()) {
 			/* let's restart and draw the next screen,
 	did_player_cross_screen->grab_trick() screenshot'd the current one
@@ -537,6 +537,108 @@ public:
 		delete backbuffer;
 	}
 
+	void ctest_blitStretch_cache() {
+		SDL_Surface *img, *screenshot;
+		IOGfxSurface *backbuffer, *surf;
+		SDL_Color cs;
+		SDL_Rect bbbox;
+		struct gfx_stretch_cache_stats before, after;
+
+		backbuffer = display->allocBuffer(50, 50);
+		bbbox = {0, 0, 50, 50};
+
+		img = SDL_CreateRGBSurface(0, 5, 5, 8, 0, 0, 0, 0);
+		Uint8* pixels = (Uint8*)img->pixels;
+		SDL_SetPaletteColors(img->format->palette, GFX_ref_pal, 0, 256);
+		SDL_SetColorKey(img, SDL_TRUE, 0);
+		pixels[0] = 255;
+		pixels[1] = 1;
+		surf = display->upload(img);
+
+		gfx_stretch_cache_get_stats(&before);
+		for (int i = 0; i < 2; i++) {
+			SDL_Rect dstrect = {0, 0, 10, 20};
+			backbuffer->blitStretch(surf, NULL, &dstrect);
+			display->flipDebug(backbuffer);
+			screenshot = display->screenshot(&bbbox);
+			getColorAtRGBA(screenshot, 0, 3, &cs);
+			TS_ASSERT_SAME_DATA(&cs, &white, sizeof(SDL_Color));
+			getColorAtRGBA(screenshot, 3, 3, &cs);
+			TS_ASSERT_SAME_DATA(&cs, &green, sizeof(SDL_Color));
+			SDL_FreeSurface(screenshot);
+		}
+		gfx_stretch_cache_get_stats(&after);
+		TS_ASSERT_EQUALS(after.misses - before.misses, 1);
+		TS_ASSERT_EQUALS(after.hits - before.hits, 1);
+		TS_ASSERT_EQUALS(after.entries, before.entries + 1);
+
+		// Freeing the source (e.g. free_seq()) drops its zoomed copies
+		delete surf;
+		gfx_stretch_cache_get_stats(&after);
+		TS_ASSERT_EQUALS(after.entries, before.entries);
+		TS_ASSERT_EQUALS(after.bytes, before.bytes);
+
+		delete backbuffer;
+	}
+
+	void ctest_dirty_rects() {
+		SDL_Surface *img, *screenshot;
+		IOGfxSurface *backbuffer, *background, *surf;
+		SDL_Color cs;
+		SDL_Rect bbbox;
+
+		background = display->allocBuffer(50, 50);
+		background->fillRect(NULL, 0, 0, 255);
+		backbuffer = display->allocBuffer(50, 50);
+		bbbox = {0, 0, 50, 50};
+
+		img = SDL_CreateRGBSurface(0, 5, 5, 8, 0, 0, 0, 0);
+		Uint8* pixels = (Uint8*)img->pixels;
+		SDL_SetPaletteColors(img->format->palette, GFX_ref_pal, 0, 256);
+		SDL_SetColorKey(img, SDL_TRUE, 0);
+		pixels[0] = 255;
+		surf = display->upload(img);
+
+		// Moving sprite over a restored background
+		for (int x = 0; x <= 10; x += 10) {
+			SDL_Rect dstrect = {x, 0, -1, -1};
+			backbuffer->blit(background, NULL, NULL);
+			backbuffer->blit(surf, NULL, &dstrect);
+			display->flipDebug(backbuffer);
+		}
+		screenshot = display->screenshot(&bbbox);
+		getColorAtRGBA(screenshot, 0, 0, &cs);
+		TS_ASSERT_SAME_DATA(&cs, &blue, sizeof(SDL_Color));
+		getColorAtRGBA(screenshot, 10, 0, &cs);
+		TS_ASSERT_SAME_DATA(&cs, &white, sizeof(SDL_Color));
+		SDL_FreeSurface(screenshot);
+
+		// Background changes show up too
+		SDL_Rect r = {30, 30, 5, 5};
+		background->fillRect(&r, 255, 255, 0);
+		backbuffer->blit(background, NULL, NULL);
+		display->flipDebug(backbuffer);
+		screenshot = display->screenshot(&bbbox);
+		getColorAtRGBA(screenshot, 10, 0, &cs);
+		TS_ASSERT_SAME_DATA(&cs, &blue, sizeof(SDL_Color));
+		getColorAtRGBA(screenshot, 30, 30, &cs);
+		TS_ASSERT_SAME_DATA(&cs, &green, sizeof(SDL_Color));
+		SDL_FreeSurface(screenshot);
+
+		// Only the previous and new sprite areas need refreshing
+		SDL_Rect dstrect = {20, 0, -1, -1};
+		backbuffer->blit(background, NULL, NULL);
+		backbuffer->blit(surf, NULL, &dstrect);
+		struct gfx_damage damage;
+		dynamic_cast<IOGfxSurfaceSW*>(backbuffer)->takeDamage(&damage);
+		TS_ASSERT_EQUALS(damage.nb_rects, 1);
+		TS_ASSERT_EQUALS(damage.area(), 5 * 5);
+
+		delete surf;
+		delete background;
+		delete backbuffer;
+	}
+
 	void ctest_fillRect() {
 		IOGfxSurface* backbuffer;
 		SDL_Surface* screenshot;
@@ -794,6 +896,16 @@ public:
 		ctest_blit();
 		closeDisplay();
 	}
+	void test_blitStretch_cacheSWTruecolor() {
+		openDisplay(false, true, 0);
+		ctest_blitStretch_cache();
+		closeDisplay();
+	}
+	void test_dirty_rectsSWTruecolor() {
+		openDisplay(false, true, 0);
+		ctest_dirty_rects();
+		closeDisplay();
+	}
 	void test_fillRectSWTruecolor() {
 		openDisplay(false, true, 0);
 		ctest_fillRect();
@@ -830,6 +942,16 @@ public:
 		ctest_blit();
 		closeDisplay();
 	}
+	void test_blitStretch_cacheSW() {
+		openDisplay(false, false, 0);
+		ctest_blitStretch_cache();
+		closeDisplay();
+	}
+	void test_dirty_rectsSW() {
+		openDisplay(false, false, 0);
+		ctest_dirty_rects();
+		closeDisplay();
+	}
 	void test_fillRectSW() {
 		openDisplay(false, false, 0);
 		ctest_fillRect();
@@ -24,16 +24,51 @@
 #include <config.h>
 #endif
 
+#include <stdio.h>
+#include <strings.h>
+#include "SDL.h"
 #include "dinkc.h"
 
 int get_parms(char proc_name[20], int script, char* str_params, int* spec);
+int locate(int script, char* lookup_proc);
+void dinkc_run_script(int script);
+
+/* The linear play.var[] scans that the variable index replaces */
+static int reference_search_107(const char* variable, int var_scope) {
+	for (int i = 1; i < MAX_VARS; i++)
+		if (play.var[i].active == 1 &&
+			(play.var[i].scope == DINKC_GLOBAL_SCOPE ||
+			 play.var[i].scope == var_scope) &&
+			strcasecmp(play.var[i].name, variable) == 0)
+			return i;
+	return -1;
+}
+static int reference_search_108(const char* variable, int var_scope) {
+	int search_scope[2] = {var_scope, DINKC_GLOBAL_SCOPE};
+	for (int s = 0; s < 2; s++)
+		for (int i = 1; i < MAX_VARS; i++)
+			if (play.var[i].active && play.var[i].scope == search_scope[s] &&
+				strcasecmp(play.var[i].name, variable) == 0)
+				return i;
+	return -1;
+}
+
+/* Records the calls made by the DinkC test scripts */
+static int ts_calls[16];
+static int ts_nb_calls = 0;
+static void ts_record(int script, int* yield, int* preturnint, int a, int b) {
+	if (ts_nb_calls < 16)
+		ts_calls[ts_nb_calls++] = a * 100 + b;
+}
 
 /* mocks / link seams */
 #include "game_engine.h"
 int dversion = 107;
 struct player_info play;
 #include "live_sprites_manager.h"
-struct sp spr[MAX_SPRITES_AT_ONCE];
+struct sp_hot spr_hot;
+struct sp_cold spr_cold[MAX_SPRITES_AT_ONCE];
+struct live_sprites spr;
 #include "game_choice.h"
 struct game_choice_struct game_choice;
 int last_sprite_created;
@@ -186,6 +221,159 @@ public:
 		kill_all_vars();
 	}
 
+	void test_dinkc_var_index_first_slot_wins() {
+		// v1.07: a global declared first hides a later local
+		make_int("&tutu", 1, DINKC_GLOBAL_SCOPE, script_id);
+		make_int("&tutu", 2, script_id, script_id);
+		// a local reusing a freed slot before the global
+		make_int("&toto", 3, script_id + 1, script_id);
+		make_int("&toto", 4, DINKC_GLOBAL_SCOPE, script_id);
+		make_int("&TOTO", 5, script_id, script_id);
+		play.var[3].active = 0; /* as when its script is killed */
+		make_int("&toto", 6, script_id + 2, script_id);
+
+		char* names[] = {"&tutu", "&toto", "&Toto", "&missing"};
+		for (int n = 0; n < 4; n++) {
+			for (int scope = 0; scope < script_id + 3; scope++) {
+				TS_ASSERT_EQUALS(search_var_with_this_scope_107(names[n], scope),
+								reference_search_107(names[n], scope));
+				TS_ASSERT_EQUALS(search_var_with_this_scope_108(names[n], scope),
+								reference_search_108(names[n], scope));
+			}
+		}
+
+		// savegames may bring back any slot layout
+		play.var[1].active = 2;
+		play.var[3].scope = script_id;
+		var_index_rebuild();
+		for (int n = 0; n < 4; n++) {
+			TS_ASSERT_EQUALS(search_var_with_this_scope_107(names[n], script_id),
+							reference_search_107(names[n], script_id));
+			TS_ASSERT_EQUALS(search_var_with_this_scope_108(names[n], script_id),
+							reference_search_108(names[n], script_id));
+		}
+		kill_all_vars();
+	}
+
+	void test_dinkc_var_index_many_vars() {
+		char name[20];
+		for (int i = 0; i < 240; i++) {
+			sprintf(name, "&global%d", i);
+			make_int(name, i, DINKC_GLOBAL_SCOPE, script_id);
+		}
+		for (int i = 0; i < 200; i++) {
+			sprintf(name, "&local%d", i % 10);
+			make_int(name, i, 1 + i / 10, script_id);
+		}
+		char lookups[64][20];
+		for (int i = 0; i < 64; i++) {
+			if (i % 4 == 3)
+				sprintf(lookups[i], "&missing%d", i);
+			else if (i % 2)
+				sprintf(lookups[i], "&global%d", i * 3);
+			else
+				sprintf(lookups[i], "&local%d", i % 10);
+		}
+
+		for (int scope = 1; scope <= 16; scope++)
+			for (int i = 0; i < 64; i++)
+				TS_ASSERT_EQUALS(search_var_with_this_scope_108(lookups[i], scope),
+								reference_search_108(lookups[i], scope));
+		kill_all_vars();
+	}
+
+	void test_dinkc_compiled_lines_match_text() {
+		struct binding bd;
+		memset(&bd, 0, sizeof(bd));
+		bd.funcname = (char*)"ts_record";
+		bd.func = (void*)ts_record;
+		bd.params[0] = 1;
+		bd.params[1] = 1;
+		dinkc_bindings["ts_record"] = bd;
+
+		const char* code =
+				"void main( void )\r\n"
+				"{\r\n"
+				"\tts_record(1, 2);\r\n"
+				"  // ts_record(0, 0);\r\n"
+				"\r\n"
+				" if (2 < 1)\r\n"
+				"  ts_record(3, 4);\r\n"
+				" else\r\n"
+				"  ts_record(5, 6);\r\n"
+				" ts_record (7, 8) ;\r\n"
+				" ts_record(9, 10, 11);\r\n"
+				"}\r\n";
+		int text_calls[16];
+		int text_nb_calls;
+		int text_line;
+		for (int compiled = 0; compiled <= 1; compiled++) {
+			kill_script(script_id);
+			script_id = ts_script_init("unit test", strdup(code));
+			if (compiled)
+				ts_script_compile(script_id);
+			ts_nb_calls = 0;
+			TS_ASSERT(locate(script_id, "main"));
+			dinkc_run_script(script_id);
+			if (!compiled) {
+				memcpy(text_calls, ts_calls, sizeof(ts_calls));
+				text_nb_calls = ts_nb_calls;
+				text_line = ((struct refinfo*)sinfo[script_id]->data)->cur_line;
+			}
+		}
+		TS_ASSERT_EQUALS(text_nb_calls, 3);
+		TS_ASSERT_EQUALS(ts_nb_calls, text_nb_calls);
+		TS_ASSERT_SAME_DATA(ts_calls, text_calls, sizeof(int) * ts_nb_calls);
+		TS_ASSERT_EQUALS(((struct refinfo*)sinfo[script_id]->data)->cur_line,
+						text_line);
+		dinkc_bindings.erase("ts_record");
+	}
+
+	void test_dinkc_locate_compiled_matches_scan() {
+		const char* code =
+				"void main( void )\n"
+				"{\n"
+				"loop:\n"
+				"}\r"
+				"VOID Hit(void)\r\n"
+				"{\r\n"
+				" again: \r\n"
+				"}\n"
+				"void main( void )\n";
+		const char* procs[] = { "main", "HIT", "talk" };
+		const char* labels[] = { "again", "LOOP;", "missing" };
+		struct refinfo text[6];
+		for (int compiled = 0; compiled <= 1; compiled++) {
+			kill_script(script_id);
+			script_id = ts_script_init("unit test", strdup(code));
+			if (compiled)
+				ts_script_compile(script_id);
+			struct refinfo* r = (struct refinfo*)sinfo[script_id]->data;
+			for (int i = 0; i < 6; i++) {
+				r->current = 3; r->cur_line = 5; r->cur_col = 7;
+				r->debug_line = 4; r->level = 3;
+				int found;
+				if (i < 3) {
+					found = locate(script_id, (char*)procs[i]);
+				} else {
+					char* label = strdup(labels[i-3]);
+					found = locate_goto(label, script_id);
+					free(label);
+				}
+				TS_ASSERT_EQUALS(found, i % 3 != 2);
+				if (!compiled) {
+					text[i] = *r;
+				} else {
+					TS_ASSERT_EQUALS(r->current, text[i].current);
+					TS_ASSERT_EQUALS(r->cur_line, text[i].cur_line);
+					TS_ASSERT_EQUALS(r->cur_col, text[i].cur_col);
+					TS_ASSERT_EQUALS(r->debug_line, text[i].debug_line);
+					TS_ASSERT_EQUALS(r->level, text[i].level);
+				}
+			}
+		}
+	}
+
 	void test_dinkc_dont_return_same_script_id_twice() {
 		int script_id1 = ts_script_init("script1", strdup(""));
 		int script_id2 = ts_script_init("script2", strdup(""));
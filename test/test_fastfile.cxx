@@ -0,0 +1,136 @@
+/**
+ * Test suite for dir.ff archives
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cxxtest/TestSuite.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "SDL.h"
+#include "fastfile.h"
+
+#define FF_A "test_fastfile_a.ff"
+#define FF_B "test_fastfile_b.ff"
+
+static void write_lsb_int(FILE* f, int n) {
+	fputc(n & 0xff, f);
+	fputc((n >> 8) & 0xff, f);
+	fputc((n >> 16) & 0xff, f);
+	fputc((n >> 24) & 0xff, f);
+}
+
+/* Write a dir.ff holding 'names' with 'contents', plus the end entry */
+static void write_ff(const char* path, const char** names, const char** contents, int n) {
+	FILE* f = fopen(path, "wb");
+	write_lsb_int(f, n + 1);
+	int off = 4 + (n + 1) * 17;
+	for (int i = 0; i <= n; i++) {
+		char name[13];
+		memset(name, 0, sizeof(name));
+		if (i < n)
+			strcpy(name, names[i]);
+		write_lsb_int(f, off);
+		fwrite(name, 13, 1, f);
+		if (i < n)
+			off += strlen(contents[i]);
+	}
+	for (int i = 0; i < n; i++)
+		fputs(contents[i], f);
+	fclose(f);
+}
+
+static int read_entry(struct FF_Reader* r, const char* name, char* buf, int size) {
+	SDL_RWops* rw = NULL;
+	if (!FastFileReaderGet(r, name, &rw) || rw == NULL)
+		return -1;
+	int len = SDL_RWread(rw, buf, 1, size - 1);
+	buf[len] = '\0';
+	SDL_RWclose(rw);
+	return len;
+}
+
+class TestFastFile : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		const char* names_a[] = { "IDLE01.BMP", "idle02.bmp", "walk01.bmp" };
+		const char* contents_a[] = { "first", "second", "third!" };
+		write_ff(FF_A, names_a, contents_a, 3);
+		const char* names_b[] = { "idle01.bmp" };
+		const char* contents_b[] = { "other" };
+		write_ff(FF_B, names_b, contents_b, 1);
+	}
+	void tearDown() {
+		FastFileRegistryClear();
+		remove(FF_A);
+		remove(FF_B);
+	}
+
+	void test_fastfile_lookup() {
+		struct FF_Reader* r = FastFileReaderOpen(FF_A);
+		TS_ASSERT(r != NULL);
+		TS_ASSERT(FastFileReaderHas(r, "idle01.bmp"));
+		TS_ASSERT(FastFileReaderHas(r, "IDLE02.bmp"));
+		TS_ASSERT(!FastFileReaderHas(r, "idle03.bmp"));
+		TS_ASSERT(!FastFileReaderHas(r, "walk01.bmp.and.more"));
+
+		char buf[32];
+		TS_ASSERT_EQUALS(read_entry(r, "Idle02.BMP", buf, sizeof(buf)), 6);
+		TS_ASSERT_SAME_DATA(buf, "second", 6);
+		/* The last entry ends where the end marker says */
+		TS_ASSERT_EQUALS(read_entry(r, "walk01.bmp", buf, sizeof(buf)), 6);
+		TS_ASSERT_SAME_DATA(buf, "third!", 6);
+		TS_ASSERT_EQUALS(read_entry(r, "nothere.bmp", buf, sizeof(buf)), -1);
+		FastFileReaderClose(r);
+	}
+
+	void test_fastfile_shared_mapping() {
+		struct FF_Reader* r1 = FastFileReaderOpen(FF_A);
+		struct FF_Reader* r2 = FastFileReaderOpen(FF_A);
+		struct FF_Reader* r3 = FastFileReaderOpen(FF_B);
+		struct fastfile_stats st;
+		FastFileGetStats(&st);
+		TS_ASSERT_EQUALS(st.archives, 2);
+
+		/* Forgetting the archives doesn't invalidate open handles */
+		FastFileRegistryClear();
+		char buf[32];
+		TS_ASSERT_EQUALS(read_entry(r1, "idle01.bmp", buf, sizeof(buf)), 5);
+		TS_ASSERT_SAME_DATA(buf, "first", 5);
+		TS_ASSERT_EQUALS(read_entry(r3, "idle01.bmp", buf, sizeof(buf)), 5);
+		TS_ASSERT_SAME_DATA(buf, "other", 5);
+		FastFileReaderClose(r1);
+		FastFileReaderClose(r2);
+		FastFileReaderClose(r3);
+	}
+
+	void test_fastfile_bad_archive() {
+		TS_ASSERT(FastFileReaderOpen("test_fastfile_missing.ff") == NULL);
+		FILE* f = fopen(FF_A, "wb");
+		write_lsb_int(f, 1000);
+		fclose(f);
+		TS_ASSERT(FastFileReaderOpen(FF_A) == NULL);
+	}
+};
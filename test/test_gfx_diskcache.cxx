@@ -0,0 +1,117 @@
+/**
+ * Test suite for the on-disk decoded image cache
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cxxtest/TestSuite.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "SDL.h"
+#include "gfx_diskcache.h"
+#include "ImageLoader.h"
+
+class TestGfxDiskcache : public CxxTest::TestSuite {
+public:
+	const char* src;
+
+	void setUp() {
+		ImageLoader::initBlitFormat(SDL_PIXELFORMAT_INDEX8);
+		gfx_diskcache_init("tmp_diskcache");
+		src = "tmp_diskcache_src.bmp";
+		write_src("0123456789");
+	}
+	void tearDown() {
+		gfx_diskcache_quit();
+		remove(src);
+		SDL_FreeSurface(ImageLoader::blitFormat);
+		ImageLoader::blitFormat = NULL;
+	}
+
+	void write_src(const char* contents) {
+		FILE* f = fopen(src, "wb");
+		fputs(contents, f);
+		fclose(f);
+	}
+
+	SDL_Surface* make_surface() {
+		SDL_Surface* s = SDL_CreateRGBSurfaceWithFormat(0, 5, 3, 8, SDL_PIXELFORMAT_INDEX8);
+		Uint8* p = (Uint8*)s->pixels;
+		for (int i = 0; i < s->pitch * s->h; i++)
+			p[i] = i * 7;
+		SDL_SetPaletteColors(s->format->palette,
+							ImageLoader::blitFormat->format->palette->colors, 0, 256);
+		SDL_SetColorKey(s, SDL_TRUE, 255);
+		return s;
+	}
+
+	void test_diskcache_roundtrip() {
+		SDL_Surface* orig = make_surface();
+		gfx_diskcache_store(src, "ab01.bmp", 1, orig);
+
+		SDL_Surface* cached = gfx_diskcache_load(src, "ab01.bmp", 1);
+		TS_ASSERT(cached != NULL);
+		TS_ASSERT_EQUALS(cached->w, orig->w);
+		TS_ASSERT_EQUALS(cached->h, orig->h);
+		TS_ASSERT_EQUALS(cached->format->format, orig->format->format);
+		for (int y = 0; y < orig->h; y++)
+			TS_ASSERT_SAME_DATA((Uint8*)cached->pixels + y * cached->pitch,
+								(Uint8*)orig->pixels + y * orig->pitch, orig->w);
+		Uint32 key = 0;
+		TS_ASSERT_EQUALS(SDL_GetColorKey(cached, &key), 0);
+		TS_ASSERT_EQUALS(key, 255);
+		TS_ASSERT_SAME_DATA(cached->format->palette->colors,
+							orig->format->palette->colors, 256 * sizeof(SDL_Color));
+
+		SDL_FreeSurface(cached);
+		SDL_FreeSurface(orig);
+	}
+
+	void test_diskcache_key() {
+		SDL_Surface* orig = make_surface();
+		gfx_diskcache_store(src, "ab01.bmp", 1, orig);
+
+		// Other flags, member or source file: miss
+		TS_ASSERT(gfx_diskcache_load(src, "ab01.bmp", 2) == NULL);
+		TS_ASSERT(gfx_diskcache_load(src, "ab02.bmp", 1) == NULL);
+		TS_ASSERT(gfx_diskcache_load(src, NULL, 1) == NULL);
+		TS_ASSERT(gfx_diskcache_load("tmp_diskcache_missing.bmp", "ab01.bmp", 1) == NULL);
+
+		// Source was modified: stale
+		write_src("0123456789abcdef");
+		TS_ASSERT(gfx_diskcache_load(src, "ab01.bmp", 1) == NULL);
+
+		SDL_FreeSurface(orig);
+	}
+
+	void test_diskcache_disabled() {
+		gfx_diskcache_init("");
+		TS_ASSERT(gfx_diskcache_get_dir() == NULL);
+		SDL_Surface* orig = make_surface();
+		gfx_diskcache_store(src, NULL, 0, orig);
+		TS_ASSERT(gfx_diskcache_load(src, NULL, 0) == NULL);
+		SDL_FreeSurface(orig);
+	}
+};
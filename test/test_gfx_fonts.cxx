@@ -33,6 +33,7 @@ IOGfxSurface* IOGFX_backbuffer = NULL;
 IOGfxDisplay* g_display = new FakeIOGfxDisplay(0, 0, true, 0);
 #include "test_gfx_fonts_libe.h"
 #include <iostream>
+#include <string.h>
 using namespace std;
 
 char* vgasys_fon;
@@ -97,4 +98,52 @@ public:
 		print_text_flatten_cmds(&cmds);
 		TS_ASSERT_EQUALS(cmds.size(), 1);
 	}
+
+	/* The glyph atlas must draw what the five TTF passes drew */
+	void test_print_text_outlinedTruecolor() {
+		truecolor = 1;
+		ImageLoader::initBlitFormat(SDL_PIXELFORMAT_RGB888);
+		SDL_Color fg = {255, 255, 2}, bg = {8, 14, 21};
+		const char* texts[] = {"toto", "Hello, I'm a talkative fellow with a long line",
+							   "Wordsthatdontfitinthebox at all", "two\nlines", ""};
+		for (const char* text : texts) {
+			char str[100];
+			strcpy(str, text);
+			std::vector<TextCommand> cmds;
+			rect rel = {0, 0, 150, 150};
+			FONTS_SetTextColor(bg.r, bg.g, bg.b);
+			print_text_wrap_getcmds(str, &rel, 1, 0, FONT_DIALOG, &cmds);
+			rect_offset(&rel, -2, 0);
+			print_text_wrap_getcmds(str, &rel, 1, 0, FONT_DIALOG, &cmds);
+			rect_offset(&rel, 1, 1);
+			print_text_wrap_getcmds(str, &rel, 1, 0, FONT_DIALOG, &cmds);
+			rect_offset(&rel, 0, -2);
+			print_text_wrap_getcmds(str, &rel, 1, 0, FONT_DIALOG, &cmds);
+			FONTS_SetTextColor(fg.r, fg.g, fg.b);
+			rect_offset(&rel, 0, 1);
+			print_text_wrap_getcmds(str, &rel, 1, 0, FONT_DIALOG, &cmds);
+
+			rect box = {0, 0, 150, 150};
+			SDL_Rect dst;
+			SDL_Surface* img = print_text_outlined_getsurface(str, &box, 1,
+					FONT_DIALOG, fg, bg, &dst);
+			if (cmds.size() == 0) {
+				TS_ASSERT(img == NULL);
+				continue;
+			}
+			print_text_flatten_cmds(&cmds);
+			SDL_Surface* ref = cmds[0].img;
+			TS_ASSERT(img != NULL);
+			TS_ASSERT_EQUALS(dst.x, cmds[0].dst.x);
+			TS_ASSERT_EQUALS(dst.y, cmds[0].dst.y);
+			TS_ASSERT_EQUALS(img->w, ref->w);
+			TS_ASSERT_EQUALS(img->h, ref->h);
+			for (int y = 0; y < ref->h; y++)
+				TS_ASSERT_SAME_DATA((Uint8*)img->pixels + y * img->pitch,
+									(Uint8*)ref->pixels + y * ref->pitch,
+									ref->w * ref->format->BytesPerPixel);
+			SDL_FreeSurface(img);
+			SDL_FreeSurface(ref);
+		}
+	}
 };
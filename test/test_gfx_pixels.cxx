@@ -0,0 +1,117 @@
+/**
+ * Test suite for the per-pixel kernels
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cxxtest/TestSuite.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+#include "gfx_pixels.h"
+
+#define ROW_MAX 67
+
+class TestGfxPixels : public CxxTest::TestSuite {
+public:
+	enum gfx_pixels_impl impls[3] = {GFX_PIXELS_SSE2, GFX_PIXELS_AVX2, GFX_PIXELS_NEON};
+
+	void tearDown() {
+		gfx_pixels_init();
+	}
+
+	void random_pixels(Uint32* p, int n) {
+		for (int i = 0; i < n; i++) {
+			p[i] = (rand() & 0xFFFF) << 16 | (rand() & 0xFFFF);
+			if (rand() % 4 == 0)
+				p[i] = 0x00FFFFFF;
+			else if (rand() % 8 == 0)
+				p[i] = 0xFFFFFF00;
+		}
+	}
+
+	void test_pixels_fade() {
+		srand(42);
+		for (int impl = 0; impl < 3; impl++) {
+			if (!gfx_pixels_use(impls[impl]))
+				continue;
+			for (int n = 0; n <= ROW_MAX; n++) {
+				Uint32 ref[ROW_MAX + 1], simd[ROW_MAX + 1];
+				random_pixels(ref, n + 1);
+				int brightness = rand() % 256;
+				int skip_white = rand() % 2;
+				memcpy(simd, ref, sizeof(ref));
+				gfx_fade_row_scalar(ref, n, brightness, skip_white);
+				gfx_fade_row(simd, n, brightness, skip_white);
+				TS_ASSERT_SAME_DATA(simd, ref, sizeof(ref));
+			}
+			// Unaligned rows
+			Uint32 ref[ROW_MAX + 1], simd[ROW_MAX + 1];
+			random_pixels(ref, ROW_MAX + 1);
+			memcpy(simd, ref, sizeof(ref));
+			gfx_fade_row_scalar(ref + 1, ROW_MAX, 255, 1);
+			gfx_fade_row(simd + 1, ROW_MAX, 255, 1);
+			TS_ASSERT_SAME_DATA(simd, ref, sizeof(ref));
+		}
+	}
+
+	void test_pixels_fade_bounds() {
+		Uint32 p[4] = {0x80808080, 0x00FFFFFF, 0x12345678, 0xFFFFFFFF};
+		Uint32 orig[4];
+		memcpy(orig, p, sizeof(p));
+		gfx_fade_row(p, 4, 256, 1);
+		TS_ASSERT_SAME_DATA(p, orig, sizeof(p));
+		gfx_fade_row(p, 4, 0, 1);
+		TS_ASSERT_EQUALS(p[0] & 0x00FFFFFF, 0);
+		TS_ASSERT_EQUALS(p[1], orig[1]);
+		TS_ASSERT_EQUALS(p[2] & 0x00FFFFFF, 0);
+	}
+
+	void test_pixels_expand() {
+		srand(42);
+		struct gfx_palette_lut lut;
+		for (int i = 0; i < 256; i++) {
+			lut.pixels[i] = (rand() & 0xFFFF) << 16 | (rand() & 0xFFFF);
+			for (int c = 0; c < 4; c++)
+				lut.planes[c][i] = ((Uint8*)&lut.pixels[i])[c];
+		}
+		Uint8 src[ROW_MAX + 1];
+		for (int i = 0; i <= ROW_MAX; i++)
+			src[i] = (i < 3) ? 255 - i : rand();
+
+		for (int impl = 0; impl < 3; impl++) {
+			if (!gfx_pixels_use(impls[impl]))
+				continue;
+			for (int n = 0; n <= ROW_MAX; n++) {
+				Uint32 ref[ROW_MAX + 1], simd[ROW_MAX + 1];
+				memset(ref, 0xAA, sizeof(ref));
+				memset(simd, 0xAA, sizeof(simd));
+				gfx_expand_row_scalar(src + 1, ref, n, &lut);
+				gfx_expand_row(src + 1, simd, n, &lut);
+				TS_ASSERT_SAME_DATA(simd, ref, sizeof(ref));
+			}
+		}
+	}
+};
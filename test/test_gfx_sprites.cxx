@@ -0,0 +1,111 @@
+/**
+ * Test suite for sprite sequence loading
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cxxtest/TestSuite.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "SDL.h"
+#include "gfx_sprites.h"
+#include "dinkini.h"
+#include "paths.h"
+#include "IOGfxDisplay.h"
+#include "IOGfxSurfaceSW.h"
+#include "ImageLoader.h"
+#include "gfx.h"
+
+/* Headless display: keep uploaded frames as software surfaces */
+class TestSpritesDisplay : public IOGfxDisplay {
+public:
+	TestSpritesDisplay(bool truecolor) : IOGfxDisplay(640, 480, truecolor, 0) {}
+	void clear() {}
+	void onSizeChange(int w, int h) {}
+	IOGfxSurface* upload(SDL_Surface* s) { return new IOGfxSurfaceSW(s); }
+	IOGfxSurface* allocBuffer(int surfW, int surfH) { return NULL; }
+	void flip(IOGfxSurface* backbuffer, SDL_Rect* dstrect,
+			  bool interpolation, bool hwflip) {}
+	SDL_Surface* screenshot(SDL_Rect* rect) { return NULL; }
+};
+
+/* What load_batch() left in seq[] and k[], to compare two runs */
+struct sprites_snapshot {
+	std::vector<int> frames;
+	std::vector<int> boxes;
+};
+
+class TestGfxSprites : public CxxTest::TestSuite {
+public:
+	/**
+	 * Load the stock Dink dink.ini once serially and once with the
+	 * background decoders, and check both runs assign the same slots
+	 * with the same contents. Set DINK_REFDIR to the directory
+	 * containing dink/ to run it.
+	 */
+	void test_gfx_sprites_parallel_load_matches_serial() {
+		char* refdir = getenv("DINK_REFDIR");
+		if (refdir == NULL) {
+			TS_SKIP("DINK_REFDIR not set");
+		}
+		TS_ASSERT(paths_init("test", refdir, NULL));
+		ImageLoader::initBlitFormat(SDL_PIXELFORMAT_INDEX8);
+		g_display = new TestSpritesDisplay(false);
+		dinkini_init(1000);
+
+		sprites_snapshot serial, parallel;
+		load(0, serial);
+		load(-1, parallel);
+
+		TS_ASSERT(serial.frames == parallel.frames);
+		TS_ASSERT(serial.boxes == parallel.boxes);
+
+		dinkini_quit();
+		delete g_display;
+		g_display = NULL;
+	}
+
+private:
+	void load(int threads, sprites_snapshot& out) {
+		gfx_sprites_decode_threads = threads;
+		load_batch(false);
+
+		for (int i = 0; i < MAX_SEQUENCES; i++)
+			for (int f = 0; f < MAX_FRAMES_PER_ABUSED_SEQUENCE + 2; f++)
+				out.frames.push_back(seq[i].frame[f]);
+		for (int i = 0; i < MAX_SPRITES; i++) {
+			if (GFX_k[i].k == NULL)
+				continue;
+			out.boxes.push_back(i);
+			out.boxes.push_back(k[i].box.right);
+			out.boxes.push_back(k[i].box.bottom);
+			out.boxes.push_back(k[i].xoffset);
+			out.boxes.push_back(k[i].yoffset);
+		}
+		sprites_unload();
+		memset(seq, 0, sizeof(seq));
+	}
+};
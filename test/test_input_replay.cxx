@@ -0,0 +1,105 @@
+/**
+ * Test suite for input record/replay
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cxxtest/TestSuite.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "SDL.h"
+#include "input_replay.h"
+
+#define LOG_PATH "test_input_replay.log"
+
+class TestInputReplay : public CxxTest::TestSuite {
+public:
+	void tearDown() {
+		input_replay_stop();
+		remove(LOG_PATH);
+	}
+
+	void test_input_replay_roundtrip() {
+		TS_ASSERT(input_replay_record(LOG_PATH));
+		unsigned int seed = input_replay_get_seed();
+
+		SDL_Event ev;
+		// Frame 1: a key press, and an event the game doesn't read
+		input_replay_frame_begin();
+		memset(&ev, 0, sizeof(ev));
+		ev.type = SDL_KEYDOWN;
+		ev.key.state = SDL_PRESSED;
+		ev.key.keysym.scancode = SDL_SCANCODE_SPACE;
+		input_replay_record_event(&ev);
+		memset(&ev, 0, sizeof(ev));
+		ev.type = SDL_USEREVENT;
+		input_replay_record_event(&ev);
+		// Frame 2: nothing
+		input_replay_frame_begin();
+		// Frame 3: a click and quitting
+		input_replay_frame_begin();
+		memset(&ev, 0, sizeof(ev));
+		ev.type = SDL_MOUSEBUTTONDOWN;
+		ev.button.button = SDL_BUTTON_LEFT;
+		ev.button.x = 123;
+		input_replay_record_event(&ev);
+		ev.type = SDL_QUIT;
+		input_replay_record_event(&ev);
+		TS_ASSERT_EQUALS(input_replay_get_frame(), 3);
+		input_replay_stop();
+
+		TS_ASSERT(input_replay_play(LOG_PATH));
+		TS_ASSERT_EQUALS(input_replay_get_mode(), INPUT_REPLAY_PLAY);
+		TS_ASSERT_EQUALS(input_replay_get_seed(), seed);
+
+		TS_ASSERT(input_replay_frame_begin());
+		TS_ASSERT(input_replay_poll_event(&ev));
+		TS_ASSERT_EQUALS(ev.type, SDL_KEYDOWN);
+		TS_ASSERT_EQUALS(ev.key.keysym.scancode, SDL_SCANCODE_SPACE);
+		TS_ASSERT(!input_replay_poll_event(&ev));
+
+		TS_ASSERT(input_replay_frame_begin());
+		TS_ASSERT(!input_replay_poll_event(&ev));
+
+		TS_ASSERT(input_replay_frame_begin());
+		TS_ASSERT(input_replay_poll_event(&ev));
+		TS_ASSERT_EQUALS(ev.type, SDL_MOUSEBUTTONDOWN);
+		TS_ASSERT_EQUALS(ev.button.x, 123);
+		// Unread events are skipped at the next frame
+
+		TS_ASSERT(!input_replay_frame_begin());
+		TS_ASSERT_EQUALS(input_replay_get_mode(), INPUT_REPLAY_FINISHED);
+		TS_ASSERT_EQUALS(input_replay_get_frame(), 3);
+	}
+
+	void test_input_replay_not_a_log() {
+		FILE* f = fopen(LOG_PATH, "wb");
+		fputs("not a replay", f);
+		fclose(f);
+		TS_ASSERT(!input_replay_play(LOG_PATH));
+		TS_ASSERT_EQUALS(input_replay_get_mode(), INPUT_REPLAY_OFF);
+		TS_ASSERT(input_replay_frame_begin());
+	}
+};
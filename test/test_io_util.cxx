@@ -122,4 +122,47 @@ directory: currently we don't support that, as it didn't work on
 original Dink / woe anyway, and it's not portable */
 		/* ck_assert(?ciconvert_ext(TESTDIR "subdir", TESTDIR "subdir")); */
 	}
+	void test_ioutil_ciconvert_cache() {
+		struct ciconvert_stats before, after;
+		char fixed_case[] = TESTDIR "SubdIr2/CaChEd";
+
+		/* Cached miss, then the file appears without going through paths.cpp */
+		ciconvert(fixed_case);
+		FILE* f = fopen(TESTDIR "SubDir2/cached", "w");
+		TS_ASSERT(f != NULL);
+		if (f != NULL)
+			fclose(f);
+		strcpy(fixed_case, TESTDIR "SubdIr2/CaChEd");
+		ciconvert(fixed_case);
+		TS_ASSERT_SAME_DATA(fixed_case, TESTDIR "SubDir2/cached", sizeof(fixed_case));
+
+		/* Repeated exact lookups don't touch the filesystem */
+		ciconvert_get_stats(&before);
+		for (int i = 0; i < 10; i++) {
+			strcpy(fixed_case, TESTDIR "SubDir2/cached");
+			ciconvert(fixed_case);
+		}
+		ciconvert_get_stats(&after);
+		TS_ASSERT_EQUALS(after.calls, before.calls + 10);
+		TS_ASSERT_EQUALS(after.syscalls, before.syscalls);
+		TS_ASSERT(after.syscalls_uncached > after.syscalls);
+
+		/* Removed file: invalidate then look up again */
+		unlink(TESTDIR "SubDir2/cached");
+		ciconvert_cache_invalidate(TESTDIR "SubDir2/cached");
+		strcpy(fixed_case, TESTDIR "SubdIr2/CaChEd");
+		ciconvert(fixed_case);
+		TS_ASSERT_SAME_DATA(fixed_case, TESTDIR "SubDir2/CaChEd", sizeof(fixed_case));
+	}
+
+	void test_ioutil_write_json_string() {
+		char buf[64] = {0};
+		FILE* f = tmpfile();
+		TS_ASSERT(f != NULL);
+		write_json_string("a \"b\"\\c\n\x01", f);
+		rewind(f);
+		TS_ASSERT(fgets(buf, sizeof(buf), f) != NULL);
+		fclose(f);
+		TS_ASSERT_EQUALS(strcmp(buf, "\"a \\\"b\\\"\\\\c\\u000a\\u0001\""), 0);
+	}
 };
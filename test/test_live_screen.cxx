@@ -0,0 +1,72 @@
+/**
+ * Test suite for the screen hitmap
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cxxtest/TestSuite.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "live_screen.h"
+#include "hardness_tiles.h"
+
+class TestLiveScreen : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		srand(20);
+		for (int i = 1; i < 40; i++)
+			for (int y = 0; y < 50; y++)
+				for (int x = 0; x < 50; x++)
+					hmap.htile[i].rows[y][x] = rand() % 4;
+		for (int til = 0; til < 96; til++) {
+			/* alternate between default and alternate hardness */
+			cur_ed_screen.t[til].square_full_idx0 = til;
+			hmap.btile_default[til] = 1 + rand() % 39;
+			cur_ed_screen.t[til].althard = (til % 3 == 0) ? 1 + rand() % 39 : 0;
+		}
+		memset(screen_hitmap, 0, sizeof(screen_hitmap));
+	}
+
+	void test_live_screen_fill_whole_hard() {
+		fill_whole_hard();
+		for (int y = 0; y < 400; y++)
+			for (int x = 0; x < 600; x++)
+				TS_ASSERT_EQUALS(hitmap_get(x, y), get_hard_map(x, y));
+		TS_ASSERT_EQUALS(get_hard(-1, 10, 0), 0);
+		TS_ASSERT_EQUALS(get_hard(-1, 10, 1), get_hard_map(0, 10));
+	}
+
+	void test_live_screen_fill_hardxy() {
+		/* A box straddling tiles and the screen edges */
+		rect box;
+		rect_set(&box, 575, -30, 640, 123);
+		fill_hardxy(box);
+		for (int y = 0; y < 400; y++)
+			for (int x = 0; x < 600; x++) {
+				unsigned char expected = (x >= 575 && y < 123) ? get_hard_map(x, y) : 0;
+				TS_ASSERT_EQUALS(hitmap_get(x, y), expected);
+			}
+	}
+};
@@ -0,0 +1,120 @@
+/**
+ * Test suite for the sprite collisions grid
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "live_sprites_manager.h"
+#include "live_sprites_grid.h"
+#include "gfx_sprites.h"
+
+/* Brute-force version of the missile check: hardbox inflated by
+   'margin' contains (x,y) */
+static bool box_hit(int i, int x, int y, int margin) {
+	rect box;
+	rect_copy(&box, &k[getpic(i)].hardbox);
+	rect_offset(&box, spr[i].x, spr[i].y);
+	rect_inflate(&box, margin, margin);
+	return inside_box(x, y, box);
+}
+
+class TestLiveSpritesGrid : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		live_sprites_manager_init();
+		sprites_grid_invalidate();
+		/* one small and one large hardbox */
+		seq[1].frame[1] = 1;
+		rect_set(&k[1].hardbox, -10, -6, 10, 6);
+		seq[2].frame[1] = 2;
+		rect_set(&k[2].hardbox, -120, -80, 120, 20);
+	}
+	void tearDown() {
+	}
+
+	void fill(int nb) {
+		srand(2);
+		for (int i = 0; i < nb; i++) {
+			/* include some sprites off the play area */
+			int h = add_sprite(rand() % 700 - 50, rand() % 500 - 50, 11,
+							   (i % 25 == 0) ? 2 : 1, 1);
+			spr[h].range = (i % 3 == 0) ? 0 : rand() % 40;
+		}
+	}
+
+	void test_grid_candidates_cover_hits() {
+		int candidates[MAX_SPRITES_AT_ONCE];
+		fill(600);
+		for (int h = 1; h <= last_sprite_created; h++) {
+			int n = sprites_grid_query(spr[h].x, spr[h].y, spr[h].range, 0, candidates);
+			int c = 0;
+			for (int i = 1; i <= last_sprite_created; i++) {
+				bool candidate = (c < n && candidates[c] == i);
+				if (candidate)
+					c++;
+				if (box_hit(i, spr[h].x, spr[h].y, spr[h].range))
+					TS_ASSERT(candidate);
+			}
+			TS_ASSERT_EQUALS(c, n); /* sorted, no duplicates */
+		}
+	}
+	void test_grid_after_and_touch() {
+		int candidates[MAX_SPRITES_AT_ONCE];
+		TS_ASSERT_EQUALS(add_sprite(100, 100, 0, 1, 1), 1);
+		TS_ASSERT_EQUALS(add_sprite(100, 100, 0, 1, 1), 2);
+		TS_ASSERT_EQUALS(add_sprite(500, 300, 0, 1, 1), 3);
+
+		TS_ASSERT_EQUALS(sprites_grid_query(100, 100, 0, 0, candidates), 2);
+		TS_ASSERT_EQUALS(sprites_grid_query(100, 100, 0, 1, candidates), 1);
+		TS_ASSERT_EQUALS(candidates[0], 2);
+
+		unsigned int generation = sprites_grid_generation();
+		spr[3].x = 100;
+		spr[3].y = 100;
+		sprites_grid_touch(3);
+		TS_ASSERT_DIFFERS(generation, sprites_grid_generation());
+		TS_ASSERT_EQUALS(sprites_grid_query(100, 100, 0, 0, candidates), 3);
+		TS_ASSERT_EQUALS(candidates[2], 3);
+	}
+	void test_grid_projectiles_match_full_scan() {
+		int candidates[MAX_SPRITES_AT_ONCE];
+		fill(MAX_SPRITES_AT_ONCE - 1);
+
+		int hits_scan = 0;
+		for (int h = 1; h <= last_sprite_created; h++)
+			for (int i = 1; i <= last_sprite_created; i++)
+				if (i != h && box_hit(i, spr[h].x, spr[h].y, spr[h].range))
+					hits_scan++;
+
+		int hits_grid = 0;
+		sprites_grid_invalidate();
+		for (int h = 1; h <= last_sprite_created; h++) {
+			int n = sprites_grid_query(spr[h].x, spr[h].y, spr[h].range, 0, candidates);
+			for (int c = 0; c < n; c++)
+				if (candidates[c] != h && box_hit(candidates[c], spr[h].x, spr[h].y, spr[h].range))
+					hits_grid++;
+		}
+
+		TS_ASSERT_EQUALS(hits_grid, hits_scan);
+	}
+};
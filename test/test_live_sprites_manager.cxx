@@ -26,6 +26,37 @@
 
 #include "live_sprites_manager.h"
 
+/* Original O(n^2) screen_rank_game_sprites(), kept as the reference
+   ordering for the depth index */
+static void reference_rank(int* rank) {
+	memset(rank, 0, MAX_SPRITES_AT_ONCE * sizeof(int));
+	bool already_checked[MAX_SPRITES_AT_ONCE + 1] = {0};
+	for (int r1 = 0; r1 < last_sprite_created; r1++) {
+		int highest_sprite = 22000;
+		for (int h1 = 1; h1 <= last_sprite_created; h1++) {
+			if (!already_checked[h1] && spr[h1].active) {
+				int height = (spr[h1].que != 0) ? spr[h1].que : spr[h1].y;
+				if (height < highest_sprite) {
+					highest_sprite = height;
+					rank[r1] = h1;
+				}
+			}
+		}
+		if (rank[r1] != 0)
+			already_checked[rank[r1]] = true;
+	}
+}
+
+static void fill_screen_with_sprites() {
+	srand(1);
+	for (int i = 1; i < MAX_SPRITES_AT_ONCE; i++) {
+		/* few distinct heights, to exercise the tie-break */
+		int h = add_sprite(rand() % 600, rand() % 40 * 10, 0, 0, 0);
+		if (h % 7 == 0)
+			spr[h].que = rand() % 400;
+	}
+}
+
 class TestLiveSpritesManager : public CxxTest::TestSuite {
 public:
 	void setUp() {
@@ -174,4 +205,83 @@ public:
 		TS_ASSERT_EQUALS(lsm_isValidSprite(100), true);
 		TS_ASSERT_EQUALS(lsm_isValidSprite(299), true);
 	}
+
+	void test_hot_and_cold_fields() {
+		TS_ASSERT_EQUALS(add_sprite(10, 20, 0, 0, 0), 1);
+		/* Hot fields live in the parallel arrays */
+		TS_ASSERT_EQUALS(&spr[1].x, &spr_hot.x[1]);
+		TS_ASSERT_EQUALS(spr_hot.y[1], 20);
+		TS_ASSERT_EQUALS(spr_hot.active[1], true);
+		int* p = &spr[1].speed;
+		*p = 5;
+		TS_ASSERT_EQUALS(spr_cold[1].speed, 5);
+		strcpy(spr[1].text, "hello");
+		TS_ASSERT_EQUALS(sizeof(spr[1].text), 200);
+
+		lsm_reset_sprite(1);
+		TS_ASSERT_EQUALS(spr[1].active, false);
+		TS_ASSERT_EQUALS(spr[1].x, 0);
+		TS_ASSERT_EQUALS(spr[1].speed, 0);
+		TS_ASSERT_EQUALS(spr[1].text[0], '\0');
+	}
+
+	void test_custom() {
+		TS_ASSERT_EQUALS(add_sprite(0, 0, 0, 0, 0), 1);
+		TS_ASSERT_EQUALS(add_sprite(0, 0, 0, 0, 0), 2);
+		int hp = sp_custom_intern("hp");
+		TS_ASSERT(hp > 0);
+		TS_ASSERT_EQUALS(sp_custom_intern("hp"), hp);
+		TS_ASSERT(sp_custom_intern("HP") != hp);
+		TS_ASSERT_EQUALS(sp_custom_key_name(hp), "hp");
+
+		TS_ASSERT(sp_custom_find(&spr[2].custom, hp) == NULL);
+		TS_ASSERT_EQUALS(*sp_custom_get(&spr[2].custom, hp), 0);
+		*sp_custom_get(&spr[2].custom, hp) = 42;
+		TS_ASSERT_EQUALS(*sp_custom_find(&spr[2].custom, hp), 42);
+		TS_ASSERT(sp_custom_find(&spr[1].custom, hp) == NULL);
+
+		/* Past the first table size */
+		char key[20];
+		for (int i = 0; i < 100; i++) {
+			sprintf(key, "key%d", i);
+			*sp_custom_get(&spr[2].custom, sp_custom_intern(key)) = i;
+		}
+		TS_ASSERT_EQUALS(spr[2].custom.count, 101);
+		for (int i = 0; i < 100; i++) {
+			sprintf(key, "key%d", i);
+			int* value = sp_custom_find(&spr[2].custom, sp_custom_intern(key));
+			TS_ASSERT(value != NULL && *value == i);
+		}
+		TS_ASSERT_EQUALS(*sp_custom_find(&spr[2].custom, hp), 42);
+
+		/* Dropped with the sprite, even when just deactivated */
+		spr[2].active = false;
+		lsm_kill_all_nonlive_sprites();
+		TS_ASSERT(spr[2].custom.slots == NULL);
+		TS_ASSERT_EQUALS(add_sprite(0, 0, 0, 0, 0), 2);
+		TS_ASSERT(sp_custom_find(&spr[2].custom, hp) == NULL);
+	}
+
+	void test_depth_rank_matches_reference() {
+		int rank[MAX_SPRITES_AT_ONCE], expected[MAX_SPRITES_AT_ONCE];
+		fill_screen_with_sprites();
+		TS_ASSERT_EQUALS(last_sprite_created, MAX_SPRITES_AT_ONCE - 1);
+
+		for (int frame = 0; frame < 50; frame++) {
+			/* move some sprites behind the index's back, like brains do */
+			for (int i = 0; i < 30; i++) {
+				int h = 1 + rand() % (MAX_SPRITES_AT_ONCE - 1);
+				if (spr[h].active)
+					spr[h].y += rand() % 11 - 5;
+			}
+			if (frame % 10 == 0) {
+				lsm_remove_sprite(1 + rand() % (MAX_SPRITES_AT_ONCE - 1));
+				spr[1 + rand() % (MAX_SPRITES_AT_ONCE - 1)].que = 22000;
+				add_sprite(rand() % 600, rand() % 400, 0, 0, 0);
+			}
+			lsm_depth_rank(rank);
+			reference_rank(expected);
+			TS_ASSERT_SAME_DATA(rank, expected, sizeof(rank));
+		}
+	}
 };
@@ -0,0 +1,56 @@
+/**
+ * Test suite for the debug log ring buffer
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cxxtest/TestSuite.h>
+
+#include "log.h"
+
+class TestLog : public CxxTest::TestSuite {
+public:
+	void test_logring_drops_oldest() {
+		LogRing ring(3);
+		ring.append("one");
+		ring.append("two");
+		TS_ASSERT_EQUALS(ring.size(), 2);
+		TS_ASSERT_EQUALS(ring.dropped(), 0);
+		TS_ASSERT_EQUALS(ring.text(), "one\ntwo\n");
+
+		ring.append("three");
+		ring.append("four");
+		ring.append("five");
+		TS_ASSERT_EQUALS(ring.size(), 3);
+		TS_ASSERT_EQUALS(ring.dropped(), 2);
+		TS_ASSERT_EQUALS(ring.line(0), "three");
+		TS_ASSERT_EQUALS(ring.line(2), "five");
+		TS_ASSERT_EQUALS(ring.text(), "three\nfour\nfive\n");
+
+		ring.clear();
+		TS_ASSERT_EQUALS(ring.size(), 0);
+		TS_ASSERT_EQUALS(ring.dropped(), 0);
+		ring.append("six");
+		TS_ASSERT_EQUALS(ring.text(), "six\n");
+	}
+};
@@ -0,0 +1,123 @@
+/**
+ * Test suite for the memory-mapped map.dat reader
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cxxtest/TestSuite.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "editor_screen.h"
+#include "live_screen.h" /* cur_ed_screen */
+#include "map_view.h"
+#include "paths.h"
+
+#define SCREEN_SIZE 31280
+
+class TestMapView : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		ts_paths_init();
+	}
+	void tearDown() {
+		map_view_forget();
+	}
+
+	/* Compare every screen of the D-Mod's map.dat with both readers */
+	void check_same_as_stdio(int nb_screens) {
+		struct map_view* view = map_view_open("map.dat");
+		TS_ASSERT(view != NULL);
+		if (view == NULL)
+			return;
+		TS_ASSERT_EQUALS(map_view_nb_screens(view), nb_screens);
+
+		struct editor_screen* a = new struct editor_screen;
+		struct editor_screen* b = new struct editor_screen;
+		for (int num = 1; num <= nb_screens; num++) {
+			memset(a, 0, sizeof(*a));
+			memset(b, 0, sizeof(*b));
+			TS_ASSERT_EQUALS(load_screen_stdio("map.dat", num, a), 0);
+			TS_ASSERT_EQUALS(map_view_read_screen(view, num, b), 0);
+			TS_ASSERT(memcmp(a, b, sizeof(*a)) == 0);
+		}
+		TS_ASSERT_EQUALS(map_view_read_screen(view, nb_screens + 1, b), -1);
+		TS_ASSERT_EQUALS(map_view_read_screen(view, 0, b), -1);
+		delete a;
+		delete b;
+		map_view_close(view);
+	}
+
+	void test_map_view_random_map() {
+		/* Garbage everywhere: negative ints, unterminated strings,
+		odd 'active' bytes */
+		FILE* f = paths_dmodfile_fopen("map.dat", "wb");
+		TS_ASSERT(f != NULL);
+		unsigned int state = 1234;
+		for (int i = 0; i < 12 * SCREEN_SIZE; i++) {
+			state = state * 1103515245 + 12345;
+			fputc(state >> 16, f);
+		}
+		fclose(f);
+		check_same_as_stdio(12);
+	}
+
+	void test_map_view_stock_map() {
+		/* Point STOCK_MAP_DAT to the original game's dink/map.dat */
+		const char* stock = getenv("STOCK_MAP_DAT");
+		if (stock == NULL)
+			return;
+		FILE* in = fopen(stock, "rb");
+		TS_ASSERT(in != NULL);
+		if (in == NULL)
+			return;
+		FILE* out = paths_dmodfile_fopen("map.dat", "wb");
+		char buf[4096];
+		size_t len, total = 0;
+		while ((len = fread(buf, 1, sizeof(buf), in)) > 0) {
+			fwrite(buf, 1, len, out);
+			total += len;
+		}
+		fclose(in);
+		fclose(out);
+		check_same_as_stdio(total / SCREEN_SIZE);
+	}
+
+	void test_map_view_save_remaps() {
+		fclose(paths_dmodfile_fopen("map.dat", "wb"));
+		strcpy(cur_ed_screen.script, "first");
+		save_screen("map.dat", 1);
+		struct editor_screen* s = new struct editor_screen;
+		TS_ASSERT_EQUALS(load_screen_to("map.dat", 1, s), 0);
+		TS_ASSERT_EQUALS(s->script, "first");
+
+		/* The file grows: the mapping must follow */
+		strcpy(cur_ed_screen.script, "second");
+		save_screen("map.dat", 2);
+		TS_ASSERT_EQUALS(load_screen_to("map.dat", 2, s), 0);
+		TS_ASSERT_EQUALS(s->script, "second");
+		delete s;
+	}
+};
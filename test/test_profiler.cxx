@@ -0,0 +1,125 @@
+/**
+ * Test suite for the frame profiler
+
+ * Copyright (C) 2026  Yeoldetoast
+
+ * This file is part of GNU FreeDink
+
+ * GNU FreeDink is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+
+ * GNU FreeDink is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cxxtest/TestSuite.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "SDL.h"
+#include "profiler.h"
+
+class TestProfiler : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		prof_enable(true);
+	}
+	void tearDown() {
+		prof_quit();
+	}
+
+	void test_profiler_nesting() {
+		prof_frame_begin();
+		{
+			prof_scope brains(PROF_BRAINS);
+			{
+				prof_scope script(PROF_SCRIPT, "s1-ntr");
+				SDL_Delay(2);
+			}
+			SDL_Delay(1);
+		}
+		prof_frame_end();
+
+		struct prof_frame f;
+		TS_ASSERT_EQUALS(prof_get_frames(&f, 1), 1);
+		TS_ASSERT_LESS_THAN(0, f.zone_ms[PROF_SCRIPT]);
+		TS_ASSERT_LESS_THAN(0, f.zone_ms[PROF_BRAINS]);
+		// Exclusive times add up to the frame
+		float sum = 0;
+		for (int z = 0; z < PROF_NB_ZONES; z++)
+			sum += f.zone_ms[z];
+		TS_ASSERT_DELTA(sum, f.total_ms, 0.001);
+
+		struct prof_event ev[3];
+		TS_ASSERT_EQUALS(prof_get_events(ev, 3), 3);
+		// Recorded as they close: innermost first
+		TS_ASSERT_EQUALS(ev[0].zone, PROF_SCRIPT);
+		TS_ASSERT_EQUALS(ev[0].depth, 2);
+		TS_ASSERT_EQUALS(strcmp(ev[0].name, "s1-ntr"), 0);
+		TS_ASSERT_EQUALS(ev[2].zone, PROF_FRAME);
+
+		struct prof_script_stats st[2];
+		TS_ASSERT_EQUALS(prof_get_scripts(st, 2), 1);
+		TS_ASSERT_EQUALS(st[0].calls, 1);
+		TS_ASSERT_EQUALS(strcmp(st[0].name, "s1-ntr"), 0);
+	}
+
+	void test_profiler_ring() {
+		int n = PROF_MAX_EVENTS + 10;
+		for (int i = 0; i < n; i++) {
+			prof_scope s(PROF_DRAW);
+		}
+		std::vector<struct prof_event> buf(PROF_MAX_EVENTS + 10);
+		TS_ASSERT_EQUALS(prof_get_events(buf.data(), buf.size()), PROF_MAX_EVENTS);
+		TS_ASSERT_EQUALS(prof_get_events(buf.data(), 5), 5);
+		for (int i = 1; i < 5; i++)
+			TS_ASSERT_LESS_THAN_EQUALS(buf[i - 1].end, buf[i].start);
+	}
+
+	void test_profiler_disabled() {
+		prof_enable(false);
+		prof_frame_begin();
+		{
+			prof_scope s(PROF_TEXT);
+		}
+		prof_frame_end();
+		struct prof_event ev;
+		TS_ASSERT_EQUALS(prof_get_events(&ev, 1), 0);
+		struct prof_frame f;
+		TS_ASSERT_EQUALS(prof_get_frames(&f, 1), 0);
+	}
+
+	void test_profiler_trace() {
+		prof_frame_begin();
+		{
+			prof_scope s(PROF_SCRIPT, "quote\"name");
+		}
+		prof_frame_end();
+		const char* path = "test_profiler_trace.json";
+		TS_ASSERT(prof_write_trace(path));
+		FILE* f = fopen(path, "r");
+		TS_ASSERT(f != NULL);
+		char buf[1024];
+		size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+		buf[len] = '\0';
+		fclose(f);
+		remove(path);
+		TS_ASSERT(strstr(buf, "\"traceEvents\"") != NULL);
+		TS_ASSERT(strstr(buf, "\"name\":\"quote\\\"name\",\"cat\":\"Scripts\"") != NULL);
+		TS_ASSERT(strstr(buf, "\"name\":\"Other\",\"cat\":\"Other\"") != NULL);
+	}
+};
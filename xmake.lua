@@ -2,16 +2,24 @@ set_version("0.95")
 set_languages("gnu99", "cxx17")
 add_requires("libsdl2", "libsdl2_image", "libsdl2_gfx", "libsdl2_mixer > 2.6.2", "libsdl2_ttf", "libintl", "lua > 5.4.6", "cereal", "soloud", "spdlog")
 
+option("trace_log")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build in log_trace/log_enter/log_exit, shown at debug level 2")
+    add_defines("LOG_TRACE")
+option_end()
+
 target("yeoldedink")
     set_kind("binary")
     add_cxxflags("-Wno-write-strings")
-    add_files("src/*.cpp")
+    add_files("src/*.cpp|benchmark_main.cpp|AppBenchmark.cpp")
     add_files("src/*.c")
     add_files("soloud/*.cpp")
     add_files("src/imgui_standard/*.cpp")
     add_files("src/imgui_standard/misc/freetype/*.cpp")
 
     add_cxflags("-DHAVE_CONFIG_H", "-DWELL_BEHAVED_DINK")
+    add_options("trace_log")
     set_configvar("PACKAGE", "yeoldedink")
     set_configvar("PACKAGE_NAME", "$(target)")
     set_configvar("PACKAGE_STRING", "yeoldedink $(version)")